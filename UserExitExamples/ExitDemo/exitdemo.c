@@ -51,128 +51,7 @@
   #include <ctype.h>
 #endif
 
-#include "usrdecs.h"
-
-/* ER callback routine */
-#ifndef WIN32
-void ERCALLBACK(ercallback_function_codes function_code,
-                void *buf, short *presult_code);
-#else
-typedef void (*FPERCALLBACK)(ercallback_function_codes function_code,
-                             void *buf, short *presult_code);
-
-HINSTANCE hEXE; /* EXE handle */
-FPERCALLBACK fp_ERCallback; /* Callback function pointer */
-
-/***************************************************************************
-  Open the ER callback function explicitly.
-***************************************************************************/
-short open_callback (char *executable_name,
-                     char *function_name)
-{
-    printf ("Opening callback for %s, %s.\n",
-            executable_name,
-            function_name);
-
-    hEXE = LoadLibrary (executable_name);
-    if (hEXE != NULL)
-    {
-        /* Function should always be exported in uppercase, since
-           GetProcAddress converts to uppercase then does a case-sensitive
-           search.  Don't use /NOIGNORE (/NOI) linker option. */
-        fp_ERCallback = (FPERCALLBACK)GetProcAddress(hEXE, function_name);
-
-        if (!fp_ERCallback)
-        {
-            FreeLibrary (hEXE);
-            return 0;
-        }
-    }
-    else
-        return 0;
-
-    return 1;
-}
-#endif
-
-/***************************************************************************
-  Close the callback function.
-***************************************************************************/
-void close_callback (void)
-{
-#ifdef WIN32
-    FreeLibrary (hEXE);
-#endif
-}
-
-/***************************************************************************
-  Call the callback function.
-***************************************************************************/
-void call_callback (ercallback_function_codes function_code,
-                    void *buf, short *result_code)
-{
-#ifdef WIN32
-    fp_ERCallback (function_code, buf, result_code);
-#else
-    ERCALLBACK (function_code, buf, result_code);
-#endif
-}
-
-/***************************************************************************
-  Test for Little Endian machine format
-***************************************************************************/
-short LittleEndian( void )
-{
-    short little_endian = 1;
-    char *little_endian_c = (char *)&little_endian;
-
-    if (*little_endian_c)
-    {
-        return 1;
-    }
-    return 0;
-}
-
-/***************************************************************************
-  Reverse bytes for Little Endian/Big Endian
-***************************************************************************/
-void ReverseBytes (void *buf, short cnt)
-{
-    char *b = (char *)buf, *e = (char *)buf + cnt - 1;
-    char temp;
-
-    for (; b < e; b++, e--)
-    {
-        temp = *b;
-        *b = *e;
-        *e = temp;
-    }
-}
-
-/***************************************************************************
-  Output a message to the report file (or console).
-***************************************************************************/
-void output_msg (char *msg,...)
-{
-    short result_code;
-    char temp_msg[1000];
-
-    va_list args;
-
-    va_start (args, msg);
-
-    vsprintf (temp_msg, msg, args);
-
-    va_end (args);
-
-    call_callback (OUTPUT_MESSAGE_TO_REPORT, temp_msg, &result_code);
-}
-
-short IsPrint(int c)
-{
-    if (c != EOF) c = (unsigned char)c;
-    return isprint(c) ? 1 : 0;
-}
+#include "exitrt.h"
 
 /***************************************************************************
   Display record information.
@@ -588,13 +467,6 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
     uint32_t seqno;
     int32_t rba;
 
-    typedef struct
-    {
-        char ch_seqno[4];
-        char ch_rba[4];
-    } char_position;
-    char_position position_char;
-
     if (!callback_opened)
     {
         callback_opened = 1;
@@ -673,7 +545,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
             output_msg ("     SourceDB DBObject Type Metadata:\n");
 
             // userexit does not support packge and procedure yet.
-            for (i = 0; i < MAX_DBOBJECT_TYPES; i++) {
+            for (i = 0; i < MAXDBOBJTYPE_122; i++) {
                output_msg ("         DBObject Type[%s]: 0x%x \n",
                         dbObjTyp[i], dbMetadata.source_db_def.dbNameMetadata[i]);
 
@@ -720,7 +592,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
                         dbMetadata.target_db_def.locale);
 
             // userexit does not support packge and procedure yet.
-            for (i = 0; i < MAX_DBOBJECT_TYPES; i++) {
+            for (i = 0; i < MAXDBOBJTYPE_122; i++) {
                output_msg ("         DBObject Type[%s]: 0x%x \n",
                         dbObjTyp[i], dbMetadata.target_db_def.dbNameMetadata[i]);
                /* Test the macros defined in usrdecs.h to check the db object
@@ -791,7 +663,6 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
                             "Total inserts:       \t%ld\n"
                             "Total updates:       \t%ld\n"
                             "Total deletes:       \t%ld\n"
-                            "Total upserts:       \t%ld\n"
                             "Total discards:      \t%ld\n"
                             "Total ignores:       \t%ld\n"
                             "Total truncates:     \t%ld\n"
@@ -799,8 +670,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
                             "Total operations:    \t%ld\n\n",
                             statistics.start_datetime, table_name,
                             statistics.num_inserts, statistics.num_updates,
-                            statistics.num_deletes, statistics.num_upserts,
-                            statistics.num_discards,
+                            statistics.num_deletes, statistics.num_discards,
                             statistics.num_ignores, statistics.num_truncates,
                             statistics.total_db_operations, statistics.total_operations);
             }
@@ -828,7 +698,6 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
                             "Total inserts:       \t%ld\n"
                             "Total updates:       \t%ld\n"
                             "Total deletes:       \t%ld\n"
-                            "Total upserts:       \t%ld\n"
                             "Total discards:      \t%ld\n"
                             "Total ignores:       \t%ld\n"
                             "Total truncates:     \t%ld\n"
@@ -836,8 +705,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
                             "Total operations:    \t%ld\n",
                             statistics.start_datetime, table_name,
                             statistics.num_inserts, statistics.num_updates,
-                            statistics.num_deletes, statistics.num_upserts,
-                            statistics.num_discards,
+                            statistics.num_deletes, statistics.num_discards,
                             statistics.num_ignores, statistics.num_truncates,
                             statistics.total_db_operations, statistics.total_operations);
             }
@@ -864,15 +732,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
             call_callback (GET_POSITION,  position_rec,&result_code);
             if (!result_code)
             {
-                memcpy (&position_char, position_rec->position, position_rec->position_len);
-                if (LittleEndian())
-                {
-                    ReverseBytes (&position_char.ch_seqno, sizeof (position_char.ch_seqno));
-                    ReverseBytes (&position_char.ch_rba, sizeof (position_char.ch_rba));
-                }
-
-                memcpy (&seqno, position_char.ch_seqno, sizeof (seqno));
-                memcpy (&rba, &position_char.ch_rba[0], sizeof (rba));
+                exit_rt_read_position (position_rec, &seqno, &rba);
                 sprintf (print_msg, "\nGET_POSITION CURRENT_CHECKPOINT, values seqno %ld rba %ld\n",
                                                                        (long) seqno, (long) rba );
 
@@ -922,14 +782,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
             call_callback (GET_POSITION,  position_rec,&result_code);
             if (!result_code)
             {
-                memcpy (&position_char, position_rec->position, position_rec->position_len);
-                if (LittleEndian())
-                {
-                    ReverseBytes (&position_char.ch_seqno, sizeof (position_char.ch_seqno));
-                    ReverseBytes (&position_char.ch_rba, sizeof (position_char.ch_rba));
-                }
-                memcpy (&seqno, position_char.ch_seqno, sizeof (seqno));
-                memcpy (&rba, position_char.ch_rba, sizeof (rba));
+                exit_rt_read_position (position_rec, &seqno, &rba);
                 sprintf (print_msg, "\nGET_POSITION STARTUP_CHECKPOINT, values seqno %ld rba %ld\n",
                                                                        (long) seqno, (long) rba );
                 call_callback (OUTPUT_MESSAGE_TO_REPORT, &print_msg, &result_code);
@@ -940,14 +793,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
             call_callback (GET_POSITION,  position_rec,&result_code);
             if (!result_code)
             {
-                memcpy (&position_char, position_rec->position, position_rec->position_len);
-                if (LittleEndian())
-                {
-                    ReverseBytes (&position_char.ch_seqno, sizeof (position_char.ch_seqno));
-                    ReverseBytes (&position_char.ch_rba, sizeof (position_char.ch_rba));
-                }
-                memcpy (&seqno, position_char.ch_seqno, sizeof (seqno));
-                memcpy (&rba, position_char.ch_rba, sizeof (rba));
+                exit_rt_read_position (position_rec, &seqno, &rba);
                 sprintf (print_msg, "\nGET_POSITION CURRENT_CHECKPOINT, values seqno %ld rba %ld\n",
                                                                        (long) seqno, (long) rba );
                 call_callback (OUTPUT_MESSAGE_TO_REPORT, &print_msg, &result_code);
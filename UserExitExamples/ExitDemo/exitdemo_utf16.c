@@ -67,103 +67,7 @@ All rights reserved.*/
   #include <ctype.h>
 #endif
 
-#include "usrdecs.h"
-
-/* ER callback routine */
-#ifndef WIN32
-void ERCALLBACK(ercallback_function_codes function_code,
-                void *buf, short *presult_code);
-#else
-typedef void (*FPERCALLBACK)(ercallback_function_codes function_code,
-                             void *buf, short *presult_code);
-
-HINSTANCE hEXE; /* EXE handle */
-FPERCALLBACK fp_ERCallback; /* Callback function pointer */
-
-/***************************************************************************
-  Open the ER callback function explicitly.
-***************************************************************************/
-short open_callback (char *executable_name,
-                     char *function_name)
-{
-    printf ("Opening callback for %s, %s.\n",
-            executable_name,
-            function_name);
-
-    hEXE = LoadLibrary (executable_name);
-    if (hEXE != NULL)
-    {
-        /* Function should always be exported in uppercase, since
-           GetProcAddress converts to uppercase then does a case-sensitive
-           search.  Don't use /NOIGNORE (/NOI) linker option. */
-        fp_ERCallback = (FPERCALLBACK)GetProcAddress(hEXE, function_name);
-
-        if (!fp_ERCallback)
-        {
-            FreeLibrary (hEXE);
-            return 0;
-        }
-    }
-    else
-        return 0;
-
-    return 1;
-}
-#endif
-
-/***************************************************************************
-  Close the callback function.
-***************************************************************************/
-void close_callback (void)
-{
-#ifdef WIN32
-    FreeLibrary (hEXE);
-#endif
-}
-
-/***************************************************************************
-  Call the callback function.
-***************************************************************************/
-void call_callback (ercallback_function_codes function_code,
-                    void *buf, short *result_code)
-{
-#ifdef WIN32
-    fp_ERCallback (function_code, buf, result_code);
-#else
-    ERCALLBACK (function_code, buf, result_code);
-#endif
-}
-
-/***************************************************************************
-  Test for Little Endian machine format
-***************************************************************************/
-short LittleEndian( void )
-{
-    short little_endian = 1;
-    char *little_endian_c = (char *)&little_endian;
-
-    if (*little_endian_c)
-    {
-        return 1;
-    }
-    return 0;
-}
-
-/***************************************************************************
-  Reverse bytes for Little Endian/Big Endian
-***************************************************************************/
-void ReverseBytes (void *buf, short cnt)
-{
-    char *b = (char *)buf, *e = (char *)buf + cnt - 1;
-    char temp;
-
-    for (; b < e; b++, e--)
-    {
-        temp = *b;
-        *b = *e;
-        *e = temp;
-    }
-}
+#include "exitrt.h"
 
 /***************************************************************************
   Output a message to the report file (or console).
@@ -224,12 +128,6 @@ typedef unsigned short uint16_t;
    *dst = 0;
 }
 
-short IsPrint(int c)
-{
-    if (c != EOF) c = (unsigned char)c;
-    return isprint(c) ? 1 : 0;
-}
-
 /***************************************************************************
   Display record information.
 ***************************************************************************/
@@ -408,13 +306,6 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
     uint32_t seqno;
     int32_t rba;
 
-    typedef struct
-    {
-        char ch_seqno[4];
-        char ch_rba[4];
-    } char_position;
-    char_position position_char;
-
     char  tempMsg[2000];
     short temp_result_code;
     short msgLen;
@@ -563,15 +454,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
             call_callback (GET_POSITION,  position_rec,&result_code);
             if (!result_code)
             {
-                memcpy (&position_char, position_rec->position, position_rec->position_len);
-                if (LittleEndian())
-                {
-                    ReverseBytes (&position_char.ch_seqno, sizeof (position_char.ch_seqno));
-                    ReverseBytes (&position_char.ch_rba, sizeof (position_char.ch_rba));
-                }
-
-                memcpy (&seqno, position_char.ch_seqno, sizeof (seqno));
-                memcpy (&rba, &position_char.ch_rba[0], sizeof (rba));
+                exit_rt_read_position (position_rec, &seqno, &rba);
                 output_msg ("\nGET_POSITION CURRENT_CHECKPOINT, values seqno %ld rba %ld\n",
                              (long) seqno, (long) rba );
 
@@ -664,14 +547,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
             call_callback (GET_POSITION,  position_rec,&result_code);
             if (!result_code)
             {
-                memcpy (&position_char, position_rec->position, position_rec->position_len);
-                if (LittleEndian())
-                {
-                    ReverseBytes (&position_char.ch_seqno, sizeof (position_char.ch_seqno));
-                    ReverseBytes (&position_char.ch_rba, sizeof (position_char.ch_rba));
-                }
-                memcpy (&seqno, position_char.ch_seqno, sizeof (seqno));
-                memcpy (&rba, position_char.ch_rba, sizeof (rba));
+                exit_rt_read_position (position_rec, &seqno, &rba);
                 output_msg ("\nGET_POSITION STARTUP_CHECKPOINT, values seqno %ld rba %ld\n",
                             (long) seqno, (long) rba );
             }
@@ -681,14 +557,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
             call_callback (GET_POSITION,  position_rec,&result_code);
             if (!result_code)
             {
-                memcpy (&position_char, position_rec->position, position_rec->position_len);
-                if (LittleEndian())
-                {
-                    ReverseBytes (&position_char.ch_seqno, sizeof (position_char.ch_seqno));
-                    ReverseBytes (&position_char.ch_rba, sizeof (position_char.ch_rba));
-                }
-                memcpy (&seqno, position_char.ch_seqno, sizeof (seqno));
-                memcpy (&rba, position_char.ch_rba, sizeof (rba));
+                exit_rt_read_position (position_rec, &seqno, &rba);
                 output_msg ("\nGET_POSITION CURRENT_CHECKPOINT, values seqno %ld rba %ld\n",
                             (long) seqno, (long) rba );
             }
@@ -119,7 +119,7 @@ Param file options with Extract using the User Exit
   #include <ctype.h>
 #endif
 
-#include "usrdecs.h"
+#include "exitrt.h"
 
 #define MAX_NAME_SIZE            100
 #define MAX_BUFF_SIZE            1000
@@ -139,98 +139,6 @@ const char* UNKNOWN        = "NOT FOUND";
 /* Schema Name */
 char* schema = NULL;
 
-/* ER callback routine */
-#ifndef WIN32
-void ERCALLBACK(ercallback_function_codes function_code,
-                void *buf, short *presult_code);
-#else
-typedef void (*FPERCALLBACK)(ercallback_function_codes function_code,
-                             void *buf, short *presult_code);
-
-HINSTANCE hEXE; /* EXE handle */
-FPERCALLBACK fp_ERCallback; /* Callback function pointer */
-
-/***********************************************************************************
-*  Open the ER callback function explicitly.
-* @param[in] executable_name - Program which invoked this call
-* @param[in] function_name   - Which function to call
-* @returns   1 if successful else 0
-***********************************************************************************/
-short open_callback (char *executable_name,
-                     char *function_name)
-{
-    printf ("Opening callback for %s, %s.\n",
-            executable_name,
-            function_name);
-
-    hEXE = LoadLibrary (executable_name);
-    if (hEXE != NULL)
-    {
-        /* Function should always be exported in uppercase, since
-           GetProcAddress converts to uppercase then does a case-sensitive
-           search.  Don't use /NOIGNORE (/NOI) linker option. */
-        fp_ERCallback = (FPERCALLBACK)GetProcAddress(hEXE, function_name);
-
-        if (!fp_ERCallback)
-        {
-            FreeLibrary (hEXE);
-            return 0;
-        }
-    }
-    else
-        return 0;
-
-    return 1;
-}
-#endif
-
-/***********************************************************************************
-  Close the callback function.
-***********************************************************************************/
-void close_callback (void)
-{
-#ifdef WIN32
-    FreeLibrary (hEXE);
-#endif
-}
-
-/***********************************************************************************
-*  Call the callback function.
-* @param[in]      function_code - The CALLBACK function code
-* @param[in/out]  buf           - Input for SET function and Output for GET functions
-* @param[out]     result-code   - Result of the CALLABCK function
-***********************************************************************************/
-void call_callback (ercallback_function_codes function_code,
-                    void *buf, short *result_code)
-{
-#ifdef WIN32
-    fp_ERCallback (function_code, buf, result_code);
-#else
-    ERCALLBACK (function_code, buf, result_code);
-#endif
-}
-
-/***********************************************************************************
-*  Output a message to the report file (or console).
-* @param[in] msg - Message to print
-* @param[in] ... - Variable arguments
-***********************************************************************************/
-void output_msg (char *msg,...)
-{
-    short result_code;
-    char temp_msg[1000];
-
-    va_list args;
-
-    va_start (args, msg);
-
-    vsprintf (temp_msg, msg, args);
-
-    va_end (args);
-
-    call_callback (OUTPUT_MESSAGE_TO_REPORT, temp_msg, &result_code);
-}
-
 /*********************************************************************************************
 * Retrieve the column value from the source record
 * @param[in]    col_ix      - column index
@@ -9,6 +9,8 @@
   release.
   The record is processed and written to the flat file in a self describing format. This output
   file is in readable text format.
+  The file is written by a background thread (exitwriter.h), synced to disk at each checkpoint
+  and rotated at PASSTHRU_ROTATE_BYTES bytes if that is set.
 
   The record format example:
     Record No# 1
@@ -87,116 +89,20 @@ Param file options with Extract Pump using the User Exit
   #include <ctype.h>
 #endif
 
-#include "usrdecs.h"
+#include "exitrt.h"
+#include "exitwriter.h"
 
 #define FILE_IO_ERROR    1
 
 /* Output file */
 const char* filename = "./dirdat/flatfile.dat";
 
-/* ER callback routine */
-#ifndef WIN32
-void ERCALLBACK(ercallback_function_codes function_code,
-                void *buf, short *presult_code);
-#else
-typedef void (*FPERCALLBACK)(ercallback_function_codes function_code,
-                             void *buf, short *presult_code);
-
-HINSTANCE hEXE; /* EXE handle */
-FPERCALLBACK fp_ERCallback; /* Callback function pointer */
-
-
-/***********************************************************************************
-*  Open the ER callback function explicitly.
-* @param[in] executable_name - Program which invoked this call
-* @param[in] function_name   - Which function to call
-* @returns   1 if successful else 0
-***********************************************************************************/
-short open_callback (char *executable_name,
-                     char *function_name)
-{
-    printf ("Opening callback for %s, %s.\n",
-            executable_name,
-            function_name);
-
-    hEXE = LoadLibrary (executable_name);
-    if (hEXE != NULL)
-    {
-        /* Function should always be exported in uppercase, since
-           GetProcAddress converts to uppercase then does a case-sensitive
-           search.  Don't use /NOIGNORE (/NOI) linker option. */
-        fp_ERCallback = (FPERCALLBACK)GetProcAddress(hEXE, function_name);
-
-        if (!fp_ERCallback)
-        {
-            FreeLibrary (hEXE);
-            return 0;
-        }
-    }
-    else
-        return 0;
-
-    return 1;
-}
-#endif
-
-/***********************************************************************************
-  Close the callback function.
-***********************************************************************************/
-void close_callback (void)
-{
-#ifdef WIN32
-    FreeLibrary (hEXE);
-#endif
-}
-
-/***********************************************************************************
-*  Call the callback function.
-* @param[in]      function_code - The CALLBACK function code
-* @param[in/out]  buf           - Input for SET function and Output for GET functions
-* @param[out]     result-code   - Result of the CALLABCK function
-***********************************************************************************/
-void call_callback (ercallback_function_codes function_code,
-                    void *buf, short *result_code)
-{
-#ifdef WIN32
-    fp_ERCallback (function_code, buf, result_code);
-#else
-    ERCALLBACK (function_code, buf, result_code);
-#endif
-}
-
-/***********************************************************************************
-*  Output a message to the report file (or console).
-* @param[in] msg - Message to print
-* @param[in] ... - Variable arguments
-***********************************************************************************/
-void output_msg (char *msg,...)
-{
-    short result_code;
-    char temp_msg[1000];
-
-    va_list args;
-
-    va_start (args, msg);
-
-    vsprintf (temp_msg, msg, args);
-
-    va_end (args);
+/* Environment variable giving the size at which the output file is
+   rotated, 0 or unset never */
+#define ROTATE_ENV "PASSTHRU_ROTATE_BYTES"
 
-    call_callback (OUTPUT_MESSAGE_TO_REPORT, temp_msg, &result_code);
-}
-
-/***********************************************************************************
-*  Check whether printable character.
-* @param[in] c - The character to test
-* @returns   1 if printable else 0
-***********************************************************************************/
-short IsPrint(int c)
-{
-    if (c != EOF) c = (unsigned char)c;
-    return isprint(c) ? 1 : 0;
-}
+/* Writes the output file off the Extract thread, see exitwriter.h */
+static exit_writer *writer = NULL;
 
 /***********************************************************************************
 *  Writes the record to the Flatfile
@@ -205,14 +111,12 @@ short IsPrint(int c)
 ***********************************************************************************/
 int out_to_file(short source_or_target, short ascii_or_internal)
 {
-    FILE* fp = NULL;
     record_def* record = NULL;
     table_def table;
     column_def column;
     env_value_def env_value;
     char ascii_str[1000];
     char buf[1000];
-    int bytes_written = 0;
     int buf_size = 0;
     int i, j;
     unsigned short col_len;
@@ -233,13 +137,11 @@ int out_to_file(short source_or_target, short ascii_or_internal)
         return result_code;
     }
 
-    /* Create/Open(in Append Mode) Flat File */
-    fp = fopen (filename, "at");
-    if (!fp)
+    /* DDL records have no columns to write */
+    if (record->io_type == SQL_DDL_VAL)
     {
-        output_msg ("Error creating file flatfile.dat\n");
         free (record);
-        return FILE_IO_ERROR;
+        return EXIT_FN_RET_OK;
     }
 
     /* Get table name */
@@ -260,8 +162,7 @@ int out_to_file(short source_or_target, short ascii_or_internal)
     /* Write Operation Type and Table Name to file */
     buf_size = sprintf ( buf, "  Record No#%d\n  Operation Type: %d\n  Table Name:%s\n"
                               ,rec_count++, record->io_type, env_value.buffer);
-    bytes_written = fwrite (buf, 1, buf_size, fp);
-    if (bytes_written != buf_size)
+    if (!exit_writer_write (writer, buf, buf_size))
     {
         output_msg ("Error while writing Operation type to file.\n");
         free (env_value.buffer);
@@ -281,8 +182,7 @@ int out_to_file(short source_or_target, short ascii_or_internal)
 
     /* Write Operation Timestamp to file */
     buf_size = sprintf ( buf, "  Operation Timestamp: %s\n",record->io_datetime);
-    bytes_written = fwrite (buf, 1, buf_size, fp);
-    if (bytes_written != buf_size)
+    if (!exit_writer_write (writer, buf, buf_size))
     {
         output_msg ("Error while writing Operation timestamp to file.\n");
         free (env_value.buffer);
@@ -306,8 +206,7 @@ int out_to_file(short source_or_target, short ascii_or_internal)
     /* Write Comlumn and Key Column Count to file */
     buf_size = sprintf ( buf, "  Number of Columns: %d\n  Number of Key Columns: %d\n\n"
                         ,table.num_columns, table.num_key_columns);
-    bytes_written = fwrite (buf, 1, buf_size, fp);
-    if (bytes_written != buf_size)
+    if (!exit_writer_write (writer, buf, buf_size))
     {
         output_msg ("Error while writing Column count to file.\n");
         free (env_value.buffer);
@@ -355,8 +254,7 @@ int out_to_file(short source_or_target, short ascii_or_internal)
 
         /* Write Comlumn Index and Column Name to file */
         buf_size = sprintf ( buf, "  %d. %s: ", column.column_index, env_value.buffer);
-        bytes_written = fwrite (buf, 1, buf_size, fp);
-        if (bytes_written != buf_size)
+        if (!exit_writer_write (writer, buf, buf_size))
         {
             output_msg ("Error while writingColumn count to file.\n");
             free (env_value.buffer);
@@ -383,14 +281,18 @@ int out_to_file(short source_or_target, short ascii_or_internal)
             if (ascii_or_internal == EXIT_FN_ASCII_FORMAT)
             {
                 output_msg ("Column value = %s.\n", column.column_value);
-                buf_size = sprintf (buf, "%s", column.column_value);
+                buf_size = sprintf (buf, "%.*s", (int)sizeof(buf) - 1,
+                                    column.column_value);
             }
             else
             {
                 /* Ouput internal value in hex */
                 output_msg ("Internal source column value = \n");
 
+                /* Longer values are cut to fit a line of buf */
                 col_len = column.actual_value_length;
+                if (col_len > sizeof(ascii_str) - 2)
+                    col_len = sizeof(ascii_str) - 2;
 
                 for (j = 0; j < col_len; j++)
                 {
@@ -402,8 +304,7 @@ int out_to_file(short source_or_target, short ascii_or_internal)
             }
         }
         /* Write Comlumn value */
-        bytes_written = fwrite (buf, 1, buf_size, fp);
-        if (bytes_written != buf_size)
+        if (!exit_writer_write (writer, buf, buf_size))
         {
             output_msg ("Error while writing Column value to file.\n");
             free (env_value.buffer);
@@ -413,12 +314,19 @@ int out_to_file(short source_or_target, short ascii_or_internal)
         }
     }
     buf_size = sprintf ( buf, "***************************************************\n\n");
-    bytes_written = fwrite (buf, 1, buf_size, fp);
+    if (!exit_writer_write (writer, buf, buf_size) ||
+        !exit_writer_end_record (writer))
+    {
+        output_msg ("Error while writing record end to file.\n");
+        free (env_value.buffer);
+        free (column.column_value);
+        free (record);
+        return FILE_IO_ERROR;
+    }
 
     free (env_value.buffer);
     free (column.column_value);
     free (record);
-    fclose (fp);
     return EXIT_FN_RET_OK;
 }
 
@@ -468,11 +376,32 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
         case EXIT_CALL_START:
             output_msg ("\nUser exit: EXIT_CALL_START.  Called from program: %s\n",
                         exit_params->program_name);
+
+            /* Create/Open(in Append Mode) Flat File and its writer */
+            writer = exit_writer_open (filename, 0,
+                                       getenv (ROTATE_ENV) ?
+                                       atol (getenv (ROTATE_ENV)) : 0);
+            if (!writer)
+            {
+                output_msg ("Error creating file flatfile.dat\n");
+                *exit_call_result = EXIT_ABEND_VAL;
+                return;
+            }
             break;
 
         case EXIT_CALL_STOP:
             output_msg ("\nUser exit: EXIT_CALL_STOP.\n");
 
+            /* Write out what is still queued */
+            if (writer && !exit_writer_close (writer))
+            {
+                writer = NULL;
+                output_msg ("Error while writing flatfile.dat\n");
+                *exit_call_result = EXIT_ABEND_VAL;
+                return;
+            }
+            writer = NULL;
+
             memset (&statistics, 0, sizeof(statistics));
 
             /* Retrieve statistics since application startup */
@@ -495,7 +424,6 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
                             "Total inserts:       \t%ld\n"
                             "Total updates:       \t%ld\n"
                             "Total deletes:       \t%ld\n"
-                            "Total upserts:       \t%ld\n"
                             "Total discards:      \t%ld\n"
                             "Total ignores:       \t%ld\n"
                             "Total truncates:     \t%ld\n"
@@ -503,8 +431,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
                             "Total operations:    \t%ld\n\n",
                             statistics.start_datetime, table_name,
                             statistics.num_inserts, statistics.num_updates,
-                            statistics.num_deletes, statistics.num_upserts, 
-                            statistics.num_discards,
+                            statistics.num_deletes, statistics.num_discards,
                             statistics.num_ignores, statistics.num_truncates,
                             statistics.total_db_operations, statistics.total_operations);
             }
@@ -522,6 +449,14 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
 
         case EXIT_CALL_CHECKPOINT:
             output_msg ("\nUser exit: EXIT_CALL_CHECKPOINT.\n");
+
+            /* The records before the checkpoint must be on disk */
+            if (!exit_writer_sync (writer))
+            {
+                output_msg ("Error while syncing flatfile.dat\n");
+                *exit_call_result = EXIT_ABEND_VAL;
+                return;
+            }
             break;
 
         case EXIT_CALL_PROCESS_MARKER:
@@ -572,7 +507,12 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
 
             free (error_info.error_msg);
             if (exit_call_type == EXIT_CALL_FATAL_ERROR)
+            {
+                if (writer)
+                    exit_writer_close (writer);
+                writer = NULL;
                 close_callback();
+            }
             break;
     }
 
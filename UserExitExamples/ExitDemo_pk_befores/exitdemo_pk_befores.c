@@ -247,7 +247,7 @@
   #include <ctype.h>
 #endif
 
-#include "usrdecs.h"
+#include "exitrt.h"
 
 static short set_delete = 1;
 static short is_extract = 0;
@@ -257,95 +257,6 @@ static short is_extract = 0;
 #define DEMO_TBL_NAME "PK_BF_TIMESRC"
 #define CONFLICT_COLUMN_NAME "LAST_UPDATE_DATETIME"
 
-/* ER callback routine */
-#ifndef WIN32
-void ERCALLBACK(ercallback_function_codes function_code,
-                void *buf, short *presult_code);
-#else
-typedef void (*FPERCALLBACK)(ercallback_function_codes function_code,
-                             void *buf, short *presult_code);
-
-HINSTANCE hEXE; /* EXE handle */
-FPERCALLBACK fp_ERCallback; /* Callback function pointer */
-
-/***************************************************************************
-  Open the ER callback function explicitly.
-***************************************************************************/
-short open_callback (char *executable_name,
-                     char *function_name)
-{
-    printf ("Opening callback for %s, %s.\n",
-            executable_name,
-            function_name);
-
-    hEXE = LoadLibrary (executable_name);
-    if (hEXE != NULL)
-    {
-        /* Function should always be exported in uppercase, since
-           GetProcAddress converts to uppercase then does a case-sensitive
-           search.  Don't use /NOIGNORE (/NOI) linker option. */
-        fp_ERCallback = (FPERCALLBACK)GetProcAddress(hEXE, function_name);
-
-        if (!fp_ERCallback)
-        {
-            FreeLibrary (hEXE);
-            return 0;
-        }
-    }
-    else
-        return 0;
-
-    return 1;
-}
-#endif
-
-/***************************************************************************
-  Close the callback function.
-***************************************************************************/
-void close_callback (void)
-{
-#ifdef WIN32
-    FreeLibrary (hEXE);
-#endif
-}
-
-/***************************************************************************
-  Call the callback function.
-***************************************************************************/
-void call_callback (ercallback_function_codes function_code,
-                    void *buf, short *result_code)
-{
-#ifdef WIN32
-    fp_ERCallback (function_code, buf, result_code);
-#else
-    ERCALLBACK (function_code, buf, result_code);
-#endif
-}
-/***************************************************************************
-  Output a message to the report file (or console).
-***************************************************************************/
-void output_msg (char *msg,...)
-{
-    short result_code;
-    char temp_msg[1000];
-
-    va_list args;
-
-    va_start (args, msg);
-
-    vsprintf (temp_msg, msg, args);
-
-    va_end (args);
-
-    call_callback (OUTPUT_MESSAGE_TO_REPORT, temp_msg, &result_code);
-}
-
-short IsPrint(int c)
-{
-    if (c != EOF) c = (unsigned char)c;
-    return isprint(c) ? 1 : 0;
-}
-
 /***************************************************************************
   Display record information.
 ***************************************************************************/
@@ -44,124 +44,44 @@
 #include <ctype.h>
 #endif
 
-#include "usrdecs.h"
+#include "exitrt.h"
+#include "exitarena.h"
+#include "tablemeta.h"
+#include "exitrecord.h"
+#include "exitsample.h"
+#include "exittrace.h"
+#include "exitprof.h"
 
-/* ER callback routine */
-#ifndef WIN32
-void ERCALLBACK(ercallback_function_codes function_code,
-                void *buf, short *presult_code);
-#else
-typedef void (*FPERCALLBACK)(ercallback_function_codes function_code,
-                             void *buf, short *presult_code);
-
-HINSTANCE hEXE; /* EXE handle */
-FPERCALLBACK fp_ERCallback; /* Callback function pointer */
+/* Environment variable giving the report log level, see exitlog.h */
+#define LOG_LEVEL_ENV "DDLEXTRACT_LOG_LEVEL"
 
-/***************************************************************************
-  Open the ER callback function explicitly.
-***************************************************************************/
-short open_callback (char *executable_name,
-                     char *function_name)
-{
-    printf ("Opening callback for %s, %s.\n",
-            executable_name,
-            function_name);
+/* Environment variable giving the checkpoint position sampling, see
+   exitrt.h */
+#define POSITION_ENV "DDLEXTRACT_POSITION"
 
-    hEXE = LoadLibrary (executable_name);
-    if (hEXE != NULL)
-    {
-        /* Function should always be exported in uppercase, since
-           GetProcAddress converts to uppercase then does a case-sensitive
-           search.  Don't use /NOIGNORE (/NOI) linker option. */
-        fp_ERCallback = (FPERCALLBACK)GetProcAddress(hEXE, function_name);
+/* Environment variable turning on the callback profiler, giving the
+   seconds between its summaries, see exitprof.h */
+#define PROFILE_ENV "DDLEXTRACT_PROFILE"
 
-        if (!fp_ERCallback)
-        {
-            FreeLibrary (hEXE);
-            return 0;
-        }
-    }
-    else
-        return 0;
+/* Environment variable choosing the DDL records that are displayed, see
+   exitsample.h */
+#define SAMPLE_ENV "DDLEXTRACT_SAMPLE"
 
-    return 1;
-}
-#endif
-
-/***************************************************************************
-  Close the callback function.
-***************************************************************************/
-void close_callback (void)
-{
-#ifdef WIN32
-    FreeLibrary (hEXE);
-#endif
-}
-
-/***************************************************************************
-  Call the callback function.
-***************************************************************************/
-void call_callback (ercallback_function_codes function_code,
-                    void *buf, short *result_code)
-{
-#ifdef WIN32
-    fp_ERCallback (function_code, buf, result_code);
-#else
-    ERCALLBACK (function_code, buf, result_code);
-#endif
-}
+/* Environment variable capping the report bytes per second, see
+   exitlog.h */
+#define REPORT_RATE_ENV "DDLEXTRACT_REPORT_RATE"
 
-/***************************************************************************
-  Test for Little Endian machine format
-***************************************************************************/
-short LittleEndian( void )
-{
-    short little_endian = 1;
-    char *little_endian_c = (char *)&little_endian;
+/* Checkpoint positions, read once per transaction by default */
+static exit_position_sampler positions;
 
-    if (*little_endian_c)
-    {
-        return 1;
-    }
-    return 0;
-}
+/* DDL records displayed, every one by default */
+static exit_sampler samples;
 
-/***************************************************************************
-  Reverse bytes for Little Endian/Big Endian
-***************************************************************************/
-void ReverseBytes (void *buf, short cnt)
-{
-    char *b = (char *)buf, *e = (char *)buf + cnt - 1;
-    char temp;
+/* Per-call scratch memory */
+static exit_arena arena;
 
-    for (; b < e; b++, e--)
-    {
-        temp = *b;
-        *b = *e;
-        *e = temp;
-    }
-}
-
-/***************************************************************************
-  Output a message to the report file (or console).
-***************************************************************************/
-void output_msg (char *msg,...)
-{
-    short result_code;
-    char temp_msg[1000];
-
-    va_list args;
-    va_start (args, msg);
-    vsprintf (temp_msg, msg, args);
-    va_end (args);
-    call_callback (OUTPUT_MESSAGE_TO_REPORT, temp_msg, &result_code);
-}
-
-short IsPrint(int c)
-{
-    if (c != EOF) c = (unsigned char)c;
-    return isprint(c) ? 1 : 0;
-}
+/* Columns of the record being displayed */
+static exit_record record_view;
 
 /***************************************************************************
   Display record information.
@@ -169,171 +89,92 @@ short IsPrint(int c)
 short display_record (short source_or_target,
                       short ascii_or_internal)
 {
-    int i, j, k;
+    int i;
     unsigned short col_len;
-    char hex_str[31];
-    char ascii_str[11];
-    char *a;
+    const char *value;
     short result_code;
-    table_def table;
-    column_def column;
-    env_value_def env_value;
-
-    /* initialize */
-    memset (&env_value, 0, sizeof(env_value_def));
-    env_value.max_length = 500;
-    env_value.buffer = (char *)malloc(500);
-    if (source_or_target == EXIT_FN_CURRENT_VAL)
-        env_value.source_or_target = EXIT_FN_TARGET_VAL;
-    else
-        env_value.source_or_target = source_or_target;
-
-    /* Get catalog name only */
-    call_callback (GET_CATALOG_NAME_ONLY, &env_value, &result_code);
-    if (result_code != EXIT_FN_RET_OK)
-    {
-        output_msg ("Error (%hd) retrieving catalog name.\n", result_code);
-        free (env_value.buffer);
-        return result_code;
-    }
-    output_msg ("Catalog name: %.*s \n",
-                env_value.actual_length, env_value.buffer);
-
-    /* Get schema name only */
-    call_callback (GET_SCHEMA_NAME_ONLY, &env_value, &result_code);
-    if (result_code != EXIT_FN_RET_OK)
-    {
-        output_msg ("Error (%hd) retrieving catalog name.\n", result_code);
-        free (env_value.buffer);
-        return result_code;
-    }
-    output_msg ("Schema  name: %.*s \n",
-                env_value.actual_length, env_value.buffer);
-
-    /* Get table name only */
-    call_callback (GET_TABLE_NAME_ONLY, &env_value, &result_code);
-    if (result_code != EXIT_FN_RET_OK)
-    {
-        output_msg ("Error (%hd) retrieving table name.\n", result_code);
-        free (env_value.buffer);
-        return result_code;
-    }
-    output_msg ("Table   name: %.*s \n",
-                env_value.actual_length, env_value.buffer);
-
-    /* Get fully qualified table name */
-    call_callback (GET_TABLE_NAME, &env_value, &result_code);
-    if (result_code != EXIT_FN_RET_OK)
-    {
-        output_msg ("Error (%hd) retrieving fully qualified table name.\n",
-                    result_code);
-        free (env_value.buffer);
-        return result_code;
-    }
-    output_msg ("Fully qualified table name: %.*s \n",
-                env_value.actual_length, env_value.buffer);
+    table_meta *meta;
 
-    /* Get table column information */
-    memset (&table, 0, sizeof(table_def));
-    if (source_or_target == EXIT_FN_CURRENT_VAL)
-        table.source_or_target = EXIT_FN_TARGET_VAL;
-    else
-        table.source_or_target = source_or_target;
-
-    call_callback (GET_TABLE_COLUMN_COUNT, &table, &result_code);
+    /* The whole record is read once, names come from the metadata cache */
+    result_code = exit_record_load (&record_view, source_or_target,
+                                    ascii_or_internal);
     if (result_code != EXIT_FN_RET_OK)
-    {
-        output_msg ("Error (%hd) retrieving table column count.\n",
-                    result_code);
-        free (env_value.buffer);
         return result_code;
-    }
-    output_msg ("Number of columns: %hd\n", table.num_columns);
+    meta = record_view.meta;
 
-    memset(&column, 0, sizeof (column_def));
-    column.source_or_target = source_or_target;
-    column.column_value_mode = ascii_or_internal;
-    column.column_value = (char*)malloc(4000);
-    column.max_value_length = 4000;
+    output_msg ("Catalog name: %s \n", meta->catalog_name);
+    output_msg ("Schema  name: %s \n", meta->schema_name);
+    output_msg ("Table   name: %s \n", meta->object_name);
+    output_msg ("Fully qualified table name: %s \n", meta->table_name);
+    output_msg ("Number of columns: %hd\n", meta->num_columns);
 
-    for (i = 0; i < table.num_columns; i++)
+    for (i = 0; i < record_view.num_columns; i++)
     {
-        env_value.index = column.column_index = i;
-
-        /* get column name */
-        call_callback (GET_COLUMN_NAME_FROM_INDEX, &env_value, &result_code);
-        if (result_code != EXIT_FN_RET_OK)
-        {
-            output_msg ("Error (%hd) retrieving column name.\n", result_code);
-            free (env_value.buffer);
-            free (column.column_value);
-            return result_code;
-        }
-        output_msg ("Column index (%d) = %.*s.\n",
-                    i, env_value.actual_length, env_value.buffer);
-
-        /* get column value */
-        call_callback (GET_COLUMN_VALUE_FROM_INDEX, &column, &result_code);
-        if (result_code != EXIT_FN_RET_OK &&
-            result_code != EXIT_FN_RET_COLUMN_NOT_FOUND)
-        {
-            output_msg ("Error (%hd) retrieving column value.\n", result_code);
-            free (env_value.buffer);
-            free (column.column_value);
-            return result_code;
-        }
+        output_msg ("Column index (%d) = %s.\n", i,
+                    exit_record_name (&record_view, i));
 
-        if (result_code == EXIT_FN_RET_COLUMN_NOT_FOUND)
+        if (record_view.null_flags[i] == EXIT_RECORD_MISSING)
             output_msg ("Column not found in record.\n");
         else
-        if (column.null_value)
+        if (record_view.null_flags[i] == EXIT_RECORD_NULL)
         {
-            if (column.is_hidden_column)
+            if (meta->columns[i].is_hidden_column)
                 output_msg ("Hidden column value is NULL.\n");
             else
                 output_msg ("Column value is NULL.\n");
         }
         else
         {
+            value = exit_record_value (&record_view, i);
+
             if (ascii_or_internal == EXIT_FN_ASCII_FORMAT)
-                output_msg ("Column value = %s.\n", column.column_value);
+                output_msg ("Column value = %s.\n", value);
             else
             {
                 /* Ouput internal value in hex */
-                if (column.is_hidden_column)
+                if (meta->columns[i].is_hidden_column)
                     output_msg ("Internal source hidden column value = \n");
                 else
                     output_msg ("Internal source column value = \n");
 
-                col_len = column.actual_value_length;
+                col_len = exit_record_length (&record_view, i);
 
-                for (j = 0; j < col_len; j += 10)
-                {
-                    for (a = column.column_value + j, k = 0;
-                         k < 10 && j + k < col_len;
-                         a++, k++)
-                    {
-                        ascii_str[k] =
-                                IsPrint (column.column_value[j + k]) ?
-                                column.column_value[j + k] : '.';
-                        sprintf (hex_str + (k * 3), "%02X ",
-                                 (unsigned char)column.column_value[j + k]);
-                    }
-                    ascii_str[k] = 0;
-
-                    output_msg ("%5d:  %-10s   %-30s\n",
-                                j, ascii_str, hex_str);
-                }
+                exit_log_hex_dump (EXIT_LOG_INFO, value, col_len);
             }
         }
     }
 
-    free (env_value.buffer);
-    free (column.column_value);
-
     return EXIT_FN_RET_OK;
 }
 
+/***************************************************************************
+  Drop the cached metadata of the table a DDL record touches, and of its
+  base table for DDL on an index or trigger.
+***************************************************************************/
+void invalidate_ddl_object (short source_or_target)
+{
+    static const ercallback_function_codes name_codes[] =
+        { GET_OBJECT_NAME, GET_BASE_OBJECT_NAME };
+    short result_code;
+    env_value_def env_value;
+    char object_name[500];
+    int i;
+
+    for (i = 0; i < 2; i++)
+    {
+        memset (&env_value, 0, sizeof(env_value_def));
+        env_value.buffer = object_name;
+        env_value.max_length = sizeof(object_name);
+        env_value.source_or_target = source_or_target;
+
+        call_callback (name_codes[i], &env_value, &result_code);
+        if (result_code != EXIT_FN_RET_OK || !env_value.actual_length)
+            continue;
+
+        table_meta_invalidate (object_name, env_value.actual_length);
+    }
+}
+
 /***************************************************************************
   Display DDL information.
 ***************************************************************************/
@@ -352,30 +193,25 @@ short display_ddl (short source_or_target,
         ddl_rec.source_or_target = source_or_target;
 
     ddl_rec.ddl_type_max_length = 500;
-    ddl_rec.ddl_type = (char *)malloc(500);
+    ddl_rec.ddl_type = (char *)exit_arena_alloc (&arena, 500);
 
     ddl_rec.object_type_max_length = 500;
-    ddl_rec.object_type = (char *)malloc(500);
+    ddl_rec.object_type = (char *)exit_arena_alloc (&arena, 500);
 
     ddl_rec.object_max_length = 500;
-    ddl_rec.object_name = (char *)malloc(500);
+    ddl_rec.object_name = (char *)exit_arena_alloc (&arena, 500);
 
-    ddl_rec.owner_name = (char *)malloc(500);
+    ddl_rec.owner_name = (char *)exit_arena_alloc (&arena, 500);
     ddl_rec.owner_max_length = 500;
 
     ddl_rec.ddl_text_max_length = 1000;
-    ddl_rec.ddl_text = (char *)malloc(1000);
+    ddl_rec.ddl_text = (char *)exit_arena_alloc (&arena, 1000);
 
     /* Get DDL properties */
     call_callback (GET_DDL_RECORD_PROPERTIES, &ddl_rec, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving DDL properties.\n", result_code);
-        free(ddl_rec.ddl_type);
-        free(ddl_rec.object_type);
-        free(ddl_rec.object_name);
-        free(ddl_rec.owner_name);
-        free(ddl_rec.ddl_text);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving DDL properties.\n", result_code);
         return result_code;
     }
 
@@ -389,17 +225,10 @@ short display_ddl (short source_or_target,
                 ddl_rec.object_name);
     output_msg ("----------------------------------------- \n");
 
-    free(ddl_rec.ddl_type);
-    free(ddl_rec.object_type);
-    free(ddl_rec.object_name);
-    free(ddl_rec.owner_name);
-    free(ddl_rec.ddl_text);
-
-
     /* initialize env_value*/
     memset (&env_value, 0, sizeof(env_value_def));
     env_value.max_length = 500;
-    env_value.buffer = (char *)malloc(500);
+    env_value.buffer = (char *)exit_arena_alloc (&arena, 500);
     if (source_or_target == EXIT_FN_CURRENT_VAL)
         env_value.source_or_target = EXIT_FN_TARGET_VAL;
     else
@@ -409,8 +238,7 @@ short display_ddl (short source_or_target,
     call_callback (GET_TABLE_NAME_ONLY, &env_value, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving table name.\n", result_code);
-        free (env_value.buffer);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving table name.\n", result_code);
         return result_code;
     }
     output_msg ("Table   name only: %.*s \n",
@@ -420,8 +248,7 @@ short display_ddl (short source_or_target,
     call_callback (GET_OBJECT_NAME_ONLY, &env_value, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving object name.\n", result_code);
-        free (env_value.buffer);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving object name.\n", result_code);
         return result_code;
     }
     output_msg ("Object  name only: %.*s \n",
@@ -431,8 +258,7 @@ short display_ddl (short source_or_target,
     call_callback (GET_SCHEMA_NAME_ONLY, &env_value, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving schema name.\n", result_code);
-        free (env_value.buffer);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving schema name.\n", result_code);
         return result_code;
     }
     output_msg ("Schema  name only: %.*s \n",
@@ -442,8 +268,7 @@ short display_ddl (short source_or_target,
     call_callback (GET_CATALOG_NAME_ONLY, &env_value, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving catalog name.\n", result_code);
-        free (env_value.buffer);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving catalog name.\n", result_code);
         return result_code;
     }
     output_msg ("Catalog name only: %.*s \n",
@@ -453,8 +278,7 @@ short display_ddl (short source_or_target,
     call_callback (GET_TABLE_NAME, &env_value, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving fully qualified table name.\n", result_code);
-        free (env_value.buffer);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving fully qualified table name.\n", result_code);
         return result_code;
     }
 
@@ -465,8 +289,7 @@ short display_ddl (short source_or_target,
     call_callback (GET_OBJECT_NAME, &env_value, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving fully qualified object name.\n", result_code);
-        free (env_value.buffer);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving fully qualified object name.\n", result_code);
         return result_code;
     }
     output_msg ("Object  name full: %.*s \n",
@@ -476,8 +299,7 @@ short display_ddl (short source_or_target,
     call_callback (GET_BASE_OBJECT_NAME_ONLY, &env_value, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving base object name.\n", result_code);
-        free (env_value.buffer);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving base object name.\n", result_code);
         return result_code;
     }
     output_msg ("Base object name only: %.*s \n",
@@ -487,8 +309,7 @@ short display_ddl (short source_or_target,
     call_callback (GET_BASE_SCHEMA_NAME_ONLY, &env_value, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving base schema name.\n", result_code);
-        free (env_value.buffer);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving base schema name.\n", result_code);
         return result_code;
     }
     output_msg ("Base schema name only: %.*s \n",
@@ -498,40 +319,29 @@ short display_ddl (short source_or_target,
     call_callback (GET_BASE_OBJECT_NAME, &env_value, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving fully qualified base object name.\n", result_code);
-        free (env_value.buffer);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving fully qualified base object name.\n", result_code);
         return result_code;
     }
     output_msg ("Base object name full: %.*s \n",
                 env_value.actual_length, env_value.buffer);
 
-    free(env_value.buffer);
     return EXIT_FN_RET_OK;
 }
 
 /***************************************************************************
-  ER user exit object called from various user exit points in extract and
-  replicat.
+  Handle one call of the user exit, for DDLEXTRACT.
 ***************************************************************************/
-#ifdef WIN32
-__declspec(dllexport) void DDLEXTRACT (exit_call_type_def exit_call_type,
-                      exit_result_def    *exit_call_result,
-                      exit_params_def    *exit_params)
-#else
-void DDLEXTRACT (exit_call_type_def exit_call_type,
-                exit_result_def    *exit_call_result,
-                exit_params_def    *exit_params)
-#endif
+static void process_exit_call (exit_call_type_def exit_call_type,
+                               exit_result_def    *exit_call_result,
+                               exit_params_def    *exit_params)
 {
     static short callback_opened = 0;
     short result_code;
     char table_name[200];
     char column_name_buf[200];
-    char print_msg[500];
-    exit_rec_buf_def *record_buffer = NULL;
-    exit_rec_buf_ascii_def *ascii_record_buffer = NULL;
-    record_def *record = NULL;
-    position_def *position_rec = NULL;
+    static exit_rec_buf_def *record_buffer = NULL;
+    static exit_rec_buf_ascii_def *ascii_record_buffer = NULL;
+    static record_def *record = NULL;
     token_value_def *token_rec = NULL;
     marker_info_def marker_info;
     error_info_def error_info;
@@ -574,16 +384,6 @@ void DDLEXTRACT (exit_call_type_def exit_call_type,
             "MEMBER"
     };
 
-    uint32_t seqno;
-    int32_t rba;
-
-    typedef struct
-    {
-        char ch_seqno[4];
-        char ch_rba[4];
-    } char_position;
-    char_position position_char;
-
     if (!callback_opened)
     {
         callback_opened = 1;
@@ -602,31 +402,98 @@ void DDLEXTRACT (exit_call_type_def exit_call_type,
 #endif
     }
 
-    record = (record_def *) malloc(sizeof (record_def));
-    record_buffer = (exit_rec_buf_def *) malloc(sizeof(exit_rec_buf_def));
-    ascii_record_buffer  = (exit_rec_buf_ascii_def *) malloc(sizeof (exit_rec_buf_ascii_def));
+    /* Scratch memory of the previous call is released here, so an early
+       return below never leaks it */
+    exit_arena_reset (&arena);
+
+    /* The record buffers are allocated by the first call and kept until
+       EXIT_CALL_STOP; their pages are only touched once a record fills
+       them */
+    if (!record)
+    {
+        record = (record_def *) malloc(sizeof (record_def));
+        record_buffer = (exit_rec_buf_def *) malloc(sizeof(exit_rec_buf_def));
+        ascii_record_buffer  = (exit_rec_buf_ascii_def *) malloc(sizeof (exit_rec_buf_ascii_def));
+        if (!record || !record_buffer || !ascii_record_buffer)
+        {
+            printf ("Error allocating the user exit record buffers.\n");
+            free (record);
+            free (record_buffer);
+            free (ascii_record_buffer);
+            record = NULL;
+            *exit_call_result = EXIT_ABEND_VAL;
+            return;
+        }
+    }
 
     switch (exit_call_type)
     {
         case EXIT_CALL_START:
+            exit_log_init (LOG_LEVEL_ENV);
             output_msg ("\nUser exit: EXIT_CALL_START.  Called from program: %s\n",
                         exit_params->program_name);
+
+            /* Size the scratch block once for the life of the process */
+            if (!exit_arena_init (&arena, EXIT_ARENA_SCRATCH))
+            {
+                exit_log (EXIT_LOG_ERROR, "Error allocating the user exit scratch memory.\n");
+                *exit_call_result = EXIT_ABEND_VAL;
+                return;
+            }
+
+            exit_position_init (&positions, POSITION_ENV,
+                                EXIT_POSITION_TRANSACTION);
+            output_msg ("\nUser exit: position sampling %s (%s)\n",
+                        exit_position_sampling_name (positions.sampling),
+                        POSITION_ENV);
+
+            exit_prof_init (PROFILE_ENV);
+            if (exit_prof_enabled)
+                output_msg ("\nUser exit: callback profile every %s seconds "
+                            "(%s)\n", getenv (PROFILE_ENV), PROFILE_ENV);
+
+            exit_sample_init (&samples, SAMPLE_ENV);
+            if (getenv (REPORT_RATE_ENV))
+            {
+                exit_log_rate_limit ((size_t)strtoul (getenv (REPORT_RATE_ENV),
+                                                      NULL, 10));
+                output_msg ("\nUser exit: report output limited to %s bytes "
+                            "per second (%s)\n", getenv (REPORT_RATE_ENV),
+                            REPORT_RATE_ENV);
+            }
+            if (samples.mode != EXIT_SAMPLE_ALL)
+                output_msg ("\nUser exit: %s %lu sampling of DDL records (%s)\n",
+                            exit_sample_mode_name (samples.mode), samples.n,
+                            SAMPLE_ENV);
+            exit_log_flush ();
             break;
 
         case EXIT_CALL_STOP:
             output_msg ("\nUser exit: EXIT_CALL_STOP.\n");
+            if (samples.mode != EXIT_SAMPLE_ALL)
+                output_msg ("\nUser exit: %lu of %lu DDL records sampled\n",
+                            samples.taken, samples.seen);
+            exit_sample_free (&samples);
+            exit_prof_report ();
+            exit_prof_free ();
+            exit_log_flush ();
             break;
 
         case EXIT_CALL_BEGIN_TRANS:
             output_msg ("\nUser exit: EXIT_CALL_BEGIN_TRANS.\n");
+            exit_position_sample (&positions, EXIT_POSITION_TRANSACTION);
             break;
 
         case EXIT_CALL_END_TRANS:
             output_msg ("\nUser exit: EXIT_CALL_END_TRANS.\n");
+            exit_log_flush ();
             break;
 
         case EXIT_CALL_CHECKPOINT:
             /*output_msg ("\nUser exit: Extract just performed an EXIT_CALL_CHECKPOINT.\n");*/
+            exit_position_sample (&positions, EXIT_POSITION_CHECKPOINT);
+            exit_prof_checkpoint ();
+            exit_log_flush ();
             break;
 
         case EXIT_CALL_PROCESS_MARKER:
@@ -637,47 +504,7 @@ void DDLEXTRACT (exit_call_type_def exit_call_type,
             /* For extract called before a record buffer is output to the trail */
             output_msg ("\nUser exit: EXIT_CALL_PROCESS_RECORD.\n");
 
-            position_rec = (position_def *) malloc (sizeof(position_def));
-            position_rec->position = (char *) malloc (sizeof (uint32_t) + sizeof (int32_t));  /* current expected size of seqno and rba */
-
-            position_rec->ascii_or_internal = EXIT_FN_INTERNAL_FORMAT;
-            position_rec->position_type = STARTUP_CHECKPOINT;
-            call_callback (GET_POSITION,  position_rec,&result_code);
-            if (!result_code)
-            {
-                memcpy (&position_char, position_rec->position, position_rec->position_len);
-                if (LittleEndian())
-                {
-                    ReverseBytes (&position_char.ch_seqno, sizeof (position_char.ch_seqno));
-                    ReverseBytes (&position_char.ch_rba, sizeof (position_char.ch_rba));
-                }
-                memcpy (&seqno, position_char.ch_seqno, sizeof (seqno));
-                memcpy (&rba, position_char.ch_rba, sizeof (rba));
-                sprintf (print_msg, "\nGET_POSITION STARTUP_CHECKPOINT, values seqno %ld rba %ld\n",
-                         (long) seqno, (long) rba );
-                call_callback (OUTPUT_MESSAGE_TO_REPORT, &print_msg, &result_code);
-            }
-
-            position_rec->ascii_or_internal = EXIT_FN_INTERNAL_FORMAT;
-            position_rec->position_type = CURRENT_CHECKPOINT;
-            call_callback (GET_POSITION,  position_rec,&result_code);
-            if (!result_code)
-            {
-                memcpy (&position_char, position_rec->position, position_rec->position_len);
-                if (LittleEndian())
-                {
-                    ReverseBytes (&position_char.ch_seqno, sizeof (position_char.ch_seqno));
-                    ReverseBytes (&position_char.ch_rba, sizeof (position_char.ch_rba));
-                }
-                memcpy (&seqno, position_char.ch_seqno, sizeof (seqno));
-                memcpy (&rba, position_char.ch_rba, sizeof (rba));
-                sprintf (print_msg, "\nGET_POSITION CURRENT_CHECKPOINT, values seqno %ld rba %ld\n",
-                         (long) seqno, (long) rba );
-                call_callback (OUTPUT_MESSAGE_TO_REPORT, &print_msg, &result_code);
-            }
-
-            free(position_rec->position);
-            free(position_rec);
+            exit_position_sample (&positions, EXIT_POSITION_RECORD);
 
             memset (record, 0, sizeof(record));
             record->source_or_target = EXIT_FN_SOURCE_VAL;
@@ -686,10 +513,7 @@ void DDLEXTRACT (exit_call_type_def exit_call_type,
             call_callback (GET_OPERATION_TYPE, record, &result_code);
             if (result_code != EXIT_FN_RET_OK)
             {
-                output_msg ("Error (%hd) retrieving operation type.\n", result_code);
-                free (record);
-                free (record_buffer);
-                free (ascii_record_buffer);
+                exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving operation type.\n", result_code);
                 *exit_call_result = EXIT_ABEND_VAL;
                 return;
             }
@@ -697,16 +521,22 @@ void DDLEXTRACT (exit_call_type_def exit_call_type,
             /* Process DDL Commands */
             if (record->io_type == SQL_DDL_VAL)
             {
+                /* The DDL may change the table's columns or key */
+                invalidate_ddl_object (EXIT_FN_SOURCE_VAL);
+                invalidate_ddl_object (EXIT_FN_TARGET_VAL);
+
+                /* Display only the sampled DDL */
+                if (exit_log_rate_exceeded () ||
+                    !exit_sample_take (&samples, NULL, 0))
+                    break;
+
                 output_msg ("\n*** SOURCE DDL COMMAND***\n");
                 result_code = display_ddl (EXIT_FN_SOURCE_VAL,
                                            EXIT_FN_INTERNAL_FORMAT);
                 if (result_code != EXIT_FN_RET_OK)
                 {
-                    output_msg ("Error (%hd) displaying DDL information.\n",
-                                result_code);
-                    free (record);
-                    free (record_buffer);
-                    free (ascii_record_buffer);
+                    exit_log (EXIT_LOG_ERROR, "Error (%hd) displaying DDL information.\n",
+                              result_code);
                     *exit_call_result = EXIT_ABEND_VAL;
                     return;
                 }
@@ -717,11 +547,8 @@ void DDLEXTRACT (exit_call_type_def exit_call_type,
                                            EXIT_FN_INTERNAL_FORMAT);
                 if (result_code != EXIT_FN_RET_NOT_SUPPORTED && result_code != EXIT_FN_RET_OK)
                 {
-                    output_msg ("Error (%hd) displaying DDL information.\n",
-                                result_code);
-                    free (record);
-                    free (record_buffer);
-                    free (ascii_record_buffer);
+                    exit_log (EXIT_LOG_ERROR, "Error (%hd) displaying DDL information.\n",
+                              result_code);
                     *exit_call_result = EXIT_ABEND_VAL;
                     return;
                 }
@@ -732,35 +559,58 @@ void DDLEXTRACT (exit_call_type_def exit_call_type,
             output_msg ("\nUser exit: EXIT_CALL_FATAL_ERROR.\n");
 
             memset (&error_info, 0, sizeof(error_info));
-            error_info.error_msg = (char *)malloc(500);
+            error_info.error_msg = (char *)exit_arena_alloc (&arena, 500);
             error_info.max_length = 500; /* Including null terminator */
 
             call_callback (GET_ERROR_INFO, &error_info, &result_code);
             if (result_code != EXIT_FN_RET_OK)
             {
-                output_msg ("Error (%hd) retrieving error information.\n", result_code);
-                free (error_info.error_msg);
-                free (record);
-                free (record_buffer);
-                free (ascii_record_buffer);
+                exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving error information.\n", result_code);
                 *exit_call_result = EXIT_ABEND_VAL;
                 return;
             }
 
-            output_msg ("Error information:\n"
-                        "Error number: %ld.\n"
-                        "Error message: %s.\n\n",
-                        error_info.error_num,
-                        error_info.error_msg);
+            exit_log (EXIT_LOG_ERROR, "Error information:\n"
+                      "Error number: %ld.\n"
+                      "Error message: %s.\n\n",
+                      error_info.error_num,
+                      error_info.error_msg);
 
-            free (error_info.error_msg);
+            exit_log_flush ();
             close_callback();
             break;
     }
 
-    free (record);
-    free (record_buffer);
-    free (ascii_record_buffer);
+    if (exit_call_type == EXIT_CALL_STOP)
+    {
+        free (record);
+        free (record_buffer);
+        free (ascii_record_buffer);
+        record = NULL;
+        exit_arena_release (&arena);
+        exit_record_free (&record_view);
+        table_meta_free_all ();
+    }
+
     *exit_call_result = EXIT_OK_VAL;
     fflush (stdout);
 }
+
+/***************************************************************************
+  ER user exit object called from various user exit points in extract and
+  replicat.  The call is traced as a whole, see exittrace.h.
+***************************************************************************/
+#ifdef WIN32
+__declspec(dllexport) void DDLEXTRACT (exit_call_type_def exit_call_type,
+                      exit_result_def    *exit_call_result,
+                      exit_params_def    *exit_params)
+#else
+void DDLEXTRACT (exit_call_type_def exit_call_type,
+                exit_result_def    *exit_call_result,
+                exit_params_def    *exit_params)
+#endif
+{
+    exit_trace_call_begin (exit_call_type);
+    process_exit_call (exit_call_type, exit_call_result, exit_params);
+    exit_trace_call_end (exit_call_type, *exit_call_result);
+}
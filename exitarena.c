@@ -0,0 +1,113 @@
+/**************************************************************************
+  Program description:
+
+  Per-call scratch memory for the user exits.  See exitarena.h.
+
+***************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "exitarena.h"
+
+/* Size of a block header, keeping allocations aligned */
+#define BLOCK_HEADER ((sizeof(exit_arena_block) + EXIT_ARENA_ALIGN - 1) & \
+                      ~(size_t)(EXIT_ARENA_ALIGN - 1))
+
+/***************************************************************************
+  Allocate a scratch block in front of the current one.
+***************************************************************************/
+static int add_block (exit_arena *arena, size_t size)
+{
+    exit_arena_block *block;
+
+    block = (exit_arena_block *)malloc (BLOCK_HEADER + size);
+    if (!block)
+        return 0;
+    block->next = arena->scratch;
+    block->size = size;
+    block->used = 0;
+    arena->scratch = block;
+    arena->scratch_total += size;
+    return 1;
+}
+
+/***************************************************************************
+  Allocate the scratch block, called at EXIT_CALL_START.  Returns 0 on
+  allocation failure.
+***************************************************************************/
+int exit_arena_init (exit_arena *arena, size_t scratch_size)
+{
+    if (arena->scratch)
+        return 1;
+    return add_block (arena, scratch_size ? scratch_size : EXIT_ARENA_SCRATCH);
+}
+
+/***************************************************************************
+  Allocate scratch memory for the current call.  It stays valid until the
+  next exit_arena_reset().  Returns NULL on allocation failure.
+***************************************************************************/
+void *exit_arena_alloc (exit_arena *arena, size_t size)
+{
+    exit_arena_block *block;
+    void *p;
+
+    size = (size + EXIT_ARENA_ALIGN - 1) & ~(size_t)(EXIT_ARENA_ALIGN - 1);
+
+    block = arena->scratch;
+    if (!block || block->size - block->used < size)
+    {
+        if (!add_block (arena, size > EXIT_ARENA_SCRATCH ? size
+                                                         : EXIT_ARENA_SCRATCH))
+            return NULL;
+        block = arena->scratch;
+    }
+
+    p = (char *)block + BLOCK_HEADER + block->used;
+    block->used += size;
+    return p;
+}
+
+/***************************************************************************
+  Release all scratch memory of the previous call.  If it needed overflow
+  blocks, they are replaced by one block as large as all of them.
+***************************************************************************/
+void exit_arena_reset (exit_arena *arena)
+{
+    exit_arena_block *block;
+    size_t total = arena->scratch_total;
+
+    if (!arena->scratch)
+        return;
+
+    if (!arena->scratch->next)
+    {
+        arena->scratch->used = 0;
+        return;
+    }
+
+    while (arena->scratch)
+    {
+        block = arena->scratch;
+        arena->scratch = block->next;
+        free (block);
+    }
+    arena->scratch_total = 0;
+    add_block (arena, total);
+}
+
+/***************************************************************************
+  Release all scratch blocks, called at EXIT_CALL_STOP.
+***************************************************************************/
+void exit_arena_release (exit_arena *arena)
+{
+    exit_arena_block *block;
+
+    while (arena->scratch)
+    {
+        block = arena->scratch;
+        arena->scratch = block->next;
+        free (block);
+    }
+    memset (arena, 0, sizeof(exit_arena));
+}
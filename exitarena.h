@@ -0,0 +1,47 @@
+/**************************************************************************
+  Program description:
+
+  Per-call scratch memory for the user exits.
+
+  Temporaries needed while handling one call (column values, names, DDL
+  text, error messages) are bump allocated from a scratch block that is
+  rewound at the start of the next call, so they are never freed one by
+  one and an early return cannot leak them.  When a call needs more than
+  the block holds, overflow blocks are chained and the block is enlarged
+  to the total at the next rewind.
+
+  The arena does not depend on usrdecs.h, which may only be included once
+  per shared object.
+
+***************************************************************************/
+
+#ifndef EXITARENA_H__
+#define EXITARENA_H__
+
+#include <stddef.h>
+
+/* Initial scratch block size */
+#define EXIT_ARENA_SCRATCH (64 * 1024)
+
+/* Scratch allocations are aligned on this */
+#define EXIT_ARENA_ALIGN 16
+
+typedef struct exit_arena_block
+{
+    struct exit_arena_block *next; /* Overflow block allocated before it */
+    size_t size;                /* Usable bytes after the header */
+    size_t used;                /* Allocated bytes */
+} exit_arena_block;
+
+typedef struct
+{
+    exit_arena_block *scratch;  /* Current scratch block */
+    size_t scratch_total;       /* Bytes of all scratch blocks */
+} exit_arena;
+
+int exit_arena_init (exit_arena *arena, size_t scratch_size);
+void *exit_arena_alloc (exit_arena *arena, size_t size);
+void exit_arena_reset (exit_arena *arena);
+void exit_arena_release (exit_arena *arena);
+
+#endif /* EXITARENA_H__ */
@@ -0,0 +1,105 @@
+#!/bin/sh
+#-------------------------------------------------------------------#
+#   Exit benchmark suite                                            #
+#                                                                   #
+#   Usage:                                                          #
+#       make -f Makefile_userexits.LINUX exitbench                  #
+#       sh exitbench.sh [<results file>]                            #
+#                                                                   #
+#   Description:                                                    #
+#       Runs every user exit under exithost against the standard    #
+#       workloads and prints one BENCH line of name=value pairs     #
+#       per exit and workload (see exithost.c), also appended to    #
+#       <results file> if given, so runs can be compared.           #
+#                                                                   #
+#       narrow   4 columns of 8 bytes                               #
+#       wide     128 columns of 32 bytes                            #
+#       lob      4 columns of 30000 bytes                           #
+#       ddl      bursts of 50 DDL records every 1000 records        #
+#       reject   an EXITPARAM Org Id list matching 1% of records    #
+#                                                                   #
+#       RECORDS sets the records per run (default 200000, a tenth   #
+#       of it for lob).  The exits run in a scratch directory with  #
+#       a dirdat subdirectory for the files they write.  An exit    #
+#       that does not build or fails a run is reported, and the     #
+#       suite then exits with status 1.                             #
+#-------------------------------------------------------------------#
+
+RECORDS=${RECORDS:-200000}
+RESULTS=$1
+EXAMPLES=UserExitExamples
+TMPDIR=${TMPDIR:-/tmp}
+ORGIDS=$TMPDIR/exitbench_orgids.$$
+WORKDIR=$TMPDIR/exitbench_work.$$
+FAILED=$TMPDIR/exitbench_failed.$$
+HOST=`pwd`/exithost
+
+trap 'rm -rf $ORGIDS $WORKDIR $FAILED' 0
+mkdir -p $WORKDIR/dirdat
+
+# exithost draws ORGANIZATION_ID from 1000 values 100000 + 7 * k
+k=0
+while [ $k -lt 10 ]
+do
+    echo "$((100000 + 7 * k))"
+    k=$((k + 1))
+done > $ORGIDS
+
+for makefile in $EXAMPLES/*/Makefile_*.LINUX
+do
+    (cd `dirname $makefile` && make -f `basename $makefile` > /dev/null 2>&1)
+done
+
+run ()
+{
+    library=$1
+    function=$2
+    workload=$3
+    shift 3
+
+    if [ ! -f $library ]
+    then
+        echo "exitbench: $library not built" 1>&2
+        echo $library >> $FAILED
+        return
+    fi
+    path=`cd \`dirname $library\` && pwd`/`basename $library`
+    if ! (cd $WORKDIR && $HOST -q -b $workload "$@" $path $function) \
+        > $WORKDIR/out 2>&1
+    then
+        echo "exitbench: $library failed the $workload workload:" 1>&2
+        grep -v '^BENCH' $WORKDIR/out 1>&2
+        echo $library >> $FAILED
+        return
+    fi
+    grep '^BENCH' $WORKDIR/out |
+    if [ -n "$RESULTS" ]
+    then
+        tee -a $RESULTS
+    else
+        cat
+    fi
+}
+
+for exit in \
+    "$EXAMPLES/ExitDemo/exitdemo.so CUSEREXIT" \
+    "$EXAMPLES/ExitDemo_passthru/exitdemo_passthru.so CUSEREXIT" \
+    "$EXAMPLES/ExitDemo_more_recs/exitdemo_more_recs.so CUSEREXIT" \
+    "$EXAMPLES/ExitDemo_lobs/exitdemo_lob.so CUSEREXIT" \
+    "$EXAMPLES/ExitDemo_pk_befores/exitdemo_pk_befores.so CUSEREXIT" \
+    "./ddlextract.so DDLEXTRACT" \
+    "./modified_exitdemo.so CUSEREXIT"
+do
+    set -- $exit
+    run $1 $2 narrow -n $RECORDS -c 4 -w 8
+    run $1 $2 wide -n $RECORDS -c 128 -w 32
+    run $1 $2 lob -n $((RECORDS / 10)) -c 4 -w 30000
+    run $1 $2 ddl -n $RECORDS -d 1000 -D 50
+    run $1 $2 reject -n $RECORDS -o 1000 -p $ORGIDS
+done
+
+if [ -s $FAILED ]
+then
+    echo "exitbench: `sort -u $FAILED | wc -l` exits incomplete" 1>&2
+    exit 1
+fi
@@ -0,0 +1,2199 @@
+/**************************************************************************
+  Program description:
+
+  Stand-alone ERCALLBACK host, for running a user exit without Extract or
+  Replicat.
+
+      exithost [options] <exit.so> [<function>]
+
+  The host loads the exit with dlopen, resolves its entry point (CUSEREXIT
+  by default) and drives the EXIT_CALL_* lifecycle over a record stream:
+  EXIT_CALL_START, then per transaction EXIT_CALL_BEGIN_TRANS, one
+  EXIT_CALL_PROCESS_RECORD per record and EXIT_CALL_END_TRANS, with
+  checkpoints, markers, metadata events and discards in between, and
+  EXIT_CALL_STOP at the end.  The exit's callbacks are answered from the
+  stream.  The host is linked with -rdynamic so that the exit resolves
+  ERCALLBACK from it, as it does from the GoldenGate process.
+
+  The stream is either synthetic or replayed from a file:
+
+      -n <records>   synthetic records (default 100000)
+      -t <tables>    synthetic tables TESTSRC.TABLE1... (default 4)
+      -c <columns>   columns per table, ID and ORGANIZATION_ID first
+                     (default 8)
+      -w <bytes>     width of the other column values (default 16)
+      -o <orgids>    distinct ORGANIZATION_ID values (default 1000)
+      -x <records>   records per transaction (default 10)
+      -d <records>   a DDL record every <records> records (default 0, none)
+      -D <records>   DDL records in a row each time (default 1)
+      -k <trans>     a checkpoint every <trans> transactions (default 100)
+      -r <file>      replay a recorded stream instead
+      -l <loops>     replay the recorded stream this many times (default 1)
+      -R <rate>      deliver at most <rate> records per second
+                     (default 0, no limit)
+      -p <param>     EXITPARAM, passed to the exit as function_param
+      -m             records are mapped, as in Replicat
+      -q             discard the report instead of writing it to stdout
+      -b <workload>  also print a benchmark result line, labelled <workload>
+
+  A recorded stream is a text file of one step per line:
+
+      # comment
+      TABLE <owner.table> <column>[:N][:K] ...     N numeric, K key column
+      BEGIN
+      INSERT|UPDATE|PKUPDATE|BEFORE|DELETE|TRUNCATE <owner.table>
+          [<column>=<value> ...]
+      TOKEN <name>=<value>                         token of the next record
+      DDL <type> <object type> <owner.object> [ON <owner.table>] <text>
+      COMMIT | ROLLBACK
+      CHECKPOINT
+      MARKER <text>
+      EVENT <owner.table>                          table metadata event
+      DISCARD <error number> <message>             discard the last record
+
+  A value may be double quoted to hold white space, and a column without
+  =<value> is NULL.  BEFORE is the before image of an update, PKUPDATE
+  an update of the primary key.  A record outside BEGIN and COMMIT is a
+  transaction of its own.  Numeric columns are delivered as 8 byte big
+  endian integers in the internal format, as in the trail.  When the exit
+  asks for the record again (more_recs_ind), it is delivered unchanged.
+
+  At the end the host prints the exit calls and their results, the
+  callbacks by function code and the record rate, measured from the end
+  of EXIT_CALL_START to the start of EXIT_CALL_STOP.  With -b it times
+  every EXIT_CALL_PROCESS_RECORD call and counts the memory the exit
+  allocates (glibc only), and adds one line of name=value pairs for
+  exitbench.sh and other scripts:
+
+      BENCH exit=<exit.so> workload=<workload> records=<n> records_per_sec=<r>
+          p50_ns=<t> p99_ns=<t> p999_ns=<t> callbacks_per_record=<c>
+          allocs_per_record=<a> alloc_bytes_per_record=<b>
+
+  The allocation counts are -1 where the C library cannot be interposed.
+
+***************************************************************************/
+
+#include <ctype.h>
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* The host answers the callbacks, the exit defines the version function */
+#define GOLDENGATE__
+#include "exitrt.h"
+
+/* Limits of a stream */
+#define HOST_MAX_TABLES  1024
+#define HOST_MAX_COLUMNS 256
+#define HOST_MAX_TOKENS  16
+
+/* Bytes of column values an exit may set on one record */
+#define HOST_SET_SPACE (1024 * 1024)
+
+/* Callback function codes, for the summary */
+#define HOST_NUM_FUNCTIONS (GET_EVENT_RECORD + 1)
+
+/* Stream steps */
+#define STEP_BEGIN      1
+#define STEP_RECORD     2
+#define STEP_COMMIT     3
+#define STEP_ROLLBACK   4
+#define STEP_CHECKPOINT 5
+#define STEP_MARKER     6
+#define STEP_EVENT      7
+#define STEP_DISCARD    8
+
+typedef void (*exit_function) (exit_call_type_def exit_call_type,
+                               exit_result_def *exit_call_result,
+                               exit_params_def *exit_params);
+
+typedef struct
+{
+    int64_t inserts;
+    int64_t updates;
+    int64_t befores;
+    int64_t deletes;
+    int64_t discards;
+    int64_t ignores;
+    int64_t truncates;
+    int64_t db_operations;
+    int64_t operations;
+} host_counts;
+
+typedef struct
+{
+    char *name;                             /* [CATALOG.]SCHEMA.TABLE */
+    short num_columns;
+    short num_key_columns;
+    char *column_names[HOST_MAX_COLUMNS];
+    short numeric[HOST_MAX_COLUMNS];
+    short key_index[HOST_MAX_COLUMNS];      /* Order in the key, -1 if none */
+    short key_columns[HOST_MAX_COLUMNS];
+    host_counts counts[2];                  /* Since startup, since reset */
+} host_table;
+
+typedef struct
+{
+    int kind;
+    host_table *table;
+    short io_type;
+    char before_after_ind;
+
+    /* Record values, by column index */
+    const char *values[HOST_MAX_COLUMNS];
+    unsigned short lengths[HOST_MAX_COLUMNS];
+    short nulls[HOST_MAX_COLUMNS];
+
+    short num_tokens;
+    const char *token_names[HOST_MAX_TOKENS];
+    const char *token_values[HOST_MAX_TOKENS];
+
+    /* DDL */
+    const char *ddl_type;
+    const char *object_type;
+    const char *object_name;
+    const char *base_object_name;
+
+    /* DDL, marker or discard text */
+    const char *text;
+    long error_num;
+} host_step;
+
+/* Options */
+static long num_records = 100000;
+static int num_tables = 4;
+static int num_columns = 8;
+static int value_width = 16;
+static long num_org_ids = 1000;
+static long records_per_trans = 10;
+static long ddl_interval = 0;
+static long ddl_burst = 1;
+static long checkpoint_interval = 100;
+static const char *replay_file = NULL;
+static long loops = 1;
+static double rate = 0;
+static short mapped = 0;
+static FILE *report = NULL;
+
+static host_table tables[HOST_MAX_TABLES];
+static int tables_used = 0;
+
+/* Replayed stream */
+static host_step *steps = NULL;
+static size_t steps_used = 0;
+static size_t steps_max = 0;
+
+/* Step being delivered to the exit */
+static const host_step *current = NULL;
+static const host_step *last_record = NULL;
+static const host_step *discard = NULL;
+static short current_io_type;
+static short current_transaction_ind;
+static const char *values[HOST_MAX_COLUMNS];
+static unsigned short lengths[HOST_MAX_COLUMNS];
+static short nulls[HOST_MAX_COLUMNS];
+static char set_space[HOST_SET_SPACE];
+static size_t set_used;
+static short ascii_record = 0;          /* EXIT_CALL_DISCARD_ASCII_RECORD */
+
+/* Trail position of the current record */
+static uint32_t position_seqno = 0;
+static int32_t position_rba = 0;
+
+static ULibCharSet session_charset = ULIB_CS_DEFAULT;
+static char start_datetime[30];
+static char reset_datetime[30];
+
+/* Summary */
+static unsigned long exit_calls[EXIT_CALL_FATAL_ERROR + 1];
+static unsigned long exit_results[EXIT_PROCESSED_REC_VAL + 1];
+static unsigned long callbacks[HOST_NUM_FUNCTIONS];
+static unsigned long report_messages = 0;
+static unsigned long report_bytes = 0;
+
+/* Benchmark: EXIT_CALL_PROCESS_RECORD latencies and the exit's allocations */
+static const char *workload = NULL;
+static unsigned long *latencies = NULL;
+static size_t latencies_used = 0;
+static size_t latencies_max = 0;
+static int counting = 0;
+static unsigned long long alloc_calls = 0;
+static unsigned long long alloc_bytes = 0;
+
+static const char *function_names[HOST_NUM_FUNCTIONS] =
+{
+    "COMPRESS_RECORD", "DECOMPRESS_RECORD", "GET_BEFORE_AFTER_IND",
+    "GET_COLUMN_INDEX_FROM_NAME", "GET_COLUMN_NAME_FROM_INDEX",
+    "GET_COLUMN_VALUE_FROM_INDEX", "GET_COLUMN_VALUE_FROM_NAME",
+    "GET_ERROR_INFO", "GET_MARKER_INFO", "GET_OPERATION_TYPE",
+    "GET_RECORD_BUFFER", "GET_RECORD_LENGTH", "GET_RECORD_TYPE",
+    "GET_STATISTICS", "GET_TABLE_COLUMN_COUNT", "GET_TABLE_NAME",
+    "GET_TIMESTAMP", "GET_TRANSACTION_IND", "SET_COLUMN_VALUE_BY_INDEX",
+    "SET_COLUMN_VALUE_BY_NAME", "SET_OPERATION_TYPE", "SET_RECORD_BUFFER",
+    "SET_TABLE_NAME", "FETCH_CURRENT_RECORD",
+    "FETCH_CURRENT_RECORD_WITH_LOCK", "OUTPUT_MESSAGE_TO_REPORT",
+    "GET_COL_METADATA_FROM_INDEX", "GET_COL_METADATA_FROM_NAME",
+    "GET_TABLE_METADATA", "GET_POSITION", "GET_USER_TOKEN_VALUE",
+    "GET_ENV_VALUE", "GET_DDL_RECORD_PROPERTIES", "RESET_USEREXIT_STATS",
+    "GET_GMT_TIMESTAMP", "SET_SESSION_CHARSET", "GET_SESSION_CHARSET",
+    "GET_DATABASE_METADATA", "GET_TABLE_NAME_ONLY", "GET_SCHEMA_NAME_ONLY",
+    "GET_CATALOG_NAME_ONLY", "GET_OBJECT_NAME_ONLY", "GET_OBJECT_NAME",
+    "GET_BASE_OBJECT_NAME_ONLY", "GET_BASE_SCHEMA_NAME_ONLY",
+    "GET_BASE_OBJECT_NAME", "GET_EVENT_RECORD"
+};
+
+static const char *exit_call_name (int exit_call_type)
+{
+    switch (exit_call_type)
+    {
+        case EXIT_CALL_START:                return "START";
+        case EXIT_CALL_BEGIN_TRANS:          return "BEGIN_TRANS";
+        case EXIT_CALL_PROCESS_RECORD:       return "PROCESS_RECORD";
+        case EXIT_CALL_DISCARD_ASCII_RECORD: return "DISCARD_ASCII_RECORD";
+        case EXIT_CALL_DISCARD_RECORD:       return "DISCARD_RECORD";
+        case EXIT_CALL_END_TRANS:            return "END_TRANS";
+        case EXIT_CALL_CHECKPOINT:           return "CHECKPOINT";
+        case EXIT_CALL_PROCESS_MARKER:       return "PROCESS_MARKER";
+        case EXIT_CALL_STOP:                 return "STOP";
+        case EXIT_CALL_DISCARD_TRANS_RECORD: return "DISCARD_TRANS_RECORD";
+        case EXIT_CALL_ABORT_TRANS:          return "ABORT_TRANS";
+        case EXIT_CALL_EVENT_RECORD:         return "EVENT_RECORD";
+        case EXIT_CALL_FATAL_ERROR:          return "FATAL_ERROR";
+    }
+    return NULL;
+}
+
+#ifdef __GLIBC__
+/***************************************************************************
+  Allocation counting.  The host is linked with -rdynamic, so these
+  replace the C library's allocator for the exit as well; they count
+  while an exit call is benchmarked and pass everything on.
+***************************************************************************/
+#define HOST_COUNTS_ALLOCS 1
+
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t count, size_t size);
+extern void *__libc_realloc (void *p, size_t size);
+extern void __libc_free (void *p);
+
+void *malloc (size_t size)
+{
+    if (counting)
+    {
+        alloc_calls++;
+        alloc_bytes += size;
+    }
+    return __libc_malloc (size);
+}
+
+void *calloc (size_t count, size_t size)
+{
+    if (counting)
+    {
+        alloc_calls++;
+        alloc_bytes += count * size;
+    }
+    return __libc_calloc (count, size);
+}
+
+void *realloc (void *p, size_t size)
+{
+    if (counting)
+    {
+        alloc_calls++;
+        alloc_bytes += size;
+    }
+    return __libc_realloc (p, size);
+}
+
+void free (void *p)
+{
+    __libc_free (p);
+}
+#else
+#define HOST_COUNTS_ALLOCS 0
+#endif
+
+/***************************************************************************
+  Monotonic time in nanoseconds.
+***************************************************************************/
+static double now_ns (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/***************************************************************************
+  Small xorshift generator, so every synthetic run delivers the same
+  records.
+***************************************************************************/
+static unsigned long long next_random (unsigned long long *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static void *host_alloc (size_t size)
+{
+    void *p = calloc (1, size ? size : 1);
+
+    if (!p)
+    {
+        fprintf (stderr, "Out of memory\n");
+        exit (1);
+    }
+    return p;
+}
+
+static char *host_strndup (const char *value, size_t length)
+{
+    char *copy = (char *)host_alloc (length + 1);
+
+    memcpy (copy, value, length);
+    return copy;
+}
+
+static int names_equal (const char *a, const char *b, size_t b_length)
+{
+    size_t i;
+
+    for (i = 0; i < b_length; i++)
+        if (!a[i] || toupper ((unsigned char)a[i]) != toupper ((unsigned char)b[i]))
+            return 0;
+    return a[i] == '\0';
+}
+
+static host_table *find_table (const char *name, size_t length)
+{
+    int i;
+
+    for (i = 0; i < tables_used; i++)
+        if (names_equal (tables[i].name, name, length))
+            return &tables[i];
+    return NULL;
+}
+
+static short column_index (const host_table *table, const char *name)
+{
+    short i;
+
+    for (i = 0; i < table->num_columns; i++)
+        if (names_equal (table->column_names[i], name, strlen (name)))
+            return i;
+    return -1;
+}
+
+static host_table *add_table (const char *name)
+{
+    host_table *table;
+
+    if (tables_used == HOST_MAX_TABLES)
+    {
+        fprintf (stderr, "More than %d tables\n", HOST_MAX_TABLES);
+        exit (1);
+    }
+    table = &tables[tables_used++];
+    table->name = host_strndup (name, strlen (name));
+    return table;
+}
+
+static void add_column (host_table *table, const char *name, short numeric,
+                        short key)
+{
+    short i = table->num_columns;
+
+    if (i == HOST_MAX_COLUMNS)
+    {
+        fprintf (stderr, "More than %d columns in %s\n", HOST_MAX_COLUMNS,
+                 table->name);
+        exit (1);
+    }
+    table->column_names[i] = host_strndup (name, strlen (name));
+    table->numeric[i] = numeric;
+    table->key_index[i] = -1;
+    if (key)
+    {
+        table->key_index[i] = table->num_key_columns;
+        table->key_columns[table->num_key_columns++] = i;
+    }
+    table->num_columns++;
+}
+
+/***************************************************************************
+  Name part of a [CATALOG.]SCHEMA.OBJECT name: 0 catalog, 1 schema,
+  2 object.  Missing parts are empty.
+***************************************************************************/
+static const char *name_part (const char *name, int part, size_t *length)
+{
+    const char *dots[2];
+    const char *p;
+    int num_dots = 0;
+
+    for (p = name; *p; p++)
+        if (*p == '.' && num_dots < 2)
+            dots[num_dots++] = p;
+
+    if (num_dots < 2)
+    {
+        /* SCHEMA.OBJECT or OBJECT: no catalog */
+        if (part == 0)
+        {
+            *length = 0;
+            return name;
+        }
+        if (part == 1)
+        {
+            *length = num_dots ? (size_t)(dots[0] - name) : 0;
+            return name;
+        }
+        p = num_dots ? dots[0] + 1 : name;
+        *length = strlen (p);
+        return p;
+    }
+
+    if (part == 0)
+    {
+        *length = dots[0] - name;
+        return name;
+    }
+    if (part == 1)
+    {
+        *length = dots[1] - dots[0] - 1;
+        return dots[0] + 1;
+    }
+    *length = strlen (dots[1] + 1);
+    return dots[1] + 1;
+}
+
+/***************************************************************************
+  Synthetic stream.
+***************************************************************************/
+static void create_synthetic_tables (void)
+{
+    host_table *table;
+    char name[64];
+    int i, j;
+
+    for (i = 0; i < num_tables; i++)
+    {
+        sprintf (name, "TESTSRC.TABLE%d", i + 1);
+        table = add_table (name);
+        add_column (table, "ID", 1, 1);
+        add_column (table, "ORGANIZATION_ID", 0, 0);
+        for (j = 2; j < num_columns; j++)
+        {
+            sprintf (name, "COL%d", j - 1);
+            add_column (table, name, 0, 0);
+        }
+    }
+}
+
+static host_step *synthetic_next (void)
+{
+    static host_step step_buffers[2];
+    static char *value_buffers[2];
+    static char *pattern = NULL;
+    static int which = 0;
+    static unsigned long long state = 88172645463325252ULL;
+    static long delivered = 0;
+    static long in_trans = 0;
+    static long transactions = 0;
+    static int checkpoint_due = 0;
+    host_step *step;
+    char *p;
+    long id;
+    int i;
+
+    which ^= 1;
+    step = &step_buffers[which];
+    memset (step, 0, sizeof(host_step));
+
+    if (checkpoint_due)
+    {
+        checkpoint_due = 0;
+        step->kind = STEP_CHECKPOINT;
+        return step;
+    }
+
+    if (in_trans && (in_trans == records_per_trans || delivered == num_records))
+    {
+        in_trans = 0;
+        transactions++;
+        checkpoint_due = checkpoint_interval > 0 &&
+                         transactions % checkpoint_interval == 0;
+        step->kind = STEP_COMMIT;
+        return step;
+    }
+
+    if (delivered == num_records)
+        return NULL;
+
+    if (!in_trans)
+    {
+        in_trans = -1;
+        step->kind = STEP_BEGIN;
+        return step;
+    }
+    if (in_trans < 0)
+        in_trans = 0;
+
+    id = delivered++;
+    in_trans++;
+    step->kind = STEP_RECORD;
+    step->table = &tables[id % num_tables];
+    step->before_after_ind = AFTER_IMAGE_VAL;
+
+    if (ddl_interval > 0 && id % ddl_interval >= ddl_interval - ddl_burst)
+    {
+        /* The DDL text lives in the value buffer of the step */
+        if (!value_buffers[which])
+            value_buffers[which] = (char *)host_alloc (256);
+        p = value_buffers[which];
+        sprintf (p, "ALTER TABLE %s ADD DDL%ld VARCHAR2(30)",
+                 step->table->name, id);
+        step->io_type = SQL_DDL_VAL;
+        step->ddl_type = "ALTER";
+        step->object_type = "TABLE";
+        step->object_name = step->table->name;
+        step->base_object_name = "";
+        step->text = p;
+        return step;
+    }
+
+    switch (next_random (&state) % 10)
+    {
+        case 7:
+        case 8:
+            step->io_type = UPDATE_VAL;
+            break;
+        case 9:
+            step->io_type = DELETE_VAL;
+            break;
+        default:
+            step->io_type = INSERT_VAL;
+    }
+
+    if (!value_buffers[which])
+        value_buffers[which] = (char *)host_alloc (256);
+    p = value_buffers[which];
+
+    step->values[0] = p;
+    step->lengths[0] = (unsigned short)sprintf (p, "%ld", id);
+    p += step->lengths[0] + 1;
+
+    step->values[1] = p;
+    step->lengths[1] = (unsigned short)sprintf (p, "%llu",
+        100000 + (next_random (&state) % (unsigned long long)num_org_ids) * 7);
+    p += step->lengths[1] + 1;
+
+    /* The other values are windows of one repeating pattern */
+    if (!pattern)
+    {
+        pattern = (char *)host_alloc ((size_t)value_width + 26);
+        for (i = 0; i < value_width + 26; i++)
+            pattern[i] = (char)('A' + i % 26);
+    }
+    for (i = 2; i < num_columns; i++)
+    {
+        step->values[i] = pattern + (id + i) % 26;
+        step->lengths[i] = (unsigned short)value_width;
+    }
+    return step;
+}
+
+/***************************************************************************
+  Recorded stream.
+***************************************************************************/
+static host_step *add_step (int kind)
+{
+    if (steps_used == steps_max)
+    {
+        steps_max = steps_max ? steps_max * 2 : 1024;
+        steps = (host_step *)realloc (steps, steps_max * sizeof(host_step));
+        if (!steps)
+        {
+            fprintf (stderr, "Out of memory\n");
+            exit (1);
+        }
+    }
+    memset (&steps[steps_used], 0, sizeof(host_step));
+    steps[steps_used].kind = kind;
+    return &steps[steps_used++];
+}
+
+/* Next white space separated word of a line, double quotes removed */
+static char *next_word (char **line)
+{
+    char *p = *line;
+    char *word;
+    char *out;
+
+    while (isspace ((unsigned char)*p))
+        p++;
+    if (!*p)
+    {
+        *line = p;
+        return NULL;
+    }
+
+    word = out = p;
+    while (*p && !isspace ((unsigned char)*p))
+    {
+        if (*p == '"')
+        {
+            for (p++; *p && *p != '"'; p++)
+                *out++ = *p;
+            if (*p)
+                p++;
+        }
+        else
+            *out++ = *p++;
+    }
+    if (*p)
+        p++;
+    *out = '\0';
+    *line = p;
+    return word;
+}
+
+/* Rest of a line, without leading white space */
+static char *rest_of_line (char *line)
+{
+    while (isspace ((unsigned char)*line))
+        line++;
+    return line;
+}
+
+static void parse_error (const char *file, int line_num, const char *message,
+                         const char *word)
+{
+    fprintf (stderr, "%s:%d: %s%s%s\n", file, line_num, message,
+             word ? " " : "", word ? word : "");
+    exit (1);
+}
+
+static void parse_record (const char *file, int line_num, host_step *step,
+                          char *line)
+{
+    char *word;
+    char *value;
+    short i;
+
+    word = next_word (&line);
+    if (!word)
+        parse_error (file, line_num, "Missing table name", NULL);
+    step->table = find_table (word, strlen (word));
+    if (!step->table)
+        parse_error (file, line_num, "Undeclared table", word);
+
+    for (i = 0; i < step->table->num_columns; i++)
+        step->nulls[i] = 1;
+
+    while ((word = next_word (&line)) != NULL)
+    {
+        value = strchr (word, '=');
+        if (value)
+            *value++ = '\0';
+        i = column_index (step->table, word);
+        if (i < 0)
+            parse_error (file, line_num, "Unknown column", word);
+        if (value)
+        {
+            step->values[i] = host_strndup (value, strlen (value));
+            step->lengths[i] = (unsigned short)strlen (value);
+            step->nulls[i] = 0;
+        }
+    }
+}
+
+static void read_stream (const char *file)
+{
+    FILE *fp;
+    char line[65536];
+    char *p;
+    char *word;
+    int line_num = 0;
+    host_step *step;
+    host_step pending_tokens;
+    host_table *table;
+
+    fp = fopen (file, "r");
+    if (!fp)
+    {
+        fprintf (stderr, "Cannot read %s\n", file);
+        exit (1);
+    }
+
+    memset (&pending_tokens, 0, sizeof(pending_tokens));
+    while (fgets (line, sizeof(line), fp))
+    {
+        line_num++;
+        p = line + strlen (line);
+        while (p > line && isspace ((unsigned char)p[-1]))
+            *--p = '\0';
+
+        p = line;
+        word = next_word (&p);
+        if (!word || *word == '#')
+            continue;
+
+        if (!strcmp (word, "TABLE"))
+        {
+            word = next_word (&p);
+            if (!word)
+                parse_error (file, line_num, "Missing table name", NULL);
+            table = add_table (word);
+            while ((word = next_word (&p)) != NULL)
+            {
+                char *flags = strchr (word, ':');
+
+                if (flags)
+                    *flags++ = '\0';
+                add_column (table, word,
+                            (short)(flags && strchr (flags, 'N') != NULL),
+                            (short)(flags && strchr (flags, 'K') != NULL));
+            }
+        }
+        else
+        if (!strcmp (word, "BEGIN"))
+            add_step (STEP_BEGIN);
+        else
+        if (!strcmp (word, "COMMIT"))
+            add_step (STEP_COMMIT);
+        else
+        if (!strcmp (word, "ROLLBACK"))
+            add_step (STEP_ROLLBACK);
+        else
+        if (!strcmp (word, "CHECKPOINT"))
+            add_step (STEP_CHECKPOINT);
+        else
+        if (!strcmp (word, "MARKER"))
+        {
+            step = add_step (STEP_MARKER);
+            p = rest_of_line (p);
+            step->text = host_strndup (p, strlen (p));
+        }
+        else
+        if (!strcmp (word, "EVENT"))
+        {
+            step = add_step (STEP_EVENT);
+            word = next_word (&p);
+            if (!word)
+                parse_error (file, line_num, "Missing table name", NULL);
+            step->object_name = host_strndup (word, strlen (word));
+        }
+        else
+        if (!strcmp (word, "DISCARD"))
+        {
+            step = add_step (STEP_DISCARD);
+            word = next_word (&p);
+            step->error_num = word ? atol (word) : 0;
+            p = rest_of_line (p);
+            step->text = host_strndup (p, strlen (p));
+        }
+        else
+        if (!strcmp (word, "TOKEN"))
+        {
+            char *value;
+
+            word = next_word (&p);
+            value = word ? strchr (word, '=') : NULL;
+            if (!value)
+                parse_error (file, line_num, "Expected TOKEN <name>=<value>", NULL);
+            if (pending_tokens.num_tokens == HOST_MAX_TOKENS)
+                parse_error (file, line_num, "Too many tokens", NULL);
+            *value++ = '\0';
+            pending_tokens.token_names[pending_tokens.num_tokens] =
+                host_strndup (word, strlen (word));
+            pending_tokens.token_values[pending_tokens.num_tokens++] =
+                host_strndup (value, strlen (value));
+        }
+        else
+        if (!strcmp (word, "DDL"))
+        {
+            step = add_step (STEP_RECORD);
+            step->io_type = SQL_DDL_VAL;
+            step->before_after_ind = AFTER_IMAGE_VAL;
+            if (!(word = next_word (&p)))
+                parse_error (file, line_num, "Missing DDL type", NULL);
+            step->ddl_type = host_strndup (word, strlen (word));
+            if (!(word = next_word (&p)))
+                parse_error (file, line_num, "Missing DDL object type", NULL);
+            step->object_type = host_strndup (word, strlen (word));
+            if (!(word = next_word (&p)))
+                parse_error (file, line_num, "Missing DDL object name", NULL);
+            step->object_name = host_strndup (word, strlen (word));
+            step->base_object_name = "";
+            p = rest_of_line (p);
+            if (!strncmp (p, "ON ", 3))
+            {
+                p += 3;
+                word = next_word (&p);
+                step->base_object_name = host_strndup (word, strlen (word));
+                p = rest_of_line (p);
+            }
+            step->text = host_strndup (p, strlen (p));
+
+            /* Table columns are answered from the base table, if known */
+            step->table = find_table (step->object_name, strlen (step->object_name));
+            if (!step->table)
+                step->table = find_table (step->base_object_name,
+                                          strlen (step->base_object_name));
+        }
+        else
+        {
+            short io_type;
+            char before_after_ind = AFTER_IMAGE_VAL;
+
+            if (!strcmp (word, "INSERT"))
+                io_type = INSERT_VAL;
+            else
+            if (!strcmp (word, "UPDATE"))
+                io_type = UPDATE_VAL;
+            else
+            if (!strcmp (word, "PKUPDATE"))
+                io_type = UPDATE_COMP_PK_SQL_VAL;
+            else
+            if (!strcmp (word, "BEFORE"))
+            {
+                io_type = UPDATE_VAL;
+                before_after_ind = BEFORE_IMAGE_VAL;
+            }
+            else
+            if (!strcmp (word, "DELETE"))
+            {
+                io_type = DELETE_VAL;
+                before_after_ind = BEFORE_IMAGE_VAL;
+            }
+            else
+            if (!strcmp (word, "TRUNCATE"))
+                io_type = TRUNCATE_TABLE_VAL;
+            else
+                parse_error (file, line_num, "Unknown step", word);
+
+            step = add_step (STEP_RECORD);
+            step->io_type = io_type;
+            step->before_after_ind = before_after_ind;
+            parse_record (file, line_num, step, p);
+            step->num_tokens = pending_tokens.num_tokens;
+            memcpy (step->token_names, pending_tokens.token_names,
+                    sizeof(step->token_names));
+            memcpy (step->token_values, pending_tokens.token_values,
+                    sizeof(step->token_values));
+            pending_tokens.num_tokens = 0;
+        }
+    }
+
+    fclose (fp);
+}
+
+static host_step *replay_next (void)
+{
+    static size_t next = 0;
+    static long loop = 0;
+
+    if (next == steps_used)
+    {
+        if (++loop >= loops)
+            return NULL;
+        next = 0;
+    }
+    return next < steps_used ? &steps[next++] : NULL;
+}
+
+static host_step *stream_next (void)
+{
+    return replay_file ? replay_next () : synthetic_next ();
+}
+
+/***************************************************************************
+  Callback helpers.
+***************************************************************************/
+
+/* Copy a value into a caller's buffer, null terminated if there is room */
+static short copy_value (char *buffer, long max_length, const char *value,
+                         size_t length, long *actual_length, short *truncated)
+{
+    short was_truncated = 0;
+
+    if (!buffer || max_length <= 0)
+        return EXIT_FN_RET_INVALID_PARAM;
+    if (length >= (size_t)max_length)
+    {
+        length = (size_t)max_length - 1;
+        was_truncated = 1;
+    }
+    memcpy (buffer, value, length);
+    buffer[length] = '\0';
+    if (actual_length)
+        *actual_length = (long)length;
+    if (truncated)
+        *truncated = was_truncated;
+    return EXIT_FN_RET_OK;
+}
+
+static int is_ddl (void)
+{
+    return current && current->kind == STEP_RECORD &&
+           current->io_type == SQL_DDL_VAL;
+}
+
+/* Tables are the same on both sides; target DDL exists in Replicat only */
+static short check_side (short source_or_target)
+{
+    if (!current)
+        return EXIT_FN_RET_INVALID_CONTEXT;
+    if (source_or_target == EXIT_FN_CURRENT_VAL)
+        return EXIT_FN_RET_NOT_SUPPORTED;
+    if (source_or_target == EXIT_FN_TARGET_VAL && is_ddl () && !mapped)
+        return EXIT_FN_RET_NOT_SUPPORTED;
+    return EXIT_FN_RET_OK;
+}
+
+static const char *current_object_name (int base)
+{
+    if (is_ddl ())
+        return base ? current->base_object_name : current->object_name;
+    if (current && current->kind == STEP_EVENT)
+        return base ? "" : current->object_name;
+    return current && current->table ? current->table->name : "";
+}
+
+static short name_callback (ercallback_function_codes function_code,
+                            env_value_def *env_value)
+{
+    const char *name;
+    const char *part;
+    size_t length;
+    short result_code;
+
+    if ((result_code = check_side (env_value->source_or_target)) != EXIT_FN_RET_OK)
+        return result_code;
+
+    switch (function_code)
+    {
+        case GET_TABLE_NAME:
+        case GET_TABLE_NAME_ONLY:
+        case GET_SCHEMA_NAME_ONLY:
+        case GET_CATALOG_NAME_ONLY:
+            if (!current->table)
+                return EXIT_FN_RET_TABLE_NOT_FOUND;
+            name = current->table->name;
+            break;
+        case GET_BASE_OBJECT_NAME:
+        case GET_BASE_OBJECT_NAME_ONLY:
+        case GET_BASE_SCHEMA_NAME_ONLY:
+            name = current_object_name (1);
+            break;
+        default:
+            name = current_object_name (0);
+    }
+
+    switch (function_code)
+    {
+        case GET_TABLE_NAME_ONLY:
+        case GET_OBJECT_NAME_ONLY:
+        case GET_BASE_OBJECT_NAME_ONLY:
+            part = name_part (name, 2, &length);
+            break;
+        case GET_SCHEMA_NAME_ONLY:
+        case GET_BASE_SCHEMA_NAME_ONLY:
+            part = name_part (name, 1, &length);
+            break;
+        case GET_CATALOG_NAME_ONLY:
+            part = name_part (name, 0, &length);
+            break;
+        default:
+            part = name;
+            length = strlen (name);
+    }
+
+    return copy_value (env_value->buffer, env_value->max_length, part, length,
+                       &env_value->actual_length, &env_value->value_truncated);
+}
+
+static host_table *metadata_table (short source_or_target, short *result_code)
+{
+    if ((*result_code = check_side (source_or_target)) != EXIT_FN_RET_OK)
+        return NULL;
+    if (!current->table)
+        *result_code = EXIT_FN_RET_TABLE_NOT_FOUND;
+    return current->table;
+}
+
+static short column_metadata (col_metadata_def *col_meta, short by_name)
+{
+    host_table *table;
+    short result_code;
+    short i;
+
+    table = metadata_table (col_meta->source_or_target, &result_code);
+    if (!table)
+        return result_code;
+
+    if (by_name)
+    {
+        if (!col_meta->column_name)
+            return EXIT_FN_RET_INVALID_PARAM;
+        i = column_index (table, col_meta->column_name);
+        if (i < 0)
+            return EXIT_FN_RET_COLUMN_NOT_FOUND;
+        col_meta->column_index = i;
+    }
+    else
+    {
+        i = col_meta->column_index;
+        if (i < 0 || i >= table->num_columns)
+            return EXIT_FN_RET_INVALID_COLUMN;
+        result_code = copy_value (col_meta->column_name,
+                                  col_meta->max_name_length,
+                                  table->column_names[i],
+                                  strlen (table->column_names[i]), NULL, NULL);
+        if (result_code != EXIT_FN_RET_OK)
+            return result_code;
+    }
+
+    col_meta->native_data_type = table->numeric[i] ? 2 : 1;
+    col_meta->gg_data_type = table->numeric[i] ? _SQLDT_64BIT_S : _SQLDT_ASCII_V;
+    col_meta->gg_sub_data_type = 0;
+    col_meta->is_nullable = table->key_index[i] < 0;
+    col_meta->is_part_of_key = table->key_index[i] >= 0;
+    col_meta->key_column_index = table->key_index[i];
+    col_meta->length = table->numeric[i] ? 8 : 4000;
+    col_meta->precision = table->numeric[i] ? 19 : 0;
+    col_meta->scale = 0;
+    col_meta->column_charset = table->numeric[i] ? ULIB_CS_DEFAULT : ULIB_CS_UTF8;
+    col_meta->is_hidden_column = 0;
+    return EXIT_FN_RET_OK;
+}
+
+/* Value of a column in the requested format */
+static short column_value (column_def *column, short i)
+{
+    const host_table *table = current->table;
+    unsigned char number[8];
+    const char *value;
+    unsigned short length;
+    int64_t n;
+    int b;
+
+    column->null_value = nulls[i];
+    column->value_truncated = 0;
+    column->more_lob_data = CHAR_NO_VAL;
+    column->is_hidden_column = 0;
+    column->column_charset = table->numeric[i] ? ULIB_CS_DEFAULT : ULIB_CS_UTF8;
+    if (nulls[i])
+    {
+        column->actual_value_length = 0;
+        if (column->column_value && column->max_value_length)
+            column->column_value[0] = '\0';
+        return EXIT_FN_RET_OK;
+    }
+
+    value = values[i];
+    length = lengths[i];
+    if (table->numeric[i] && column->column_value_mode == EXIT_FN_INTERNAL_FORMAT)
+    {
+        /* Big endian binary integer, as in the trail */
+        n = strtoll (value, NULL, 10);
+        for (b = 7; b >= 0; b--)
+        {
+            number[b] = (unsigned char)(n & 0xff);
+            n >>= 8;
+        }
+        value = (const char *)number;
+        length = sizeof(number);
+    }
+
+    if (!column->column_value)
+        return EXIT_FN_RET_INVALID_PARAM;
+    if (length > column->max_value_length)
+    {
+        length = column->max_value_length;
+        column->value_truncated = 1;
+    }
+    memcpy (column->column_value, value, length);
+    if (length < column->max_value_length)
+        column->column_value[length] = '\0';
+    column->actual_value_length = length;
+    return EXIT_FN_RET_OK;
+}
+
+static short set_column_value (column_def *column, short i)
+{
+    size_t length = column->actual_value_length;
+
+    if (column->null_value)
+    {
+        nulls[i] = 1;
+        lengths[i] = 0;
+        return EXIT_FN_RET_OK;
+    }
+    if (!column->column_value)
+        return EXIT_FN_RET_INVALID_PARAM;
+    if (set_used + length + 1 > sizeof(set_space))
+        return EXIT_FN_RET_EXCEEDED_MAX_LENGTH;
+
+    memcpy (set_space + set_used, column->column_value, length);
+    set_space[set_used + length] = '\0';
+    values[i] = set_space + set_used;
+    lengths[i] = (unsigned short)length;
+    nulls[i] = 0;
+    set_used += length + 1;
+    return EXIT_FN_RET_OK;
+}
+
+static short column_callback (ercallback_function_codes function_code,
+                              column_def *column)
+{
+    short result_code;
+    short i;
+
+    if ((result_code = check_side (column->source_or_target)) != EXIT_FN_RET_OK)
+        return result_code;
+    if (current->kind != STEP_RECORD || is_ddl () || !current->table)
+        return EXIT_FN_RET_INVALID_RECORD_TYPE;
+
+    if (function_code == GET_COLUMN_VALUE_FROM_NAME ||
+        function_code == SET_COLUMN_VALUE_BY_NAME)
+    {
+        if (!column->column_name)
+            return EXIT_FN_RET_INVALID_PARAM;
+        i = column_index (current->table, column->column_name);
+        if (i < 0)
+            return EXIT_FN_RET_COLUMN_NOT_FOUND;
+        column->column_index = i;
+    }
+    else
+    {
+        i = column->column_index;
+        if (i < 0 || i >= current->table->num_columns)
+            return EXIT_FN_RET_INVALID_COLUMN;
+    }
+
+    if (function_code == SET_COLUMN_VALUE_BY_NAME ||
+        function_code == SET_COLUMN_VALUE_BY_INDEX)
+        return set_column_value (column, i);
+    return column_value (column, i);
+}
+
+/* Serialize the record: per column its index, null flag and length, each
+   2 bytes big endian, then the value.  The ASCII format separates the
+   values with commas. */
+static long record_image (char *buffer, long max_length, short ascii)
+{
+    const host_table *table = current->table;
+    long length = 0;
+    short i;
+
+    if (!table || is_ddl ())
+        return 0;
+
+    for (i = 0; i < table->num_columns; i++)
+    {
+        if (ascii)
+        {
+            if (length + lengths[i] + 1 > max_length)
+                break;
+            if (i)
+                buffer[length++] = ',';
+            memcpy (buffer + length, values[i], nulls[i] ? 0 : lengths[i]);
+            length += nulls[i] ? 0 : lengths[i];
+            continue;
+        }
+
+        if (length + 6 + lengths[i] > max_length)
+            break;
+        buffer[length++] = (char)(i >> 8);
+        buffer[length++] = (char)i;
+        buffer[length++] = 0;
+        buffer[length++] = (char)(nulls[i] ? 1 : 0);
+        buffer[length++] = (char)(nulls[i] ? 0 : lengths[i] >> 8);
+        buffer[length++] = (char)(nulls[i] ? 0 : lengths[i]);
+        if (!nulls[i])
+        {
+            memcpy (buffer + length, values[i], lengths[i]);
+            length += lengths[i];
+        }
+    }
+    return length;
+}
+
+static long record_length (void)
+{
+    long length = 0;
+    short i;
+
+    if (!current || !current->table || is_ddl ())
+        return current && current->text ? (long)strlen (current->text) : 0;
+    for (i = 0; i < current->table->num_columns; i++)
+        length += 6 + (nulls[i] ? 0 : lengths[i]);
+    return length;
+}
+
+/* Operation time, as GoldenGate's Julian microseconds and as text */
+static void record_time (record_def *record, int gmt)
+{
+    struct timespec ts;
+    struct tm tm;
+    size_t length;
+
+    clock_gettime (CLOCK_REALTIME, &ts);
+    record->timestamp = (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000 +
+                        INT64_C(210866803200000000);
+    if (gmt)
+        gmtime_r (&ts.tv_sec, &tm);
+    else
+        localtime_r (&ts.tv_sec, &tm);
+    length = strftime (record->io_datetime, sizeof(record->io_datetime),
+                       "%Y-%m-%d %H:%M:%S", &tm);
+    snprintf (record->io_datetime + length,
+              sizeof(record->io_datetime) - length, ".%06ld",
+              (long)(ts.tv_nsec / 1000));
+}
+
+static short record_callback (ercallback_function_codes function_code,
+                              record_def *record)
+{
+    short result_code;
+
+    if ((result_code = check_side (record->source_or_target)) != EXIT_FN_RET_OK)
+        return result_code;
+
+    record->io_type = current_io_type;
+    record->record_type = EXIT_REC_TYPE_SQL;
+    record->transaction_ind = current_transaction_ind;
+    record->before_after_ind = current->before_after_ind;
+    record->mapped = mapped;
+
+    switch (function_code)
+    {
+        case GET_RECORD_BUFFER:
+            if (!record->buffer)
+                return EXIT_FN_RET_INVALID_PARAM;
+            record->length = record_image (record->buffer, MAX_REC_LEN,
+                                           ascii_record);
+            record_time (record, 0);
+            break;
+        case GET_RECORD_LENGTH:
+            record->length = record_length ();
+            break;
+        case GET_TIMESTAMP:
+            record_time (record, 0);
+            break;
+        case GET_GMT_TIMESTAMP:
+            record_time (record, 1);
+            break;
+        case SET_OPERATION_TYPE:
+            current_io_type = record->io_type;
+            break;
+        default:
+            break;
+    }
+    return EXIT_FN_RET_OK;
+}
+
+static short statistics_callback (statistics_def *statistics)
+{
+    const host_counts *counts;
+    host_table *table;
+    int userexit;
+
+    if (!statistics->table_name)
+        return EXIT_FN_RET_INVALID_PARAM;
+    table = find_table (statistics->table_name, strlen (statistics->table_name));
+    if (!table)
+        return EXIT_FN_RET_TABLE_NOT_FOUND;
+
+    userexit = statistics->group == EXIT_STAT_GROUP_USEREXIT;
+    counts = &table->counts[userexit];
+    strcpy (statistics->start_datetime, userexit ? reset_datetime : start_datetime);
+    statistics->num_inserts = counts->inserts;
+    statistics->num_updates = counts->updates;
+    statistics->num_befores = counts->befores;
+    statistics->num_deletes = counts->deletes;
+    statistics->num_discards = counts->discards;
+    statistics->num_ignores = counts->ignores;
+    statistics->total_db_operations = counts->db_operations;
+    statistics->total_operations = counts->operations;
+    statistics->num_truncates = counts->truncates;
+    return EXIT_FN_RET_OK;
+}
+
+static short env_callback (getenv_value_def *env)
+{
+    char value[256];
+    const char *name = env->env_value_name;
+    const char *result = NULL;
+
+    if (!env->information_type || !name)
+        return EXIT_FN_RET_INVALID_PARAM;
+
+    if (!strcmp (env->information_type, "GGENVIRONMENT"))
+    {
+        if (!strcmp (name, "GROUPNAME"))
+            result = mapped ? "REPHOST" : "EXTHOST";
+        else
+        if (!strcmp (name, "GROUPTYPE"))
+            result = mapped ? "REPLICAT" : "EXTRACT";
+        else
+        if (!strcmp (name, "GROUPDESCRIPTION"))
+            result = "exithost";
+        else
+        if (!strcmp (name, "PROCESSID"))
+        {
+            sprintf (value, "%ld", (long)getpid ());
+            result = value;
+        }
+        else
+        if (!strcmp (name, "HOSTNAME"))
+        {
+            if (gethostname (value, sizeof(value)) == 0)
+            {
+                value[sizeof(value) - 1] = '\0';
+                result = value;
+            }
+        }
+        else
+        if (!strcmp (name, "OSUSERNAME"))
+            result = getenv ("USER");
+    }
+    else
+    if (!strcmp (env->information_type, "OSVARIABLE"))
+        result = getenv (name);
+
+    if (!result)
+        return EXIT_FN_RET_ENV_NOT_FOUND;
+    return copy_value (env->return_value, env->max_return_length, result,
+                       strlen (result), &env->actual_length,
+                       &env->value_truncated);
+}
+
+static short ddl_callback (ddl_record_def *ddl)
+{
+    short result_code;
+    short truncated = 0;
+
+    if ((result_code = check_side (ddl->source_or_target)) != EXIT_FN_RET_OK)
+        return result_code;
+    if (!is_ddl ())
+        return EXIT_FN_RET_INVALID_RECORD_TYPE;
+
+    if ((result_code = copy_value (ddl->ddl_type, ddl->ddl_type_max_length,
+                                   current->ddl_type, strlen (current->ddl_type),
+                                   &ddl->ddl_type_length, NULL)) != EXIT_FN_RET_OK ||
+        (result_code = copy_value (ddl->object_type, ddl->object_type_max_length,
+                                   current->object_type, strlen (current->object_type),
+                                   &ddl->object_type_length, NULL)) != EXIT_FN_RET_OK ||
+        (result_code = copy_value (ddl->object_name, ddl->object_max_length,
+                                   current->object_name, strlen (current->object_name),
+                                   &ddl->object_length, NULL)) != EXIT_FN_RET_OK)
+        return result_code;
+
+    if (ddl->owner_name)
+    {
+        size_t length;
+        const char *owner = name_part (current->object_name, 1, &length);
+
+        if ((result_code = copy_value (ddl->owner_name, ddl->owner_max_length,
+                                       owner, length, &ddl->owner_length,
+                                       NULL)) != EXIT_FN_RET_OK)
+            return result_code;
+    }
+
+    result_code = copy_value (ddl->ddl_text, ddl->ddl_text_max_length,
+                              current->text, strlen (current->text),
+                              &ddl->ddl_text_length, &truncated);
+    if (result_code == EXIT_FN_RET_OK)
+        ddl->ddl_text_truncated = truncated;
+    return result_code;
+}
+
+static short database_callback (database_defs *databases)
+{
+    database_def *db[2];
+    int i, j;
+
+    db[0] = &databases->source_db_def;
+    db[1] = &databases->target_db_def;
+    for (i = 0; i < 2; i++)
+    {
+        if (db[i]->dbName)
+            copy_value (db[i]->dbName, db[i]->dbName_max_length,
+                        i ? "TARGETDB" : "SOURCEDB", 8,
+                        &db[i]->dbName_actual_length, NULL);
+        if (db[i]->locale)
+            copy_value (db[i]->locale, db[i]->locale_max_length,
+                        "AMERICAN_AMERICA.AL32UTF8", 25,
+                        &db[i]->locale_actual_length, NULL);
+        /* Oracle: unquoted names stored in upper case, quoted names case
+           sensitive */
+        for (j = 0; j < MAXDBOBJTYPE; j++)
+            db[i]->dbNameMetadata[j] = UC_CI_BIT | MIXED_QUOTED_CS_BIT;
+    }
+    return EXIT_FN_RET_OK;
+}
+
+static void write_report (const char *text)
+{
+    char narrow[4096];
+    const unsigned char *u = (const unsigned char *)text;
+    size_t length = 0;
+
+    if (ULIB_IS_UTF16 (session_charset))
+    {
+        /* Messages come in the session character set: keep the low bytes
+           of UTF-16 text */
+        int big = session_charset == ULIB_CS_UTF16BE ||
+                  (session_charset == ULIB_CS_UTF16 && EXIT_RT_BIG_ENDIAN);
+
+        while ((u[0] || u[1]) && length < sizeof(narrow) - 1)
+        {
+            narrow[length++] = (char)(big ? u[1] : u[0]);
+            u += 2;
+        }
+        narrow[length] = '\0';
+        text = narrow;
+    }
+    else
+        length = strlen (text);
+
+    report_messages++;
+    report_bytes += length;
+    if (report)
+        fputs (text, report);
+}
+
+/***************************************************************************
+  The ER callback the exit resolves from the host.
+***************************************************************************/
+void ERCALLBACK (ercallback_function_codes function_code, void *buf,
+                 short *presult_code)
+{
+    short result_code = EXIT_FN_RET_OK;
+    short i;
+
+    if ((int)function_code >= 0 && function_code < HOST_NUM_FUNCTIONS)
+        callbacks[function_code]++;
+
+    if (!buf && function_code != RESET_USEREXIT_STATS)
+    {
+        *presult_code = EXIT_FN_RET_INVALID_PARAM;
+        return;
+    }
+
+    switch (function_code)
+    {
+        case OUTPUT_MESSAGE_TO_REPORT:
+            write_report ((const char *)buf);
+            break;
+
+        case GET_OPERATION_TYPE:
+        case GET_RECORD_TYPE:
+        case GET_TRANSACTION_IND:
+        case GET_BEFORE_AFTER_IND:
+        case GET_RECORD_BUFFER:
+        case GET_RECORD_LENGTH:
+        case GET_TIMESTAMP:
+        case GET_GMT_TIMESTAMP:
+        case SET_OPERATION_TYPE:
+        case SET_RECORD_BUFFER:
+        case SET_TABLE_NAME:
+            if (!current || current->kind != STEP_RECORD)
+                result_code = EXIT_FN_RET_INVALID_CONTEXT;
+            else
+                result_code = record_callback (function_code, (record_def *)buf);
+            break;
+
+        case GET_TABLE_NAME:
+        case GET_TABLE_NAME_ONLY:
+        case GET_SCHEMA_NAME_ONLY:
+        case GET_CATALOG_NAME_ONLY:
+        case GET_OBJECT_NAME:
+        case GET_OBJECT_NAME_ONLY:
+        case GET_BASE_OBJECT_NAME:
+        case GET_BASE_OBJECT_NAME_ONLY:
+        case GET_BASE_SCHEMA_NAME_ONLY:
+            result_code = name_callback (function_code, (env_value_def *)buf);
+            break;
+
+        case GET_TABLE_COLUMN_COUNT:
+        {
+            table_def *table = (table_def *)buf;
+            host_table *t = metadata_table (table->source_or_target, &result_code);
+
+            if (t)
+            {
+                table->num_columns = t->num_columns;
+                table->num_key_columns = t->num_key_columns;
+                table->num_user_columns = t->num_columns;
+            }
+            break;
+        }
+
+        case GET_TABLE_METADATA:
+        {
+            table_metadata_def *table_meta = (table_metadata_def *)buf;
+            host_table *t = metadata_table (table_meta->source_or_target,
+                                            &result_code);
+
+            if (!t)
+                break;
+            result_code = copy_value (table_meta->table_name,
+                                      table_meta->max_name_length, t->name,
+                                      strlen (t->name), NULL, NULL);
+            table_meta->num_columns = t->num_columns;
+            table_meta->num_key_columns = t->num_key_columns;
+            table_meta->num_user_columns = t->num_columns;
+            table_meta->using_pseudo_key = t->num_key_columns == 0;
+            if (table_meta->key_columns)
+                memcpy (table_meta->key_columns, t->key_columns,
+                        t->num_key_columns * sizeof(short));
+            break;
+        }
+
+        case GET_COL_METADATA_FROM_INDEX:
+        case GET_COL_METADATA_FROM_NAME:
+            result_code = column_metadata ((col_metadata_def *)buf,
+                                           (short)(function_code == GET_COL_METADATA_FROM_NAME));
+            break;
+
+        case GET_COLUMN_INDEX_FROM_NAME:
+        case GET_COLUMN_NAME_FROM_INDEX:
+        {
+            env_value_def *env_value = (env_value_def *)buf;
+            host_table *t = metadata_table (env_value->source_or_target,
+                                            &result_code);
+
+            if (!t)
+                break;
+            if (function_code == GET_COLUMN_INDEX_FROM_NAME)
+            {
+                i = column_index (t, env_value->buffer);
+                if (i < 0)
+                    result_code = EXIT_FN_RET_COLUMN_NOT_FOUND;
+                else
+                    env_value->index = i;
+            }
+            else
+            if (env_value->index < 0 || env_value->index >= t->num_columns)
+                result_code = EXIT_FN_RET_INVALID_COLUMN;
+            else
+                result_code = copy_value (env_value->buffer, env_value->max_length,
+                                          t->column_names[env_value->index],
+                                          strlen (t->column_names[env_value->index]),
+                                          &env_value->actual_length,
+                                          &env_value->value_truncated);
+            break;
+        }
+
+        case GET_COLUMN_VALUE_FROM_INDEX:
+        case GET_COLUMN_VALUE_FROM_NAME:
+        case SET_COLUMN_VALUE_BY_INDEX:
+        case SET_COLUMN_VALUE_BY_NAME:
+            result_code = column_callback (function_code, (column_def *)buf);
+            break;
+
+        case GET_POSITION:
+        {
+            position_def *position = (position_def *)buf;
+            uint32_t seqno = position->position_type == STARTUP_CHECKPOINT ?
+                             0 : position_seqno;
+            int32_t rba = position->position_type == STARTUP_CHECKPOINT ?
+                          0 : position_rba;
+
+            if (position->position_type == RECOVERY_CHECKPOINT ||
+                position->ascii_or_internal != EXIT_FN_INTERNAL_FORMAT)
+            {
+                result_code = EXIT_FN_RET_NOT_SUPPORTED;
+                break;
+            }
+            if (!position->position)
+            {
+                result_code = EXIT_FN_RET_INVALID_PARAM;
+                break;
+            }
+            /* Sequence number and RBA, big endian */
+            seqno = EXIT_RT_BIG_ENDIAN ? seqno : exit_rt_bswap32 (seqno);
+            rba = EXIT_RT_BIG_ENDIAN ? rba : (int32_t)exit_rt_bswap32 ((uint32_t)rba);
+            memcpy (position->position, &seqno, sizeof(seqno));
+            memcpy (position->position + sizeof(seqno), &rba, sizeof(rba));
+            position->position_len = sizeof(seqno) + sizeof(rba);
+            break;
+        }
+
+        case GET_USER_TOKEN_VALUE:
+        {
+            token_value_def *token = (token_value_def *)buf;
+
+            result_code = EXIT_FN_RET_TOKEN_NOT_FOUND;
+            if (!current || !token->token_name)
+                break;
+            for (i = 0; i < current->num_tokens; i++)
+                if (!strcmp (current->token_names[i], token->token_name))
+                {
+                    result_code = copy_value (token->token_value, token->max_length,
+                                              current->token_values[i],
+                                              strlen (current->token_values[i]),
+                                              &token->actual_length,
+                                              &token->value_truncated);
+                    break;
+                }
+            break;
+        }
+
+        case GET_ENV_VALUE:
+            result_code = env_callback ((getenv_value_def *)buf);
+            break;
+
+        case GET_DDL_RECORD_PROPERTIES:
+            result_code = ddl_callback ((ddl_record_def *)buf);
+            break;
+
+        case GET_STATISTICS:
+            result_code = statistics_callback ((statistics_def *)buf);
+            break;
+
+        case RESET_USEREXIT_STATS:
+            for (i = 0; i < tables_used; i++)
+                memset (&tables[i].counts[1], 0, sizeof(host_counts));
+            {
+                time_t t = time (NULL);
+                strftime (reset_datetime, sizeof(reset_datetime),
+                          "%Y-%m-%d %H:%M:%S", localtime (&t));
+            }
+            break;
+
+        case GET_SESSION_CHARSET:
+            ((session_def *)buf)->session_charset = session_charset;
+            break;
+
+        case SET_SESSION_CHARSET:
+            if (((session_def *)buf)->session_charset < ULIB_CS_UNICODE_BEGIN &&
+                ((session_def *)buf)->session_charset != ULIB_CS_DEFAULT)
+                result_code = EXIT_FN_RET_INVALID_PARAM;
+            else
+                session_charset = ((session_def *)buf)->session_charset;
+            break;
+
+        case GET_DATABASE_METADATA:
+            result_code = database_callback ((database_defs *)buf);
+            break;
+
+        case GET_MARKER_INFO:
+        {
+            marker_info_def *marker = (marker_info_def *)buf;
+
+            if (!current || current->kind != STEP_MARKER)
+            {
+                result_code = EXIT_FN_RET_INVALID_CONTEXT;
+                break;
+            }
+            marker->processed = start_datetime;
+            marker->added = start_datetime;
+            marker->text = (char *)current->text;
+            marker->group = mapped ? "REPHOST" : "EXTHOST";
+            marker->program = mapped ? "replicat" : "extract";
+            marker->node = "exithost";
+            break;
+        }
+
+        case GET_ERROR_INFO:
+        {
+            error_info_def *error_info = (error_info_def *)buf;
+            const char *message = discard ? discard->text : "";
+
+            error_info->error_num = discard ? discard->error_num : 0;
+            result_code = copy_value (error_info->error_msg,
+                                      error_info->max_length, message,
+                                      strlen (message),
+                                      &error_info->actual_length,
+                                      &error_info->msg_truncated);
+            break;
+        }
+
+        case GET_EVENT_RECORD:
+        {
+            event_record_def *event = (event_record_def *)buf;
+
+            if (!current || current->kind != STEP_EVENT)
+            {
+                result_code = EXIT_FN_RET_INVALID_CONTEXT;
+                break;
+            }
+            event->event_id = EXIT_TABLE_METADATA_EVENT;
+            result_code = copy_value (event->object_name, event->max_name_length,
+                                      current->object_name,
+                                      strlen (current->object_name),
+                                      &event->actual_length, NULL);
+            break;
+        }
+
+        case COMPRESS_RECORD:
+        case DECOMPRESS_RECORD:
+        case FETCH_CURRENT_RECORD:
+        case FETCH_CURRENT_RECORD_WITH_LOCK:
+            result_code = EXIT_FN_RET_NOT_SUPPORTED;
+            break;
+
+        default:
+            result_code = EXIT_FN_RET_INVALID_CALLBACK_FNC_CD;
+    }
+
+    *presult_code = result_code;
+}
+
+/***************************************************************************
+  Driving the exit.
+***************************************************************************/
+static exit_function exit_entry;
+static exit_params_def exit_params;
+static int stopped = 0;
+static int abended = 0;
+
+/* Make a step current: the exit sees a private copy of its values */
+static void make_current (const host_step *step)
+{
+    current = step;
+    set_used = 0;
+    if (step && step->kind == STEP_RECORD)
+    {
+        current_io_type = step->io_type;
+        memcpy (values, step->values, sizeof(values));
+        memcpy (lengths, step->lengths, sizeof(lengths));
+        memcpy (nulls, step->nulls, sizeof(nulls));
+    }
+}
+
+/* Keep the latency of a benchmarked call */
+static void add_latency (double ns)
+{
+    if (latencies_used == latencies_max)
+    {
+        latencies_max = latencies_max ? latencies_max * 2 : 65536;
+        latencies = (unsigned long *)realloc (latencies,
+                                              latencies_max * sizeof(unsigned long));
+        if (!latencies)
+        {
+            fprintf (stderr, "Out of memory\n");
+            exit (1);
+        }
+    }
+    latencies[latencies_used++] = (unsigned long)ns;
+}
+
+static exit_result_def call_exit (exit_call_type_def exit_call_type)
+{
+    exit_result_def result = EXIT_OK_VAL;
+    double call_start;
+
+    exit_calls[exit_call_type]++;
+    if (workload && exit_call_type != EXIT_CALL_START &&
+        exit_call_type != EXIT_CALL_STOP)
+    {
+        counting = 1;
+        call_start = now_ns ();
+        exit_entry (exit_call_type, &result, &exit_params);
+        counting = 0;
+        if (exit_call_type == EXIT_CALL_PROCESS_RECORD)
+            add_latency (now_ns () - call_start);
+    }
+    else
+        exit_entry (exit_call_type, &result, &exit_params);
+    if (result >= 0 && result <= EXIT_PROCESSED_REC_VAL)
+        exit_results[result]++;
+
+    if (result == EXIT_STOP_VAL && !stopped)
+    {
+        fprintf (stderr, "Exit returned EXIT_STOP_VAL on %s\n",
+                 exit_call_name (exit_call_type));
+        stopped = 1;
+    }
+    else
+    if (result == EXIT_ABEND_VAL && !abended)
+    {
+        fprintf (stderr, "Exit returned EXIT_ABEND_VAL on %s\n",
+                 exit_call_name (exit_call_type));
+        abended = 1;
+    }
+    return result;
+}
+
+static void count_record (const host_step *step, exit_result_def result)
+{
+    host_counts *counts;
+    int i;
+
+    if (!step->table)
+        return;
+    for (i = 0; i < 2; i++)
+    {
+        counts = &step->table->counts[i];
+        counts->operations++;
+        if (result == EXIT_IGNORE_VAL)
+        {
+            counts->ignores++;
+            continue;
+        }
+        if (step->io_type == SQL_DDL_VAL)
+            continue;
+        counts->db_operations++;
+        if (step->before_after_ind == BEFORE_IMAGE_VAL &&
+            step->io_type != DELETE_VAL)
+            counts->befores++;
+        else
+        if (step->io_type == INSERT_VAL)
+            counts->inserts++;
+        else
+        if (step->io_type == DELETE_VAL)
+            counts->deletes++;
+        else
+        if (step->io_type == TRUNCATE_TABLE_VAL)
+            counts->truncates++;
+        else
+            counts->updates++;
+    }
+}
+
+static void process_record (const host_step *step, short transaction_ind)
+{
+    exit_result_def result;
+    long length;
+
+    make_current (step);
+    current_transaction_ind = transaction_ind;
+    length = record_length ();
+    if ((int64_t)position_rba + length + 64 > INT32_MAX)
+    {
+        position_seqno++;
+        position_rba = 0;
+    }
+    position_rba += (int32_t)(length + 64);
+
+    do
+    {
+        make_current (step);
+        exit_params.more_recs_ind = CHAR_NO_VAL;
+        result = call_exit (EXIT_CALL_PROCESS_RECORD);
+    } while (exit_params.more_recs_ind == CHAR_YES_VAL && !stopped && !abended);
+
+    count_record (step, result);
+    last_record = step;
+}
+
+static void sleep_until (double deadline_ns)
+{
+    double wait = deadline_ns - now_ns ();
+    struct timespec ts;
+
+    if (wait <= 0)
+        return;
+    ts.tv_sec = (time_t)(wait / 1e9);
+    ts.tv_nsec = (long)(wait - ts.tv_sec * 1e9);
+    nanosleep (&ts, NULL);
+}
+
+static unsigned long run_stream (double start)
+{
+    const host_step *step;
+    const host_step *next;
+    unsigned long records = 0;
+    int in_trans = 0;
+    int first_in_trans = 0;
+    int implicit;
+    short transaction_ind;
+
+    step = stream_next ();
+    while (step && !stopped && !abended)
+    {
+        next = stream_next ();
+
+        switch (step->kind)
+        {
+            case STEP_BEGIN:
+                make_current (NULL);
+                call_exit (EXIT_CALL_BEGIN_TRANS);
+                in_trans = 1;
+                first_in_trans = 1;
+                break;
+
+            case STEP_COMMIT:
+            case STEP_ROLLBACK:
+                make_current (NULL);
+                if (in_trans)
+                    call_exit (step->kind == STEP_COMMIT ? EXIT_CALL_END_TRANS :
+                                                          EXIT_CALL_ABORT_TRANS);
+                in_trans = 0;
+                break;
+
+            case STEP_CHECKPOINT:
+                make_current (NULL);
+                call_exit (EXIT_CALL_CHECKPOINT);
+                break;
+
+            case STEP_MARKER:
+                make_current (step);
+                call_exit (EXIT_CALL_PROCESS_MARKER);
+                break;
+
+            case STEP_EVENT:
+                make_current (step);
+                call_exit (EXIT_CALL_EVENT_RECORD);
+                break;
+
+            case STEP_DISCARD:
+                if (!last_record)
+                    break;
+                discard = step;
+                make_current (last_record);
+                call_exit (EXIT_CALL_DISCARD_RECORD);
+                if (!stopped && !abended)
+                {
+                    ascii_record = 1;
+                    call_exit (EXIT_CALL_DISCARD_ASCII_RECORD);
+                    ascii_record = 0;
+                }
+                discard = NULL;
+                break;
+
+            case STEP_RECORD:
+                implicit = !in_trans;
+                if (implicit)
+                {
+                    make_current (NULL);
+                    call_exit (EXIT_CALL_BEGIN_TRANS);
+                    first_in_trans = 1;
+                }
+
+                if (implicit || (next && next->kind != STEP_RECORD))
+                    transaction_ind = first_in_trans ? WHOLE_TRANS_VAL : END_TRANS_VAL;
+                else
+                    transaction_ind = first_in_trans ? BEGIN_TRANS_VAL : MIDDLE_TRANS_VAL;
+                first_in_trans = 0;
+
+                process_record (step, transaction_ind);
+                records++;
+
+                if (implicit && !stopped && !abended)
+                {
+                    make_current (NULL);
+                    call_exit (EXIT_CALL_END_TRANS);
+                }
+
+                if (rate > 0)
+                    sleep_until (start + records * 1e9 / rate);
+                break;
+        }
+
+        step = next;
+    }
+
+    make_current (NULL);
+    return records;
+}
+
+static int compare_latencies (const void *a, const void *b)
+{
+    unsigned long x = *(const unsigned long *)a;
+    unsigned long y = *(const unsigned long *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+/* Nearest rank percentile of the sorted latencies */
+static unsigned long percentile (double p)
+{
+    size_t rank;
+
+    if (!latencies_used)
+        return 0;
+    rank = (size_t)(p * latencies_used + 0.999999);
+    if (rank < 1)
+        rank = 1;
+    if (rank > latencies_used)
+        rank = latencies_used;
+    return latencies[rank - 1];
+}
+
+static void print_bench (const char *library, unsigned long records,
+                         double elapsed_ns, unsigned long total_callbacks)
+{
+    const char *name = strrchr (library, '/');
+
+    qsort (latencies, latencies_used, sizeof(unsigned long), compare_latencies);
+    printf ("BENCH exit=%s workload=%s records=%lu records_per_sec=%.0f "
+            "p50_ns=%lu p99_ns=%lu p999_ns=%lu callbacks_per_record=%.2f ",
+            name ? name + 1 : library, workload, records,
+            elapsed_ns > 0 ? records * 1e9 / elapsed_ns : 0.0,
+            percentile (0.50), percentile (0.99), percentile (0.999),
+            records ? (double)total_callbacks / records : 0.0);
+    if (HOST_COUNTS_ALLOCS)
+        printf ("allocs_per_record=%.2f alloc_bytes_per_record=%.1f\n",
+                records ? (double)alloc_calls / records : 0.0,
+                records ? (double)alloc_bytes / records : 0.0);
+    else
+        printf ("allocs_per_record=-1 alloc_bytes_per_record=-1\n");
+}
+
+static void print_summary (const char *library, unsigned long records,
+                           double elapsed_ns)
+{
+    unsigned long total_callbacks = 0;
+    int i;
+
+    if (report)
+        fflush (report);
+
+    printf ("\nExit calls:\n");
+    for (i = 0; i <= EXIT_CALL_FATAL_ERROR; i++)
+        if (exit_calls[i])
+            printf ("  %-28s %12lu\n", exit_call_name (i), exit_calls[i]);
+
+    printf ("Results:\n");
+    printf ("  %-28s %12lu\n", "EXIT_OK_VAL", exit_results[EXIT_OK_VAL]);
+    printf ("  %-28s %12lu\n", "EXIT_IGNORE_VAL", exit_results[EXIT_IGNORE_VAL]);
+    printf ("  %-28s %12lu\n", "EXIT_PROCESSED_REC_VAL", exit_results[EXIT_PROCESSED_REC_VAL]);
+    printf ("  %-28s %12lu\n", "EXIT_STOP_VAL", exit_results[EXIT_STOP_VAL]);
+    printf ("  %-28s %12lu\n", "EXIT_ABEND_VAL", exit_results[EXIT_ABEND_VAL]);
+
+    printf ("Callbacks:\n");
+    for (i = 0; i < HOST_NUM_FUNCTIONS; i++)
+        if (callbacks[i])
+        {
+            printf ("  %-28s %12lu\n", function_names[i], callbacks[i]);
+            total_callbacks += callbacks[i];
+        }
+
+    printf ("Report: %lu messages, %lu bytes\n", report_messages, report_bytes);
+    printf ("Records: %lu in %.3f s, %.0f records/s, %.2f callbacks/record\n",
+            records, elapsed_ns / 1e9,
+            elapsed_ns > 0 ? records * 1e9 / elapsed_ns : 0.0,
+            records ? (double)total_callbacks / records : 0.0);
+
+    if (workload)
+        print_bench (library, records, elapsed_ns, total_callbacks);
+}
+
+static void usage (const char *program)
+{
+    fprintf (stderr,
+             "Usage: %s [-n records] [-t tables] [-c columns] [-w bytes] "
+             "[-o orgids]\n"
+             "       [-x records] [-d records [-D records]] [-k transactions] "
+             "[-r file [-l loops]]\n"
+             "       [-R rate] [-p param] [-m] [-q] [-b workload] "
+             "<exit.so> [<function>]\n",
+             program);
+    exit (2);
+}
+
+int main (int argc, char **argv)
+{
+    const char *library;
+    const char *function = "CUSEREXIT";
+    void *handle;
+    int (*version) (void);
+    unsigned long records;
+    double start;
+    double elapsed;
+    time_t t;
+    int c;
+
+    report = stdout;
+    while ((c = getopt (argc, argv, "n:t:c:w:o:x:d:D:k:r:l:R:p:mqb:")) != -1)
+    {
+        switch (c)
+        {
+            case 'n': num_records = atol (optarg); break;
+            case 't': num_tables = atoi (optarg); break;
+            case 'c': num_columns = atoi (optarg); break;
+            case 'w': value_width = atoi (optarg); break;
+            case 'o': num_org_ids = atol (optarg); break;
+            case 'x': records_per_trans = atol (optarg); break;
+            case 'd': ddl_interval = atol (optarg); break;
+            case 'D': ddl_burst = atol (optarg); break;
+            case 'k': checkpoint_interval = atol (optarg); break;
+            case 'r': replay_file = optarg; break;
+            case 'l': loops = atol (optarg); break;
+            case 'R': rate = atof (optarg); break;
+            case 'p':
+                strncpy (exit_params.function_param, optarg,
+                         sizeof(exit_params.function_param) - 1);
+                break;
+            case 'm': mapped = 1; break;
+            case 'q': report = NULL; break;
+            case 'b': workload = optarg; break;
+            default: usage (argv[0]);
+        }
+    }
+    if (optind >= argc || argc - optind > 2)
+        usage (argv[0]);
+    library = argv[optind];
+    if (argc - optind == 2)
+        function = argv[optind + 1];
+
+    if (num_tables < 1 || num_tables > HOST_MAX_TABLES ||
+        num_columns < 2 || num_columns > HOST_MAX_COLUMNS ||
+        value_width < 0 || value_width > 30000 || num_org_ids < 1 ||
+        records_per_trans < 1 || num_records < 0 || loops < 1 ||
+        ddl_burst < 1)
+    {
+        fprintf (stderr, "Invalid stream option\n");
+        return 2;
+    }
+
+    if (replay_file)
+        read_stream (replay_file);
+    else
+        create_synthetic_tables ();
+
+    /* The exit resolves ERCALLBACK from this executable */
+    handle = dlopen (library, RTLD_NOW | RTLD_LOCAL);
+    if (!handle)
+    {
+        fprintf (stderr, "%s\n", dlerror ());
+        return 1;
+    }
+    *(void **)&exit_entry = dlsym (handle, function);
+    if (!exit_entry)
+    {
+        fprintf (stderr, "%s\n", dlerror ());
+        return 1;
+    }
+    *(void **)&version = dlsym (handle, "fperexitversion");
+    if (version && version () > CALLBACK_STRUCT_VERSION)
+        fprintf (stderr, "Warning: %s uses callback structure version %d, "
+                 "the host version %d\n", library, version (),
+                 CALLBACK_STRUCT_VERSION);
+
+    t = time (NULL);
+    strftime (start_datetime, sizeof(start_datetime), "%Y-%m-%d %H:%M:%S",
+              localtime (&t));
+    strcpy (reset_datetime, start_datetime);
+
+    snprintf (exit_params.program_name, sizeof(exit_params.program_name),
+              "%s", mapped ? "replicat" : "extract");
+
+    records = 0;
+    call_exit (EXIT_CALL_START);
+    start = now_ns ();
+    if (!stopped && !abended)
+        records = run_stream (start);
+    elapsed = now_ns () - start;
+
+    if (abended)
+        call_exit (EXIT_CALL_FATAL_ERROR);
+    else
+        call_exit (EXIT_CALL_STOP);
+
+    print_summary (library, records, elapsed);
+    dlclose (handle);
+    return abended ? 1 : 0;
+}
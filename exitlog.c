@@ -0,0 +1,374 @@
+/**************************************************************************
+  Program description:
+
+  Level-gated, buffered report logging for the user exits.  See exitlog.h.
+
+***************************************************************************/
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "exitlog.h"
+
+#ifdef WIN32
+#define vsnprintf _vsnprintf
+#endif
+
+#ifndef va_copy
+#define va_copy(dest, src) ((dest) = (src))
+#endif
+
+int exit_log_level = EXIT_LOG_DEFAULT_LEVEL;
+
+static int buffered = 0;
+static char log_buffer[EXIT_LOG_BUFFER + 1];
+static size_t log_used = 0;
+
+/* Report rate limit, bytes per second, 0 for none */
+static size_t rate_limit = 0;
+static time_t rate_second = 0;
+static size_t rate_used = 0;
+static unsigned long rate_dropped = 0;
+
+static const char *level_names[] = { "ERROR", "WARN", "INFO", "DEBUG", "TRACE" };
+
+/* Hex dump tables: the two hex digits of a byte, and the byte or '.' */
+static char hex_pairs[2 * 256];
+static char printable[256];
+static int hex_tables_ready = 0;
+
+/***************************************************************************
+  Name of a level, for the startup report.
+***************************************************************************/
+const char *exit_log_level_name (int level)
+{
+    if (level < EXIT_LOG_ERROR || level > EXIT_LOG_TRACE)
+        return "UNKNOWN";
+    return level_names[level];
+}
+
+/***************************************************************************
+  Start buffering and take the runtime level from the environment
+  variable level_env, either a level name or its number.  The level is
+  capped at EXIT_LOG_MAX_LEVEL.
+***************************************************************************/
+void exit_log_init (const char *level_env)
+{
+    const char *value = level_env ? getenv (level_env) : NULL;
+    int i;
+
+    buffered = 1;
+
+    if (value && *value)
+    {
+        if (isdigit ((unsigned char)*value))
+            exit_log_level = atoi (value);
+        else
+        {
+            for (i = EXIT_LOG_ERROR; i <= EXIT_LOG_TRACE; i++)
+            {
+                const char *a = value;
+                const char *b = level_names[i];
+
+                while (*a && *b && toupper ((unsigned char)*a) == *b)
+                {
+                    a++;
+                    b++;
+                }
+                if (!*a && !*b)
+                {
+                    exit_log_level = i;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (exit_log_level > EXIT_LOG_MAX_LEVEL)
+        exit_log_level = EXIT_LOG_MAX_LEVEL;
+}
+
+/***************************************************************************
+  Write the buffered messages to the report, at most EXIT_LOG_MESSAGE_MAX
+  bytes per callback, split after a line end where possible.
+***************************************************************************/
+void exit_log_flush (void)
+{
+    size_t start = 0;
+
+    while (start < log_used)
+    {
+        size_t end = log_used;
+        char saved;
+
+        if (end - start > EXIT_LOG_MESSAGE_MAX)
+        {
+            end = start + EXIT_LOG_MESSAGE_MAX;
+            while (end > start && log_buffer[end - 1] != '\n')
+                end--;
+            if (end == start)
+                end = start + EXIT_LOG_MESSAGE_MAX;
+        }
+
+        saved = log_buffer[end];
+        log_buffer[end] = '\0';
+        report_message (log_buffer + start);
+        log_buffer[end] = saved;
+        start = end;
+    }
+
+    log_used = 0;
+    log_buffer[0] = '\0';
+}
+
+/***************************************************************************
+  Cap the bytes of INFO and higher level messages per second, 0 to lift
+  the cap.
+***************************************************************************/
+void exit_log_rate_limit (size_t bytes_per_second)
+{
+    rate_limit = bytes_per_second;
+    rate_second = 0;
+    rate_used = 0;
+}
+
+/***************************************************************************
+  Start a new second of the rate limit if the clock moved on, reporting
+  what the last one dropped.
+***************************************************************************/
+static void rate_window (void)
+{
+    time_t now = time (NULL);
+    unsigned long dropped;
+
+    if (now == rate_second)
+        return;
+    rate_second = now;
+    rate_used = 0;
+    if (rate_dropped)
+    {
+        dropped = rate_dropped;
+        rate_dropped = 0;
+        exit_log_printf (EXIT_LOG_WARN, "\nUser exit: %lu report messages "
+                         "dropped over the limit of %lu bytes per second.\n",
+                         dropped, (unsigned long)rate_limit);
+    }
+}
+
+/***************************************************************************
+  Has this second's report output reached the rate limit?  Lets an exit
+  skip a record dump it could only write in part.
+***************************************************************************/
+int exit_log_rate_exceeded (void)
+{
+    if (!rate_limit)
+        return 0;
+    rate_window ();
+    return rate_used >= rate_limit;
+}
+
+/***************************************************************************
+  May a message of level be written under the rate limit?  Counts it as
+  dropped if not.
+***************************************************************************/
+static int rate_allows (int level)
+{
+    if (!rate_limit || level <= EXIT_LOG_WARN)
+        return 1;
+    rate_window ();
+    if (rate_used < rate_limit)
+        return 1;
+    rate_dropped++;
+    return 0;
+}
+
+/***************************************************************************
+  Append a message to the buffer.  The buffer is flushed first when the
+  message does not fit, and after an error so that it reaches the report
+  even if the process abends next.
+***************************************************************************/
+void exit_log_vprintf (int level, const char *format, va_list args)
+{
+    size_t room;
+    int length;
+    va_list copy;
+
+    if (!exit_log_enabled (level) || !rate_allows (level))
+        return;
+
+    room = EXIT_LOG_BUFFER + 1 - log_used;
+    va_copy (copy, args);
+    length = vsnprintf (log_buffer + log_used, room, format, copy);
+    va_end (copy);
+
+    if ((length < 0 || (size_t)length >= room) && log_used > 0)
+    {
+        /* Does not fit behind the buffered messages */
+        log_buffer[log_used] = '\0';
+        exit_log_flush ();
+        room = EXIT_LOG_BUFFER + 1;
+        length = vsnprintf (log_buffer, room, format, args);
+    }
+
+    if (length < 0 || (size_t)length >= room)
+    {
+        /* Longer than the whole buffer: keep what fitted */
+        length = (int)(room - 1);
+        log_buffer[log_used + length] = '\0';
+    }
+    log_used += (size_t)length;
+    if (level > EXIT_LOG_WARN)
+        rate_used += (size_t)length;
+
+    if (!buffered || level == EXIT_LOG_ERROR || log_used == EXIT_LOG_BUFFER)
+        exit_log_flush ();
+}
+
+/***************************************************************************
+  Fill the hex dump tables, on first use so that isprint() answers in
+  the locale the exit runs in.
+***************************************************************************/
+static void init_hex_tables (void)
+{
+    static const char digits[] = "0123456789ABCDEF";
+    int c;
+
+    for (c = 0; c < 256; c++)
+    {
+        hex_pairs[2 * c] = digits[c >> 4];
+        hex_pairs[2 * c + 1] = digits[c & 0xF];
+        printable[c] = isprint (c) ? (char)c : '.';
+    }
+    hex_tables_ready = 1;
+}
+
+/***************************************************************************
+  Render length bytes of value as hex dump lines of EXIT_LOG_HEX_BYTES
+  bytes into out, numbering them from offset, with the layout of
+  "%5d:  %-10s   %-30s\n".  out needs EXIT_LOG_HEX_DUMP_SIZE(length)
+  bytes and is not NUL terminated.  Returns the bytes rendered.
+***************************************************************************/
+size_t exit_log_hex_format (char *out, const void *value, size_t length,
+                            size_t offset)
+{
+    const unsigned char *v = (const unsigned char *)value;
+    char *p = out;
+    char digits[20];
+    size_t n, k;
+    int d;
+
+    if (!hex_tables_ready)
+        init_hex_tables ();
+
+    while (length)
+    {
+        n = length < EXIT_LOG_HEX_BYTES ? length : EXIT_LOG_HEX_BYTES;
+
+        /* Offset, right aligned in 5 */
+        d = 0;
+        k = offset;
+        do
+        {
+            digits[d++] = (char)('0' + k % 10);
+            k /= 10;
+        } while (k);
+        for (k = d; k < 5; k++)
+            *p++ = ' ';
+        while (d)
+            *p++ = digits[--d];
+        *p++ = ':';
+        *p++ = ' ';
+        *p++ = ' ';
+
+        for (k = 0; k < n; k++)
+            p[k] = printable[v[k]];
+        for (; k < EXIT_LOG_HEX_BYTES; k++)
+            p[k] = ' ';
+        p += EXIT_LOG_HEX_BYTES;
+        *p++ = ' ';
+        *p++ = ' ';
+        *p++ = ' ';
+
+        for (k = 0; k < n; k++)
+        {
+            p[0] = hex_pairs[2 * v[k]];
+            p[1] = hex_pairs[2 * v[k] + 1];
+            p[2] = ' ';
+            p += 3;
+        }
+        for (k = n; k < EXIT_LOG_HEX_BYTES; k++)
+        {
+            p[0] = p[1] = p[2] = ' ';
+            p += 3;
+        }
+        *p++ = '\n';
+
+        v += n;
+        offset += n;
+        length -= n;
+    }
+
+    return (size_t)(p - out);
+}
+
+/***************************************************************************
+  Append the hex dump of a value to the buffer, flushing only when the
+  buffer fills.
+***************************************************************************/
+void exit_log_hex_dump (int level, const void *value, size_t length)
+{
+    const char *v = (const char *)value;
+    size_t done = 0;
+    size_t room;
+    size_t chunk;
+    size_t written;
+
+    if (!exit_log_enabled (level) || !rate_allows (level))
+        return;
+
+    while (done < length)
+    {
+        room = EXIT_LOG_BUFFER - log_used;
+        if (room < EXIT_LOG_HEX_LINE_MAX)
+        {
+            exit_log_flush ();
+            continue;
+        }
+        chunk = room / EXIT_LOG_HEX_LINE_MAX * EXIT_LOG_HEX_BYTES;
+        if (chunk > length - done)
+            chunk = length - done;
+        written = exit_log_hex_format (log_buffer + log_used, v + done,
+                                       chunk, done);
+        log_used += written;
+        if (level > EXIT_LOG_WARN)
+            rate_used += written;
+        done += chunk;
+    }
+    log_buffer[log_used] = '\0';
+
+    if (!buffered || level == EXIT_LOG_ERROR || log_used == EXIT_LOG_BUFFER)
+        exit_log_flush ();
+}
+
+void exit_log_printf (int level, const char *format, ...)
+{
+    va_list args;
+
+    va_start (args, format);
+    exit_log_vprintf (level, format, args);
+    va_end (args);
+}
+
+/***************************************************************************
+  Output an informational message to the report file (or console).
+***************************************************************************/
+void output_msg (char *msg, ...)
+{
+    va_list args;
+
+    va_start (args, msg);
+    exit_log_vprintf (EXIT_LOG_INFO, msg, args);
+    va_end (args);
+}
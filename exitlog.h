@@ -0,0 +1,103 @@
+/**************************************************************************
+  Program description:
+
+  Level-gated, buffered report logging for the user exits.
+
+  Messages are formatted straight into a per-process buffer.  Until the
+  exit calls exit_log_init() every message is written through to the
+  report at once, as output_msg() always did.  After it, the buffer is
+  handed to the report in as few OUTPUT_MESSAGE_TO_REPORT callbacks as
+  possible: when it fills, when the exit flushes it (EXIT_CALL_CHECKPOINT,
+  EXIT_CALL_END_TRANS, EXIT_CALL_STOP) and right away for errors.
+
+  exit_log() tests the level before its arguments are evaluated.  Levels
+  above EXIT_LOG_MAX_LEVEL (-DEXIT_LOG_MAX_LEVEL=...) compile to nothing,
+  the others cost one comparison against the runtime level when disabled.
+
+  A message longer than the buffer is truncated, never written past it.
+
+  exit_log_hex_dump() renders a binary value as offset, ASCII and hex
+  lines of 10 bytes, from lookup tables straight into the buffer, so a
+  column of any size costs one call instead of a formatted message per
+  line:
+
+      0:  ABC.....     41 42 43 00 00 00 00 01
+
+  exit_log_rate_limit() caps the bytes of INFO and higher level messages
+  written per second of wall clock, so sampled record dumps cannot flood
+  the report.  Errors and warnings are never held back.  Messages over
+  the cap are dropped whole and counted, and the count is reported as a
+  warning once the next second starts.
+
+***************************************************************************/
+
+#ifndef EXITLOG_H__
+#define EXITLOG_H__
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <time.h>
+
+#define EXIT_LOG_ERROR 0
+#define EXIT_LOG_WARN  1
+#define EXIT_LOG_INFO  2
+#define EXIT_LOG_DEBUG 3
+#define EXIT_LOG_TRACE 4
+
+/* Highest level compiled in */
+#ifndef EXIT_LOG_MAX_LEVEL
+#define EXIT_LOG_MAX_LEVEL EXIT_LOG_DEBUG
+#endif
+
+/* Runtime level when the environment does not set one */
+#define EXIT_LOG_DEFAULT_LEVEL EXIT_LOG_INFO
+
+/* Bytes buffered before the report is written */
+#define EXIT_LOG_BUFFER (32 * 1024)
+
+/* Largest text handed to one report callback; longer flushes are split at
+   line ends */
+#define EXIT_LOG_MESSAGE_MAX 4000
+
+/* Bytes of a value per hex dump line */
+#define EXIT_LOG_HEX_BYTES 10
+
+/* Longest hex dump line, with an offset of up to 20 digits */
+#define EXIT_LOG_HEX_LINE_MAX (20 + 2 + EXIT_LOG_HEX_BYTES + 3 + \
+                               3 * EXIT_LOG_HEX_BYTES + 1)
+
+/* Room for the hex dump of length bytes */
+#define EXIT_LOG_HEX_DUMP_SIZE(length) \
+    (((length) + EXIT_LOG_HEX_BYTES - 1) / EXIT_LOG_HEX_BYTES * \
+     EXIT_LOG_HEX_LINE_MAX)
+
+/* Current runtime level */
+extern int exit_log_level;
+
+#define exit_log_enabled(level) \
+    ((level) <= EXIT_LOG_MAX_LEVEL && (level) <= exit_log_level)
+
+#define exit_log(level, ...) \
+    do { \
+        if (exit_log_enabled (level)) \
+            exit_log_printf ((level), __VA_ARGS__); \
+    } while (0)
+
+void exit_log_init (const char *level_env);
+void exit_log_printf (int level, const char *format, ...);
+void exit_log_vprintf (int level, const char *format, va_list args);
+void exit_log_flush (void);
+void exit_log_rate_limit (size_t bytes_per_second);
+int exit_log_rate_exceeded (void);
+const char *exit_log_level_name (int level);
+size_t exit_log_hex_format (char *out, const void *value, size_t length,
+                            size_t offset);
+void exit_log_hex_dump (int level, const void *value, size_t length);
+
+/* Informational message, the output_msg() every exit uses */
+void output_msg (char *msg, ...);
+
+/* Writes text to the report, in exitrt.c */
+void report_message (char *text);
+
+#endif /* EXITLOG_H__ */
@@ -0,0 +1,224 @@
+/**************************************************************************
+  Program description:
+
+  Compiled EXITPARAM options for CUSEREXIT.  See exitparam.h.
+
+***************************************************************************/
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "exitparam.h"
+#include "exitlog.h"
+
+#define FILTER_OPTION "FILTER="
+
+static exit_param **buckets = NULL;
+static size_t num_buckets = 0;
+static size_t num_params = 0;
+
+/* Parameter of the previous lookup */
+static exit_param *last_param = NULL;
+
+/***************************************************************************
+  Double the hash buckets.  Returns 0 on allocation failure, leaving the
+  table as it was.
+***************************************************************************/
+static int grow_buckets (void)
+{
+    size_t new_count = num_buckets ? num_buckets * 2 : EXIT_PARAM_MIN_BUCKETS;
+    exit_param **new_buckets;
+    exit_param *param;
+    exit_param *next;
+    size_t i;
+
+    new_buckets = (exit_param **)calloc (new_count, sizeof(exit_param *));
+    if (!new_buckets)
+        return 0;
+
+    for (i = 0; i < num_buckets; i++)
+    {
+        for (param = buckets[i]; param; param = next)
+        {
+            next = param->next;
+            param->next = new_buckets[param->hash & (new_count - 1)];
+            new_buckets[param->hash & (new_count - 1)] = param;
+        }
+    }
+
+    free (buckets);
+    buckets = new_buckets;
+    num_buckets = new_count;
+    return 1;
+}
+
+/***************************************************************************
+  Copy of length bytes of text, NUL terminated.
+***************************************************************************/
+static char *copy_text (const char *text, size_t length)
+{
+    char *copy = (char *)malloc (length + 1);
+
+    if (copy)
+    {
+        memcpy (copy, text, length);
+        copy[length] = '\0';
+    }
+    return copy;
+}
+
+/***************************************************************************
+  Parse the words of param->text into its options.  Returns 0 on
+  allocation failure.
+***************************************************************************/
+static int parse_param (exit_param *param)
+{
+    const char *p = param->text;
+    const char *word;
+    size_t length;
+
+    for (;;)
+    {
+        while (isspace ((unsigned char)*p))
+            p++;
+        if (!*p)
+            break;
+        word = p;
+        while (*p && !isspace ((unsigned char)*p))
+            p++;
+        length = (size_t)(p - word);
+
+        if (length == sizeof("IGNOREDELETES") - 1 &&
+            !memcmp (word, "IGNOREDELETES", length))
+        {
+            param->ignore_deletes = 1;
+            continue;
+        }
+
+        if (length > sizeof(FILTER_OPTION) - 1 &&
+            !memcmp (word, FILTER_OPTION, sizeof(FILTER_OPTION) - 1))
+        {
+            word += sizeof(FILTER_OPTION) - 1;
+            length -= sizeof(FILTER_OPTION) - 1;
+        }
+
+        if (param->filter_file)
+        {
+            exit_log (EXIT_LOG_WARN, "EXITPARAM \"%s\" names more than one "
+                      "filter file, using %.*s.\n", param->text,
+                      (int)length, word);
+            free (param->filter_file);
+        }
+        param->filter_file = copy_text (word, length);
+        if (!param->filter_file)
+            return 0;
+    }
+    return 1;
+}
+
+/***************************************************************************
+  Find the options of an EXITPARAM parsed before.  Returns NULL if the
+  string was not seen yet.
+***************************************************************************/
+exit_param *exit_param_find (const char *text)
+{
+    exit_param *param;
+    size_t length;
+    unsigned int hash;
+
+    /* Records of one clause come in runs */
+    if (last_param && !strcmp (last_param->text, text))
+        return last_param;
+
+    if (!num_buckets)
+        return NULL;
+
+    length = strlen (text);
+    hash = org_filter_hash (text, length);
+    for (param = buckets[hash & (num_buckets - 1)]; param; param = param->next)
+    {
+        if (param->hash == hash && param->length == length &&
+            !memcmp (param->text, text, length))
+        {
+            last_param = param;
+            return param;
+        }
+    }
+    return NULL;
+}
+
+/***************************************************************************
+  Parse an EXITPARAM not seen before and intern its options.  Returns
+  NULL on allocation failure.
+***************************************************************************/
+exit_param *exit_param_add (const char *text)
+{
+    exit_param *param;
+    size_t bucket;
+
+    if (num_params >= num_buckets && !grow_buckets () && !num_buckets)
+        return NULL;
+
+    param = (exit_param *)calloc (1, sizeof(exit_param));
+    if (!param)
+        return NULL;
+    param->length = strlen (text);
+    param->text = copy_text (text, param->length);
+    if (!param->text || !parse_param (param))
+    {
+        free (param->text);
+        free (param->filter_file);
+        free (param);
+        return NULL;
+    }
+    param->hash = org_filter_hash (text, param->length);
+
+    bucket = param->hash & (num_buckets - 1);
+    param->next = buckets[bucket];
+    buckets[bucket] = param;
+    num_params++;
+    last_param = param;
+    return param;
+}
+
+/***************************************************************************
+  Look the compiled filters up again, after org_filter_reload_changed()
+  replaced some of them.
+***************************************************************************/
+void exit_param_refresh_filters (void)
+{
+    exit_param *param;
+    size_t i;
+
+    for (i = 0; i < num_buckets; i++)
+        for (param = buckets[i]; param; param = param->next)
+            if (param->filter_file)
+                param->filter = org_filter_find (param->filter_file);
+}
+
+/***************************************************************************
+  Release all parameters, called at EXIT_CALL_STOP.
+***************************************************************************/
+void exit_param_free_all (void)
+{
+    exit_param *param;
+    exit_param *next;
+    size_t i;
+
+    for (i = 0; i < num_buckets; i++)
+    {
+        for (param = buckets[i]; param; param = next)
+        {
+            next = param->next;
+            free (param->text);
+            free (param->filter_file);
+            free (param);
+        }
+    }
+    free (buckets);
+    buckets = NULL;
+    num_buckets = 0;
+    num_params = 0;
+    last_param = NULL;
+}
@@ -0,0 +1,61 @@
+/**************************************************************************
+  Program description:
+
+  Compiled EXITPARAM options for CUSEREXIT.
+
+  Every TABLE/MAP clause can give the exit its own EXITPARAM.  The first
+  record seen with a parameter string parses it into an exit_param,
+  interned in a hash table under the string, and every later record of
+  the clause finds it with one compare of the string against the last
+  parameter seen, or a hash probe when clauses alternate.  The record
+  path then reads the options from the exit_param, with no string work:
+
+      param = exit_param_find (exit_params->function_param);
+      if (!param)
+          param = exit_param_add (exit_params->function_param);
+      if (param->ignore_deletes && record->io_type == DELETE_VAL)
+          ...
+
+  The host hands the parameter in one exit_params buffer that it
+  rewrites for each clause, so the buffer address alone cannot tell
+  the clauses apart.
+
+  An EXITPARAM is a list of words separated by white space:
+
+      IGNOREDELETES      ignore delete records
+      FILTER=<file>      partition filter file, see orgfilter.h
+      <file>             the same, for the EXITPARAMs of earlier releases
+
+  The compiled partition filter is looked up by the exit on first use and
+  kept in filter; exit_param_refresh_filters() looks it up again after
+  org_filter_reload_changed() swaps in recompiled filters.
+
+***************************************************************************/
+
+#ifndef EXITPARAM_H__
+#define EXITPARAM_H__
+
+#include <stddef.h>
+
+#include "orgfilter.h"
+
+/* Minimum number of hash buckets, must be a power of two */
+#define EXIT_PARAM_MIN_BUCKETS 16
+
+typedef struct exit_param
+{
+    char *text;                 /* The EXITPARAM string */
+    size_t length;              /* Length of text */
+    unsigned int hash;          /* Hash of text */
+    short ignore_deletes;       /* IGNOREDELETES given */
+    char *filter_file;          /* Partition filter file, NULL for none */
+    org_filter_def *filter;     /* Compiled filter, NULL until looked up */
+    struct exit_param *next;    /* Next in the hash bucket */
+} exit_param;
+
+exit_param *exit_param_find (const char *text);
+exit_param *exit_param_add (const char *text);
+void exit_param_refresh_filters (void);
+void exit_param_free_all (void);
+
+#endif /* EXITPARAM_H__ */
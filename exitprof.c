@@ -0,0 +1,519 @@
+/**************************************************************************
+  Program description:
+
+  Callback profiler for the user exits.  See exitprof.h.
+
+***************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if !defined(WIN32)
+#include <sys/time.h>
+#endif
+
+/* The exit linking this library defines the version function */
+#define GOLDENGATE__
+#include "exitrt.h"
+#include "exitprof.h"
+
+/* Callback function codes profiled */
+#define PROF_CODES (GET_EVENT_RECORD + 1)
+
+/* Hash buckets of the per table counters, a power of two */
+#define PROF_TABLE_BUCKETS 256
+
+typedef struct
+{
+    unsigned long calls;        /* Callbacks made */
+    uint64_t total_ns;          /* Time in them */
+    uint64_t max_ns;            /* Longest one */
+    unsigned long histogram[EXIT_PROF_BUCKETS];
+} prof_function;
+
+typedef struct prof_table
+{
+    char *name;                 /* Table or DDL object name */
+    size_t length;              /* Length of name */
+    unsigned int hash;          /* Hash of name */
+    unsigned long total_calls;  /* Callbacks for its records */
+    uint64_t total_ns;          /* Time in them */
+    unsigned long calls[PROF_CODES];
+    uint64_t ns[PROF_CODES];
+    struct prof_table *next;
+} prof_table;
+
+static const char *function_names[PROF_CODES] =
+{
+    "COMPRESS_RECORD", "DECOMPRESS_RECORD", "GET_BEFORE_AFTER_IND",
+    "GET_COLUMN_INDEX_FROM_NAME", "GET_COLUMN_NAME_FROM_INDEX",
+    "GET_COLUMN_VALUE_FROM_INDEX", "GET_COLUMN_VALUE_FROM_NAME",
+    "GET_ERROR_INFO", "GET_MARKER_INFO", "GET_OPERATION_TYPE",
+    "GET_RECORD_BUFFER", "GET_RECORD_LENGTH", "GET_RECORD_TYPE",
+    "GET_STATISTICS", "GET_TABLE_COLUMN_COUNT", "GET_TABLE_NAME",
+    "GET_TIMESTAMP", "GET_TRANSACTION_IND", "SET_COLUMN_VALUE_BY_INDEX",
+    "SET_COLUMN_VALUE_BY_NAME", "SET_OPERATION_TYPE", "SET_RECORD_BUFFER",
+    "SET_TABLE_NAME", "FETCH_CURRENT_RECORD",
+    "FETCH_CURRENT_RECORD_WITH_LOCK", "OUTPUT_MESSAGE_TO_REPORT",
+    "GET_COL_METADATA_FROM_INDEX", "GET_COL_METADATA_FROM_NAME",
+    "GET_TABLE_METADATA", "GET_POSITION", "GET_USER_TOKEN_VALUE",
+    "GET_ENV_VALUE", "GET_DDL_RECORD_PROPERTIES", "RESET_USEREXIT_STATS",
+    "GET_GMT_TIMESTAMP", "SET_SESSION_CHARSET", "GET_SESSION_CHARSET",
+    "GET_DATABASE_METADATA", "GET_TABLE_NAME_ONLY", "GET_SCHEMA_NAME_ONLY",
+    "GET_CATALOG_NAME_ONLY", "GET_OBJECT_NAME_ONLY", "GET_OBJECT_NAME",
+    "GET_BASE_OBJECT_NAME_ONLY", "GET_BASE_SCHEMA_NAME_ONLY",
+    "GET_BASE_OBJECT_NAME", "GET_EVENT_RECORD"
+};
+
+int exit_prof_enabled = 0;
+
+/* Seconds between summaries, and time of the last one */
+static long report_interval = 0;
+static time_t last_report = 0;
+
+static prof_function functions[PROF_CODES];
+static unsigned long exit_calls = 0;
+static uint64_t exit_ns = 0;
+
+static prof_table *tables[PROF_TABLE_BUCKETS];
+static size_t num_tables = 0;
+
+/* The exit call in progress; its callbacks are added to its table once
+   the table is known, at the end of the call */
+static int in_call = 0;
+static uint64_t call_start = 0;
+static prof_table *call_table = NULL;
+static short call_num_codes = 0;
+static short call_codes[PROF_CODES];
+static unsigned long call_calls[PROF_CODES];
+static uint64_t call_ns[PROF_CODES];
+
+/***************************************************************************
+  Monotonic clock in nanoseconds.
+***************************************************************************/
+uint64_t exit_prof_clock (void)
+{
+#if defined(WIN32)
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER now;
+
+    if (!frequency.QuadPart)
+        QueryPerformanceFrequency (&frequency);
+    QueryPerformanceCounter (&now);
+    return (uint64_t)(now.QuadPart / frequency.QuadPart) * 1000000000u +
+           (uint64_t)(now.QuadPart % frequency.QuadPart) * 1000000000u /
+           (uint64_t)frequency.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+#else
+    struct timeval now;
+
+    gettimeofday (&now, NULL);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_usec * 1000u;
+#endif
+}
+
+/***************************************************************************
+  Histogram bucket of a time: the time itself below EXIT_PROF_SUB_BUCKETS,
+  then EXIT_PROF_SUB_BUCKETS buckets per power of two.
+***************************************************************************/
+static int bucket_of (uint64_t ns)
+{
+    int msb = 0;
+    int bucket;
+
+    if (ns < EXIT_PROF_SUB_BUCKETS)
+        return (int)ns;
+#if defined(__GNUC__)
+    msb = 63 - __builtin_clzll ((unsigned long long)ns);
+#else
+    {
+        uint64_t v = ns;
+
+        while (v >>= 1)
+            msb++;
+    }
+#endif
+    bucket = (msb - EXIT_PROF_SUB_BITS + 1) * EXIT_PROF_SUB_BUCKETS +
+             (int)((ns >> (msb - EXIT_PROF_SUB_BITS)) &
+                   (EXIT_PROF_SUB_BUCKETS - 1));
+    return bucket < EXIT_PROF_BUCKETS ? bucket : EXIT_PROF_BUCKETS - 1;
+}
+
+/***************************************************************************
+  Smallest time counted in a bucket.
+***************************************************************************/
+static uint64_t bucket_start (int bucket)
+{
+    int msb;
+
+    if (bucket < EXIT_PROF_SUB_BUCKETS)
+        return (uint64_t)bucket;
+    msb = bucket / EXIT_PROF_SUB_BUCKETS + EXIT_PROF_SUB_BITS - 1;
+    return (uint64_t)(EXIT_PROF_SUB_BUCKETS + bucket % EXIT_PROF_SUB_BUCKETS) <<
+           (msb - EXIT_PROF_SUB_BITS);
+}
+
+/***************************************************************************
+  Time under which a fraction of a function's callbacks took, as the end
+  of the histogram bucket it falls in, at most the longest time.
+***************************************************************************/
+static uint64_t percentile (const prof_function *function, double fraction)
+{
+    unsigned long target = (unsigned long)(fraction * function->calls + 0.5);
+    unsigned long seen = 0;
+    uint64_t end;
+    int i;
+
+    if (target < 1)
+        target = 1;
+    for (i = 0; i < EXIT_PROF_BUCKETS - 1; i++)
+    {
+        seen += function->histogram[i];
+        if (seen >= target)
+        {
+            end = bucket_start (i + 1) - 1;
+            return end < function->max_ns ? end : function->max_ns;
+        }
+    }
+    return function->max_ns;
+}
+
+/***************************************************************************
+  Counters of a table, added the first time it is seen.  Returns NULL on
+  allocation failure.
+***************************************************************************/
+static prof_table *find_table (const char *name, size_t length)
+{
+    unsigned int hash = 2166136261u;
+    prof_table *table;
+    size_t bucket;
+    size_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+
+    bucket = hash & (PROF_TABLE_BUCKETS - 1);
+    for (table = tables[bucket]; table; table = table->next)
+        if (table->hash == hash && table->length == length &&
+            !memcmp (table->name, name, length))
+            return table;
+
+    table = (prof_table *)calloc (1, sizeof(prof_table));
+    if (!table)
+        return NULL;
+    table->name = (char *)malloc (length + 1);
+    if (!table->name)
+    {
+        free (table);
+        return NULL;
+    }
+    memcpy (table->name, name, length);
+    table->name[length] = '\0';
+    table->length = length;
+    table->hash = hash;
+    table->next = tables[bucket];
+    tables[bucket] = table;
+    num_tables++;
+    return table;
+}
+
+/***************************************************************************
+  Turn the profiler on if the environment variable interval_env gives a
+  report interval, called at EXIT_CALL_START.
+***************************************************************************/
+void exit_prof_init (const char *interval_env)
+{
+    const char *value = interval_env ? getenv (interval_env) : NULL;
+
+    exit_prof_free ();
+    report_interval = value ? atol (value) : 0;
+    if (report_interval <= 0)
+        return;
+
+    memset (functions, 0, sizeof(functions));
+    memset (call_calls, 0, sizeof(call_calls));
+    memset (call_ns, 0, sizeof(call_ns));
+    call_num_codes = 0;
+    exit_calls = 0;
+    exit_ns = 0;
+    last_report = time (NULL);
+    exit_prof_enabled = 1;
+}
+
+/***************************************************************************
+  Count a callback, from call_callback().
+***************************************************************************/
+void exit_prof_callback (int function_code, const void *buf,
+                         short result_code, uint64_t elapsed_ns)
+{
+    prof_function *function;
+    const env_value_def *env_value;
+
+    if (function_code < 0 || function_code >= PROF_CODES)
+        return;
+
+    function = &functions[function_code];
+    function->calls++;
+    function->total_ns += elapsed_ns;
+    if (elapsed_ns > function->max_ns)
+        function->max_ns = elapsed_ns;
+    function->histogram[bucket_of (elapsed_ns)]++;
+
+    if (!in_call)
+        return;
+
+    if (!call_calls[function_code])
+        call_codes[call_num_codes++] = (short)function_code;
+    call_calls[function_code]++;
+    call_ns[function_code] += elapsed_ns;
+
+    /* The first table name read names the record's table */
+    if (function_code == GET_TABLE_NAME && !call_table && buf &&
+        result_code == EXIT_FN_RET_OK)
+    {
+        env_value = (const env_value_def *)buf;
+        if (env_value->buffer && env_value->actual_length > 0)
+            call_table = find_table (env_value->buffer,
+                                     (size_t)env_value->actual_length);
+    }
+}
+
+/***************************************************************************
+  Start of a call of the exit.
+***************************************************************************/
+void exit_prof_call_begin (void)
+{
+    in_call = 1;
+    call_table = NULL;
+    call_num_codes = 0;
+    call_start = exit_prof_clock ();
+}
+
+/***************************************************************************
+  Table of the current record, for a record whose exit read no table
+  name: its table, or for DDL the object it touches.  The lookups are
+  made with the profiler off, so they are not counted.
+***************************************************************************/
+static prof_table *record_table (void)
+{
+    static const ercallback_function_codes name_codes[] =
+        { GET_TABLE_NAME, GET_OBJECT_NAME };
+    prof_table *table = NULL;
+    short result_code;
+    env_value_def env_value;
+    char name[500];
+    int i;
+
+    exit_prof_enabled = 0;
+    for (i = 0; i < 2 && !table; i++)
+    {
+        memset (&env_value, 0, sizeof(env_value_def));
+        env_value.buffer = name;
+        env_value.max_length = sizeof(name);
+        env_value.source_or_target = EXIT_FN_SOURCE_VAL;
+
+        call_callback (name_codes[i], &env_value, &result_code);
+        if (result_code == EXIT_FN_RET_OK && env_value.actual_length > 0)
+            table = find_table (name, (size_t)env_value.actual_length);
+    }
+    exit_prof_enabled = 1;
+    return table;
+}
+
+/***************************************************************************
+  End of a call of the exit: add its time, and its callbacks to its
+  table.
+***************************************************************************/
+void exit_prof_call_end (short exit_call_type)
+{
+    short code;
+    short i;
+
+    if (!in_call)
+        return;
+    in_call = 0;
+    exit_calls++;
+    exit_ns += exit_prof_clock () - call_start;
+
+    if (!call_table && exit_call_type == EXIT_CALL_PROCESS_RECORD)
+        call_table = record_table ();
+
+    for (i = 0; i < call_num_codes; i++)
+    {
+        code = call_codes[i];
+        if (call_table)
+        {
+            call_table->calls[code] += call_calls[code];
+            call_table->ns[code] += call_ns[code];
+            call_table->total_calls += call_calls[code];
+            call_table->total_ns += call_ns[code];
+        }
+        call_calls[code] = 0;
+        call_ns[code] = 0;
+    }
+    call_num_codes = 0;
+}
+
+/***************************************************************************
+  Order the function codes with calls by time, longest first.  Returns
+  the number of codes in order.
+***************************************************************************/
+static short sort_codes (const unsigned long *calls, const uint64_t *ns,
+                         short *order)
+{
+    short num_codes = 0;
+    short code;
+    short i;
+
+    for (code = 0; code < PROF_CODES; code++)
+    {
+        if (!calls[code])
+            continue;
+        for (i = num_codes; i > 0 && ns[order[i - 1]] < ns[code]; i--)
+            order[i] = order[i - 1];
+        order[i] = code;
+        num_codes++;
+    }
+    return num_codes;
+}
+
+static int compare_tables (const void *a, const void *b)
+{
+    const prof_table *x = *(const prof_table * const *)a;
+    const prof_table *y = *(const prof_table * const *)b;
+
+    return x->total_ns < y->total_ns ? 1 : x->total_ns > y->total_ns ? -1 : 0;
+}
+
+static double share_of_exit (uint64_t ns)
+{
+    return exit_ns ? 100.0 * (double)ns / (double)exit_ns : 0.0;
+}
+
+/***************************************************************************
+  Write the profile since EXIT_CALL_START to the report.
+***************************************************************************/
+void exit_prof_report (void)
+{
+    short order[PROF_CODES];
+    unsigned long calls[PROF_CODES];
+    uint64_t ns[PROF_CODES];
+    short num_codes;
+    prof_function *function;
+    prof_table **by_time;
+    prof_table *table;
+    unsigned long callbacks = 0;
+    uint64_t callback_ns = 0;
+    size_t num_listed = 0;
+    size_t i;
+    short j;
+
+    if (!exit_prof_enabled)
+        return;
+
+    for (j = 0; j < PROF_CODES; j++)
+    {
+        calls[j] = functions[j].calls;
+        ns[j] = functions[j].total_ns;
+    }
+    num_codes = sort_codes (calls, ns, order);
+    for (j = 0; j < num_codes; j++)
+    {
+        callbacks += functions[order[j]].calls;
+        callback_ns += functions[order[j]].total_ns;
+    }
+
+    output_msg ("\nUser exit: callback profile, %lu exit calls in %.3f ms, "
+                "%lu callbacks in %.3f ms (%.1f%%)\n",
+                exit_calls, exit_ns / 1e6, callbacks, callback_ns / 1e6,
+                share_of_exit (callback_ns));
+    output_msg ("%-31s %10s %11s %7s %9s %9s %9s %11s\n", "Function", "Calls",
+                "Total ms", "% exit", "Avg ns", "p50 ns", "p99 ns", "Max ns");
+    for (j = 0; j < num_codes; j++)
+    {
+        function = &functions[order[j]];
+        output_msg ("%-31s %10lu %11.3f %6.1f%% %9lu %9lu %9lu %11lu\n",
+                    function_names[order[j]], function->calls,
+                    function->total_ns / 1e6,
+                    share_of_exit (function->total_ns),
+                    (unsigned long)(function->total_ns / function->calls),
+                    (unsigned long)percentile (function, 0.50),
+                    (unsigned long)percentile (function, 0.99),
+                    (unsigned long)function->max_ns);
+    }
+
+    if (!num_tables)
+        return;
+    by_time = (prof_table **)malloc (num_tables * sizeof(prof_table *));
+    if (!by_time)
+        return;
+    for (i = 0; i < PROF_TABLE_BUCKETS; i++)
+        for (table = tables[i]; table; table = table->next)
+            by_time[num_listed++] = table;
+    qsort (by_time, num_listed, sizeof(prof_table *), compare_tables);
+    if (num_listed > EXIT_PROF_REPORT_TABLES)
+        num_listed = EXIT_PROF_REPORT_TABLES;
+
+    for (i = 0; i < num_listed; i++)
+    {
+        table = by_time[i];
+        output_msg ("\nTable %s: %lu callbacks in %.3f ms (%.1f%%)\n",
+                    table->name, table->total_calls, table->total_ns / 1e6,
+                    share_of_exit (table->total_ns));
+        num_codes = sort_codes (table->calls, table->ns, order);
+        for (j = 0; j < num_codes; j++)
+            output_msg ("    %-31s %10lu %11.3f %6.1f%%\n",
+                        function_names[order[j]], table->calls[order[j]],
+                        table->ns[order[j]] / 1e6,
+                        share_of_exit (table->ns[order[j]]));
+    }
+    free (by_time);
+}
+
+/***************************************************************************
+  Write a summary if the report interval passed, at EXIT_CALL_CHECKPOINT.
+***************************************************************************/
+void exit_prof_checkpoint (void)
+{
+    time_t now;
+
+    if (!exit_prof_enabled)
+        return;
+    now = time (NULL);
+    if (now - last_report < report_interval)
+        return;
+    last_report = now;
+    exit_prof_report ();
+}
+
+/***************************************************************************
+  Turn the profiler off and release the per table counters, called at
+  EXIT_CALL_STOP.
+***************************************************************************/
+void exit_prof_free (void)
+{
+    prof_table *table;
+    prof_table *next;
+    size_t i;
+
+    for (i = 0; i < PROF_TABLE_BUCKETS; i++)
+    {
+        for (table = tables[i]; table; table = next)
+        {
+            next = table->next;
+            free (table->name);
+            free (table);
+        }
+        tables[i] = NULL;
+    }
+    num_tables = 0;
+    in_call = 0;
+    exit_prof_enabled = 0;
+}
@@ -0,0 +1,73 @@
+/**************************************************************************
+  Program description:
+
+  Callback profiler for the user exits.
+
+  When it is turned on, call_callback() times every callback and keeps
+  per function code the number of calls, their total and longest time
+  and a log-linear latency histogram: 4 buckets per power of two of
+  nanoseconds, so a percentile is within 25% of the true value.  The
+  time of each call of the exit is kept as well, and the callbacks made
+  while the exit handled a record are added up by the record's table, as
+  named by the first GET_TABLE_NAME of the call.  For a record whose exit
+  reads no table name the profiler asks for it at the end of the call,
+  or for the object name of a DDL record, outside the counts.
+
+  A summary goes to the report when the exit asks for it: per function
+  code the calls, total time, share of the time spent in the exit,
+  average, p50, p99 and longest time, and then the tables taking the most
+  callback time:
+
+      exit_prof_init ("CUSEREXIT_PROFILE");
+      ...
+      case EXIT_CALL_CHECKPOINT:
+          exit_prof_checkpoint ();
+      case EXIT_CALL_STOP:
+          exit_prof_report ();
+          exit_prof_free ();
+
+  The environment variable turns the profiler on and gives the interval
+  in seconds between summaries, written at the first checkpoint after
+  each interval as REPORTCOUNT does for the process statistics; the last
+  summary is written at EXIT_CALL_STOP.  Unset or 0 leaves it off, and
+  then a callback costs one test of exit_prof_enabled.
+
+  The exit is called on one thread, so the counters are plain
+  increments with no lock.  Calls of the exit are timed between
+  exit_trace_call_begin() and exit_trace_call_end() (exittrace.h).
+
+***************************************************************************/
+
+#ifndef EXITPROF_H__
+#define EXITPROF_H__
+
+#if defined(__MVS__)
+#include <inttypes.h>
+#else
+#include <stdint.h>
+#endif
+
+/* Latency histogram buckets per power of two, as bits */
+#define EXIT_PROF_SUB_BITS 2
+#define EXIT_PROF_SUB_BUCKETS (1 << EXIT_PROF_SUB_BITS)
+
+/* Histogram buckets, up to 2^40 ns; longer times count in the last */
+#define EXIT_PROF_BUCKETS ((41 - EXIT_PROF_SUB_BITS) * EXIT_PROF_SUB_BUCKETS)
+
+/* Tables listed in a summary */
+#define EXIT_PROF_REPORT_TABLES 20
+
+/* Profiler on? */
+extern int exit_prof_enabled;
+
+void exit_prof_init (const char *interval_env);
+uint64_t exit_prof_clock (void);
+void exit_prof_callback (int function_code, const void *buf,
+                         short result_code, uint64_t elapsed_ns);
+void exit_prof_call_begin (void);
+void exit_prof_call_end (short exit_call_type);
+void exit_prof_checkpoint (void);
+void exit_prof_report (void);
+void exit_prof_free (void);
+
+#endif /* EXITPROF_H__ */
@@ -0,0 +1,391 @@
+/**************************************************************************
+  Program description:
+
+  Table metadata loading and one-pass record materialization for the user
+  exits.  See exitrecord.h.
+
+***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The exit linking this library defines the version function */
+#define GOLDENGATE__
+#include "exitrt.h"
+#include "exitrecord.h"
+
+/***************************************************************************
+  Copy one name part of the current record's table into a metadata cache
+  entry.
+***************************************************************************/
+static short load_table_name_part (ercallback_function_codes function_code,
+                                   short source_or_target, char **name_part)
+{
+    short result_code;
+    env_value_def env_value;
+    char name[500];
+
+    memset (&env_value, 0, sizeof(env_value_def));
+    env_value.buffer = name;
+    env_value.max_length = sizeof(name);
+    env_value.source_or_target = source_or_target;
+
+    call_callback (function_code, &env_value, &result_code);
+    if (result_code != EXIT_FN_RET_OK)
+        return result_code;
+
+    *name_part = table_meta_copy (name, env_value.actual_length);
+    return *name_part ? EXIT_FN_RET_OK : EXIT_ABEND_VAL;
+}
+
+/***************************************************************************
+  Fill the metadata cache entry of the current record's table, named by
+  GET_TABLE_NAME.  These are the only metadata callbacks the exit makes
+  for a table until a metadata event or DDL invalidates the entry.
+***************************************************************************/
+table_meta *load_table_metadata (short source_or_target,
+                                 const char *table_name, size_t length,
+                                 short *result_code)
+{
+    table_meta *meta;
+    table_def table;
+    table_metadata_def table_meta;
+    col_metadata_def col_meta;
+    table_meta_column *meta_column;
+    char name[500];
+    short i;
+
+    memset (&table, 0, sizeof(table_def));
+    table.source_or_target = source_or_target;
+    call_callback (GET_TABLE_COLUMN_COUNT, &table, result_code);
+    if (*result_code != EXIT_FN_RET_OK)
+    {
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving table column count.\n",
+                  *result_code);
+        return NULL;
+    }
+
+    meta = table_meta_add (table_name, length, source_or_target,
+                           table.num_columns, table.num_key_columns);
+    if (!meta)
+    {
+        exit_log (EXIT_LOG_ERROR, "Error allocating the metadata of %.*s.\n",
+                  (int)length, table_name);
+        *result_code = EXIT_ABEND_VAL;
+        return NULL;
+    }
+
+    if ((*result_code = load_table_name_part (GET_CATALOG_NAME_ONLY,
+                                              source_or_target,
+                                              &meta->catalog_name)) !=
+            EXIT_FN_RET_OK ||
+        (*result_code = load_table_name_part (GET_SCHEMA_NAME_ONLY,
+                                              source_or_target,
+                                              &meta->schema_name)) !=
+            EXIT_FN_RET_OK ||
+        (*result_code = load_table_name_part (GET_TABLE_NAME_ONLY,
+                                              source_or_target,
+                                              &meta->object_name)) !=
+            EXIT_FN_RET_OK)
+    {
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving the name of %.*s.\n",
+                  *result_code, (int)length, table_name);
+        table_meta_remove (meta);
+        return NULL;
+    }
+
+    memset (&table_meta, 0, sizeof(table_meta));
+    table_meta.source_or_target = source_or_target;
+    table_meta.table_name = name;
+    table_meta.max_name_length = sizeof(name);
+    table_meta.key_columns = meta->key_columns;
+
+    call_callback (GET_TABLE_METADATA, &table_meta, result_code);
+    if (*result_code != EXIT_FN_RET_OK)
+    {
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving table metadata.\n", *result_code);
+        table_meta_remove (meta);
+        return NULL;
+    }
+    meta->num_user_columns = table_meta.num_user_columns;
+    meta->using_pseudo_key = table_meta.using_pseudo_key;
+
+    for (i = 0; i < meta->num_columns; i++)
+    {
+        memset (&col_meta, 0, sizeof(col_meta));
+        col_meta.source_or_target = source_or_target;
+        col_meta.column_index = i;
+        col_meta.column_name = name;
+        col_meta.max_name_length = sizeof(name);
+
+        call_callback (GET_COL_METADATA_FROM_INDEX, &col_meta, result_code);
+        if (*result_code != EXIT_FN_RET_OK)
+        {
+            exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving column metadata.\n", *result_code);
+            table_meta_remove (meta);
+            return NULL;
+        }
+
+        meta_column = &meta->columns[i];
+        meta_column->name = table_meta_copy (name, strlen (name));
+        if (!meta_column->name)
+        {
+            exit_log (EXIT_LOG_ERROR, "Error allocating the metadata of %.*s.\n",
+                      (int)length, table_name);
+            table_meta_remove (meta);
+            *result_code = EXIT_ABEND_VAL;
+            return NULL;
+        }
+        meta_column->native_data_type = col_meta.native_data_type;
+        meta_column->gg_data_type = col_meta.gg_data_type;
+        meta_column->gg_sub_data_type = col_meta.gg_sub_data_type;
+        meta_column->is_nullable = col_meta.is_nullable;
+        meta_column->is_part_of_key = col_meta.is_part_of_key;
+        meta_column->key_column_index = col_meta.key_column_index;
+        meta_column->length = col_meta.length;
+        meta_column->precision = col_meta.precision;
+        meta_column->scale = col_meta.scale;
+        meta_column->is_hidden_column = col_meta.is_hidden_column;
+    }
+
+    *result_code = EXIT_FN_RET_OK;
+    return meta;
+}
+
+/***************************************************************************
+  Metadata of a table from the cache, loaded on first sight.
+***************************************************************************/
+table_meta *find_table_metadata (short source_or_target,
+                                 const char *table_name, size_t length,
+                                 short *result_code)
+{
+    table_meta *meta;
+
+    meta = table_meta_find (table_name, length, source_or_target);
+    if (meta)
+    {
+        *result_code = EXIT_FN_RET_OK;
+        return meta;
+    }
+    return load_table_metadata (source_or_target, table_name, length,
+                                result_code);
+}
+
+/***************************************************************************
+  Metadata of the current record's table.
+***************************************************************************/
+table_meta *current_table_metadata (short source_or_target,
+                                    short *result_code)
+{
+    env_value_def env_value;
+    char table_name[500];
+
+    memset (&env_value, 0, sizeof(env_value_def));
+    env_value.buffer = table_name;
+    env_value.max_length = sizeof(table_name);
+    env_value.source_or_target = source_or_target;
+
+    call_callback (GET_TABLE_NAME, &env_value, result_code);
+    if (*result_code != EXIT_FN_RET_OK)
+    {
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving fully qualified table name.\n",
+                  *result_code);
+        return NULL;
+    }
+
+    return find_table_metadata (source_or_target, table_name,
+                                env_value.actual_length, result_code);
+}
+
+/***************************************************************************
+  Make room in a record view for num_columns columns and data_size bytes
+  of values.  Returns 0 if memory runs out; the view stays usable.
+***************************************************************************/
+static int exit_record_reserve (exit_record *record, short num_columns,
+                                size_t data_size)
+{
+    size_t *offsets;
+    unsigned short *lengths;
+    char *null_flags;
+    char *data;
+    size_t size;
+
+    if (num_columns > record->max_columns)
+    {
+        offsets = (size_t *)realloc (record->offsets,
+                                     num_columns * sizeof(size_t));
+        if (!offsets)
+            return 0;
+        record->offsets = offsets;
+
+        lengths = (unsigned short *)realloc (record->lengths,
+                                             num_columns * sizeof(unsigned short));
+        if (!lengths)
+            return 0;
+        record->lengths = lengths;
+
+        null_flags = (char *)realloc (record->null_flags, num_columns);
+        if (!null_flags)
+            return 0;
+        record->null_flags = null_flags;
+
+        record->max_columns = num_columns;
+    }
+
+    if (data_size > record->data_size)
+    {
+        size = record->data_size ? record->data_size : EXIT_RECORD_INITIAL_DATA;
+        while (size < data_size)
+            size *= 2;
+
+        data = (char *)realloc (record->data, size);
+        if (!data)
+            return 0;
+        record->data = data;
+        record->data_size = size;
+    }
+
+    return 1;
+}
+
+/***************************************************************************
+  Materialize every column of the current record of a table into a record
+  view, one GET_COLUMN_VALUE_FROM_INDEX callback per column.
+***************************************************************************/
+short exit_record_load_table (exit_record *record, table_meta *meta,
+                              short source_or_target,
+                              short ascii_or_internal)
+{
+    column_def column;
+    size_t room;
+    short result_code;
+    short i;
+
+    record->meta = meta;
+    record->source_or_target = source_or_target;
+    record->ascii_or_internal = ascii_or_internal;
+    record->num_columns = 0;
+    record->data_used = 0;
+
+    if (!exit_record_reserve (record, meta->num_columns,
+                              EXIT_RECORD_INITIAL_DATA))
+    {
+        exit_log (EXIT_LOG_ERROR, "Error allocating the record of %s.\n",
+                  meta->table_name);
+        return EXIT_ABEND_VAL;
+    }
+
+    memset (&column, 0, sizeof(column_def));
+    column.source_or_target = source_or_target;
+    column.column_value_mode = ascii_or_internal;
+
+    for (i = 0; i < meta->num_columns; i++)
+    {
+        column.column_index = i;
+
+        for (;;)
+        {
+            /* Fetch straight into the buffer, keeping a byte for the NUL */
+            room = record->data_size - record->data_used - 1;
+            column.column_value = record->data + record->data_used;
+            column.max_value_length =
+                (unsigned short)(room < MAX_COL_LEN ? room : MAX_COL_LEN);
+            column.value_truncated = 0;
+
+            call_callback (GET_COLUMN_VALUE_FROM_INDEX, &column, &result_code);
+
+            if (result_code != EXIT_FN_RET_OK || column.null_value ||
+                room >= MAX_COL_LEN ||
+                (!column.value_truncated &&
+                 column.actual_value_length < column.max_value_length))
+                break;
+
+            /* The value may not have fitted: grow and fetch it again */
+            if (!exit_record_reserve (record, meta->num_columns,
+                                      record->data_used + MAX_COL_LEN + 1))
+            {
+                exit_log (EXIT_LOG_ERROR, "Error allocating the record of %s.\n",
+                          meta->table_name);
+                return EXIT_ABEND_VAL;
+            }
+        }
+
+        if (result_code != EXIT_FN_RET_OK &&
+            result_code != EXIT_FN_RET_COLUMN_NOT_FOUND)
+        {
+            exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving column value.\n",
+                      result_code);
+            return result_code;
+        }
+
+        record->offsets[i] = record->data_used;
+        if (result_code == EXIT_FN_RET_COLUMN_NOT_FOUND)
+        {
+            record->null_flags[i] = EXIT_RECORD_MISSING;
+            record->lengths[i] = 0;
+        }
+        else
+        if (column.null_value)
+        {
+            record->null_flags[i] = EXIT_RECORD_NULL;
+            record->lengths[i] = 0;
+        }
+        else
+        {
+            record->null_flags[i] = EXIT_RECORD_VALUE;
+            record->lengths[i] = column.actual_value_length;
+        }
+
+        record->data[record->data_used + record->lengths[i]] = '\0';
+        record->data_used += record->lengths[i] + 1;
+        record->num_columns = i + 1;
+    }
+
+    return EXIT_FN_RET_OK;
+}
+
+/***************************************************************************
+  Materialize the current record.  The current (fetched) record has the
+  target table's columns.
+***************************************************************************/
+short exit_record_load (exit_record *record, short source_or_target,
+                        short ascii_or_internal)
+{
+    short result_code;
+    table_meta *meta;
+
+    meta = current_table_metadata (source_or_target == EXIT_FN_CURRENT_VAL ?
+                                   EXIT_FN_TARGET_VAL : source_or_target,
+                                   &result_code);
+    if (!meta)
+        return result_code;
+
+    return exit_record_load_table (record, meta, source_or_target,
+                                   ascii_or_internal);
+}
+
+/***************************************************************************
+  Index of a column of a record view by name, -1 if there is none.
+***************************************************************************/
+short exit_record_column (const exit_record *record, const char *column_name)
+{
+    short i;
+
+    if (!record->meta)
+        return -1;
+    i = table_meta_column_index (record->meta, column_name);
+    return i < record->num_columns ? i : -1;
+}
+
+/***************************************************************************
+  Free the arrays and buffer of a record view.
+***************************************************************************/
+void exit_record_free (exit_record *record)
+{
+    free (record->offsets);
+    free (record->lengths);
+    free (record->null_flags);
+    free (record->data);
+    memset (record, 0, sizeof(exit_record));
+}
@@ -0,0 +1,90 @@
+/**************************************************************************
+  Program description:
+
+  Table metadata loading and one-pass record materialization for the user
+  exits.
+
+  find_table_metadata() and current_table_metadata() answer a table's
+  names, columns and key from the tablemeta.h cache, loading an entry
+  through the metadata callbacks the first time a table is seen.
+
+  exit_record_load() then reads every column of the current record with
+  one GET_COLUMN_VALUE_FROM_INDEX callback each, straight into one
+  contiguous buffer, and keeps a struct-of-arrays view of it: per column
+  index the offset of the value in the buffer, its length and whether it
+  is NULL or missing from the record.  Column names and types come from
+  the cached metadata.  Filters, transforms and writers then read any
+  column, any number of times, with pointer arithmetic:
+
+      exit_record_load (&record, EXIT_FN_SOURCE_VAL, EXIT_FN_ASCII_FORMAT);
+      for (i = 0; i < record.num_columns; i++)
+          if (!exit_record_is_null (&record, i))
+              use (exit_record_name (&record, i),
+                   exit_record_value (&record, i),
+                   exit_record_length (&record, i));
+
+  Each value is followed by a NUL, so ASCII values can be used as strings.
+  The view's arrays and buffer are kept and reused by the next load and
+  only grow, so a steady-state record allocates nothing.  A value longer
+  than the room left is fetched again after the buffer grows.  A view
+  refers to its table's cache entry, which a metadata event or DDL may
+  drop, so it describes the current record only.
+
+***************************************************************************/
+
+#ifndef EXITRECORD_H__
+#define EXITRECORD_H__
+
+#include <stddef.h>
+
+#include "tablemeta.h"
+
+/* null_flags of a column */
+#define EXIT_RECORD_VALUE   0       /* Column has a value */
+#define EXIT_RECORD_NULL    1       /* Column is NULL */
+#define EXIT_RECORD_MISSING 2       /* Column is not in the record */
+
+/* Initial size of a view's value buffer */
+#define EXIT_RECORD_INITIAL_DATA (64 * 1024)
+
+typedef struct
+{
+    table_meta *meta;           /* Table of the record, names by column index */
+    short source_or_target;     /* Source, target or current record */
+    short ascii_or_internal;    /* Format of the values */
+    short num_columns;          /* Columns in the view */
+    short max_columns;          /* Room in the arrays */
+    size_t *offsets;            /* Value of a column at data + offset */
+    unsigned short *lengths;    /* Value lengths */
+    char *null_flags;           /* EXIT_RECORD_VALUE, _NULL or _MISSING */
+    char *data;                 /* Values, each followed by a NUL */
+    size_t data_used;           /* Bytes of data in use */
+    size_t data_size;           /* Size of data */
+} exit_record;
+
+#define exit_record_value(record, i) \
+    ((record)->data + (record)->offsets[i])
+#define exit_record_length(record, i) ((record)->lengths[i])
+#define exit_record_is_null(record, i) \
+    ((record)->null_flags[i] != EXIT_RECORD_VALUE)
+#define exit_record_name(record, i) ((record)->meta->columns[i].name)
+
+table_meta *load_table_metadata (short source_or_target,
+                                 const char *table_name, size_t length,
+                                 short *result_code);
+table_meta *find_table_metadata (short source_or_target,
+                                 const char *table_name, size_t length,
+                                 short *result_code);
+table_meta *current_table_metadata (short source_or_target,
+                                    short *result_code);
+
+short exit_record_load (exit_record *record, short source_or_target,
+                        short ascii_or_internal);
+short exit_record_load_table (exit_record *record, table_meta *meta,
+                              short source_or_target,
+                              short ascii_or_internal);
+short exit_record_column (const exit_record *record,
+                          const char *column_name);
+void exit_record_free (exit_record *record);
+
+#endif /* EXITRECORD_H__ */
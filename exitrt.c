@@ -0,0 +1,450 @@
+/**************************************************************************
+  Program description:
+
+  Shared runtime of the user exits.  See exitrt.h.
+
+***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+/* The exit linking this library defines the version function */
+#define GOLDENGATE__
+#include "exitrt.h"
+#include "exittrace.h"
+#include "exitprof.h"
+
+#ifdef EXIT_TRACE_USDT
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+/* Probe semaphores, raised by the tracer while a probe is attached */
+#define EXIT_TRACE_SEMAPHORE(name) \
+    unsigned short ggexit_##name##_semaphore \
+        __attribute__ ((unused, section (".probes")))
+
+EXIT_TRACE_SEMAPHORE (exit_entry);
+EXIT_TRACE_SEMAPHORE (exit_return);
+EXIT_TRACE_SEMAPHORE (callback_entry);
+EXIT_TRACE_SEMAPHORE (callback_return);
+
+#define EXIT_TRACE_ENABLED(name) \
+    __builtin_expect (ggexit_##name##_semaphore != 0, 0)
+
+/* The exit call being timed for exit_return */
+static struct
+{
+    int timing;                 /* exit_return was attached at its start */
+    uint64_t start;             /* Clock at its start */
+    uint64_t callback_ns;       /* Time in its callbacks */
+    unsigned long callbacks;    /* Callbacks it made */
+    short io_type;              /* Operation type of its record, or -1 */
+    long record_bytes;          /* Length of its record */
+} trace_call;
+
+/***************************************************************************
+  Operation type and length in bytes of what a callback returned, for the
+  callback_return probe: the record of a record_def, a column value, a
+  name or a token, or the report message written.
+***************************************************************************/
+static void callback_payload (ercallback_function_codes function_code,
+                              void *buf, short *io_type, long *bytes)
+{
+    *io_type = -1;
+    *bytes = 0;
+    if (!buf)
+        return;
+
+    switch (function_code)
+    {
+        case GET_OPERATION_TYPE:
+        case GET_RECORD_BUFFER:
+        case GET_RECORD_LENGTH:
+        case SET_OPERATION_TYPE:
+        case SET_RECORD_BUFFER:
+            *io_type = ((record_def *)buf)->io_type;
+            *bytes = ((record_def *)buf)->length;
+            break;
+
+        case GET_COLUMN_VALUE_FROM_INDEX:
+        case GET_COLUMN_VALUE_FROM_NAME:
+        case SET_COLUMN_VALUE_BY_INDEX:
+        case SET_COLUMN_VALUE_BY_NAME:
+            *bytes = ((column_def *)buf)->actual_value_length;
+            break;
+
+        case GET_TABLE_NAME:
+        case GET_COLUMN_NAME_FROM_INDEX:
+        case GET_TABLE_NAME_ONLY:
+        case GET_SCHEMA_NAME_ONLY:
+        case GET_CATALOG_NAME_ONLY:
+        case GET_OBJECT_NAME_ONLY:
+        case GET_OBJECT_NAME:
+        case GET_BASE_OBJECT_NAME_ONLY:
+        case GET_BASE_SCHEMA_NAME_ONLY:
+        case GET_BASE_OBJECT_NAME:
+            *bytes = ((env_value_def *)buf)->actual_length;
+            break;
+
+        case GET_USER_TOKEN_VALUE:
+            *bytes = ((token_value_def *)buf)->actual_length;
+            break;
+
+        case OUTPUT_MESSAGE_TO_REPORT:
+            *bytes = (long)strlen ((char *)buf);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/***************************************************************************
+  Fire callback_return, and add the callback to the exit call being
+  timed.
+***************************************************************************/
+static void trace_callback_return (ercallback_function_codes function_code,
+                                   void *buf, short result_code,
+                                   uint64_t elapsed)
+{
+    short io_type;
+    long bytes;
+
+    callback_payload (function_code, buf, &io_type, &bytes);
+    if (trace_call.timing)
+    {
+        trace_call.callback_ns += elapsed;
+        trace_call.callbacks++;
+        if (io_type >= 0)
+        {
+            trace_call.io_type = io_type;
+            if (bytes)
+                trace_call.record_bytes = bytes;
+        }
+    }
+    DTRACE_PROBE5 (ggexit, callback_return, function_code, result_code,
+                   io_type, bytes, elapsed);
+}
+#endif
+
+/* ER callback routine */
+#ifndef WIN32
+void ERCALLBACK(ercallback_function_codes function_code,
+                void *buf, short *presult_code);
+#else
+typedef void (*FPERCALLBACK)(ercallback_function_codes function_code,
+                             void *buf, short *presult_code);
+
+HINSTANCE hEXE; /* EXE handle */
+FPERCALLBACK fp_ERCallback; /* Callback function pointer */
+
+/***************************************************************************
+  Open the ER callback function explicitly.
+***************************************************************************/
+short open_callback (char *executable_name,
+                     char *function_name)
+{
+    printf ("Opening callback for %s, %s.\n",
+            executable_name,
+            function_name);
+
+    hEXE = LoadLibrary (executable_name);
+    if (hEXE != NULL)
+    {
+        /* Function should always be exported in uppercase, since
+           GetProcAddress converts to uppercase then does a case-sensitive
+           search.  Don't use /NOIGNORE (/NOI) linker option. */
+        fp_ERCallback = (FPERCALLBACK)GetProcAddress(hEXE, function_name);
+
+        if (!fp_ERCallback)
+        {
+            FreeLibrary (hEXE);
+            return 0;
+        }
+    }
+    else
+        return 0;
+
+    return 1;
+}
+#endif
+
+/***************************************************************************
+  Close the callback function.
+***************************************************************************/
+void close_callback (void)
+{
+#ifdef WIN32
+    FreeLibrary (hEXE);
+#endif
+}
+
+/***************************************************************************
+  Call the callback function.
+***************************************************************************/
+void call_callback (ercallback_function_codes function_code,
+                    void *buf, short *result_code)
+{
+    uint64_t start = 0;
+    uint64_t elapsed;
+    int timed = exit_prof_enabled;
+#ifdef EXIT_TRACE_USDT
+    int traced = trace_call.timing || EXIT_TRACE_ENABLED (callback_return);
+
+    DTRACE_PROBE1 (ggexit, callback_entry, function_code);
+    timed = timed || traced;
+#endif
+
+    if (timed)
+        start = exit_prof_clock ();
+
+#ifdef WIN32
+    fp_ERCallback (function_code, buf, result_code);
+#else
+    ERCALLBACK (function_code, buf, result_code);
+#endif
+
+    if (!timed)
+        return;
+    elapsed = exit_prof_clock () - start;
+    if (exit_prof_enabled)
+        exit_prof_callback (function_code, buf, *result_code, elapsed);
+#ifdef EXIT_TRACE_USDT
+    if (traced)
+        trace_callback_return (function_code, buf, *result_code, elapsed);
+#endif
+}
+
+/***************************************************************************
+  Start of a call of the exit, for the tracepoints (exittrace.h) and the
+  profiler (exitprof.h).
+***************************************************************************/
+void exit_trace_call_begin (short exit_call_type)
+{
+    if (exit_prof_enabled)
+        exit_prof_call_begin ();
+
+#ifdef EXIT_TRACE_USDT
+    DTRACE_PROBE1 (ggexit, exit_entry, exit_call_type);
+
+    trace_call.timing = EXIT_TRACE_ENABLED (exit_return);
+    if (trace_call.timing)
+    {
+        trace_call.callback_ns = 0;
+        trace_call.callbacks = 0;
+        trace_call.io_type = -1;
+        trace_call.record_bytes = 0;
+        trace_call.start = exit_prof_clock ();
+    }
+#else
+    (void)exit_call_type;
+#endif
+}
+
+/***************************************************************************
+  End of a call of the exit, with the result it returns.
+***************************************************************************/
+void exit_trace_call_end (short exit_call_type, short result)
+{
+    if (exit_prof_enabled)
+        exit_prof_call_end (exit_call_type);
+
+#ifdef EXIT_TRACE_USDT
+    if (trace_call.timing)
+    {
+        DTRACE_PROBE7 (ggexit, exit_return, exit_call_type,
+                       trace_call.io_type, result, trace_call.record_bytes,
+                       exit_prof_clock () - trace_call.start,
+                       trace_call.callback_ns, trace_call.callbacks);
+        trace_call.timing = 0;
+    }
+#else
+    (void)result;
+#endif
+}
+
+/***************************************************************************
+  Write log text to the report file (or console).
+***************************************************************************/
+void report_message (char *text)
+{
+    short result_code;
+
+    call_callback (OUTPUT_MESSAGE_TO_REPORT, text, &result_code);
+}
+
+/***************************************************************************
+  Run time byte order test, for platforms exitrt.h does not know.
+***************************************************************************/
+int exit_rt_big_endian (void)
+{
+    short one = 1;
+
+    return *(char *)&one == 0;
+}
+
+/***************************************************************************
+  Test for Little Endian machine format.  Exits normally get the compile
+  time LittleEndian() macro of exitrt.h.
+***************************************************************************/
+short (LittleEndian) (void)
+{
+    return LittleEndian ();
+}
+
+/***************************************************************************
+  Reverse bytes for Little Endian/Big Endian
+***************************************************************************/
+void ReverseBytes (void *buf, short cnt)
+{
+    char *b = (char *)buf, *e = (char *)buf + cnt - 1;
+    char temp;
+    uint16_t value16;
+    uint32_t value32;
+    uint64_t value64;
+
+    switch (cnt)
+    {
+        case 2:
+            memcpy (&value16, buf, sizeof(value16));
+            value16 = exit_rt_bswap16 (value16);
+            memcpy (buf, &value16, sizeof(value16));
+            return;
+
+        case 4:
+            memcpy (&value32, buf, sizeof(value32));
+            value32 = exit_rt_bswap32 (value32);
+            memcpy (buf, &value32, sizeof(value32));
+            return;
+
+        case 8:
+            memcpy (&value64, buf, sizeof(value64));
+            value64 = exit_rt_bswap64 (value64);
+            memcpy (buf, &value64, sizeof(value64));
+            return;
+    }
+
+    for (; b < e; b++, e--)
+    {
+        temp = *b;
+        *b = *e;
+        *e = temp;
+    }
+}
+
+short IsPrint(int c)
+{
+    if (c != EOF) c = (unsigned char)c;
+    return isprint(c) ? 1 : 0;
+}
+
+static const char *sampling_names[] =
+{
+    "OFF", "CHECKPOINT", "TRANSACTION", "RECORD"
+};
+
+/***************************************************************************
+  Name of a position sampling granularity.
+***************************************************************************/
+const char *exit_position_sampling_name (short sampling)
+{
+    if (sampling < EXIT_POSITION_OFF || sampling > EXIT_POSITION_RECORD)
+        return "UNKNOWN";
+    return sampling_names[sampling];
+}
+
+/***************************************************************************
+  Read and decode one position, into a buffer on the stack.
+***************************************************************************/
+short exit_position_get (short position_type, exit_position *position)
+{
+    char buffer[sizeof(uint32_t) + sizeof(int32_t)];  /* seqno and rba */
+    position_def position_rec;
+    short result_code;
+
+    position_rec.position = buffer;
+    position_rec.position_len = sizeof(buffer);
+    position_rec.position_type = position_type;
+    position_rec.ascii_or_internal = EXIT_FN_INTERNAL_FORMAT;
+    call_callback (GET_POSITION, &position_rec, &result_code);
+    if (result_code == EXIT_FN_RET_OK)
+        exit_rt_read_position (&position_rec, &position->seqno,
+                               &position->rba);
+    return result_code;
+}
+
+/***************************************************************************
+  Take the sampling granularity from the environment variable
+  sampling_env, a granularity name or its number, else default_sampling.
+***************************************************************************/
+void exit_position_init (exit_position_sampler *sampler,
+                         const char *sampling_env, short default_sampling)
+{
+    const char *value = sampling_env ? getenv (sampling_env) : NULL;
+    short i;
+
+    memset (sampler, 0, sizeof(*sampler));
+    sampler->sampling = default_sampling;
+
+    if (value && *value)
+    {
+        if (isdigit ((unsigned char)*value))
+            sampler->sampling = (short)atoi (value);
+        else
+        {
+            for (i = EXIT_POSITION_OFF; i <= EXIT_POSITION_RECORD; i++)
+            {
+                const char *a = value;
+                const char *b = sampling_names[i];
+
+                while (*a && *b && toupper ((unsigned char)*a) == *b)
+                {
+                    a++;
+                    b++;
+                }
+                if (!*a && !*b)
+                {
+                    sampler->sampling = i;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (sampler->sampling < EXIT_POSITION_OFF)
+        sampler->sampling = EXIT_POSITION_OFF;
+    if (sampler->sampling > EXIT_POSITION_RECORD)
+        sampler->sampling = EXIT_POSITION_RECORD;
+}
+
+/***************************************************************************
+  Read and report the current checkpoint if the sampling is granularity
+  or finer, and the startup checkpoint at the first sample.  Returns 1 if
+  sampler->current was refreshed.
+***************************************************************************/
+short exit_position_sample (exit_position_sampler *sampler,
+                            short granularity)
+{
+    if (sampler->sampling < granularity)
+        return 0;
+
+    if (!sampler->have_startup)
+    {
+        sampler->have_startup = 1;
+        if (exit_position_get (STARTUP_CHECKPOINT,
+                               &sampler->startup) == EXIT_FN_RET_OK)
+            output_msg ("\nGET_POSITION STARTUP_CHECKPOINT, values seqno %lu rba %ld\n",
+                        (unsigned long) sampler->startup.seqno,
+                        (long) sampler->startup.rba);
+    }
+
+    if (exit_position_get (CURRENT_CHECKPOINT,
+                           &sampler->current) != EXIT_FN_RET_OK)
+        return 0;
+    sampler->have_current = 1;
+    output_msg ("\nGET_POSITION CURRENT_CHECKPOINT, values seqno %lu rba %ld\n",
+                (unsigned long) sampler->current.seqno,
+                (long) sampler->current.rba);
+    return 1;
+}
@@ -0,0 +1,241 @@
+/**************************************************************************
+  Program description:
+
+  Shared runtime of the user exits, built as the static library
+  libexitrt.a that every exit links against.
+
+  It holds the ER callback shim (call_callback, and open_callback and
+  close_callback for Windows), report output (output_msg, exitlog.h),
+  byte order helpers, the per-process caches and buffers (exitarena.h,
+  tablemeta.h) and the record view (exitrecord.h), so a change here
+  reaches every exit at its next build.
+
+  Byte order is selected at compile time where the compiler or platform
+  tells it, and byte swaps use the compiler's bswap intrinsics.  Each
+  ercallback_function_codes call has a typed inline wrapper returning the
+  callback result code, e.g.
+
+      result_code = exit_get_table_name (&env_value);
+
+  An exit includes this header instead of declaring the callback itself.
+  usrdecs.h defines the exit version function, so it must still be
+  included by exactly one file of each exit; the runtime's own sources
+  define GOLDENGATE__ to leave it out.
+
+***************************************************************************/
+
+#ifndef EXITRT_H__
+#define EXITRT_H__
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+#if defined(__MVS__)
+#include <inttypes.h>
+#else
+#include <stdint.h>
+#endif
+#include <string.h>
+
+#include "usrdecs.h"
+#include "exitlog.h"
+
+/* Inline helpers */
+#if defined(_MSC_VER)
+#define EXIT_RT_INLINE static __inline
+#elif defined(__GNUC__) || (defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L)
+#define EXIT_RT_INLINE static inline
+#else
+#define EXIT_RT_INLINE static
+#endif
+
+/* Byte order of the build target, 1 if big endian */
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__)
+#define EXIT_RT_BIG_ENDIAN (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#elif defined(_AIX) || defined(__hpux) || defined(__sparc) || \
+      defined(__sparc__) || defined(__MVS__)
+#define EXIT_RT_BIG_ENDIAN 1
+#elif defined(WIN32) || defined(_WIN32) || defined(__i386) || \
+      defined(__x86_64) || defined(__x86_64__) || defined(_M_X64)
+#define EXIT_RT_BIG_ENDIAN 0
+#else
+/* Unknown platform: test at run time */
+#define EXIT_RT_BIG_ENDIAN (exit_rt_big_endian ())
+#endif
+
+int exit_rt_big_endian (void);
+short (LittleEndian) (void);
+#define LittleEndian() ((short)!EXIT_RT_BIG_ENDIAN)
+
+/***************************************************************************
+  Byte swaps.
+***************************************************************************/
+EXIT_RT_INLINE uint16_t exit_rt_bswap16 (uint16_t value)
+{
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 8))
+    return __builtin_bswap16 (value);
+#elif defined(_MSC_VER)
+    return _byteswap_ushort (value);
+#else
+    return (uint16_t)((value << 8) | (value >> 8));
+#endif
+}
+
+EXIT_RT_INLINE uint32_t exit_rt_bswap32 (uint32_t value)
+{
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 3))
+    return __builtin_bswap32 (value);
+#elif defined(_MSC_VER)
+    return _byteswap_ulong (value);
+#else
+    return (value << 24) | ((value << 8) & 0x00ff0000u) |
+           ((value >> 8) & 0x0000ff00u) | (value >> 24);
+#endif
+}
+
+EXIT_RT_INLINE uint64_t exit_rt_bswap64 (uint64_t value)
+{
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 3))
+    return __builtin_bswap64 (value);
+#elif defined(_MSC_VER)
+    return _byteswap_uint64 (value);
+#else
+    return ((uint64_t)exit_rt_bswap32 ((uint32_t)value) << 32) |
+           exit_rt_bswap32 ((uint32_t)(value >> 32));
+#endif
+}
+
+/* Read a big endian (trail order) value from unaligned memory */
+EXIT_RT_INLINE uint32_t exit_rt_load_be32 (const void *buf)
+{
+    uint32_t value;
+
+    memcpy (&value, buf, sizeof(value));
+    return EXIT_RT_BIG_ENDIAN ? value : exit_rt_bswap32 (value);
+}
+
+/***************************************************************************
+  Sequence number and RBA of a GET_POSITION position, which holds both
+  big endian.
+***************************************************************************/
+EXIT_RT_INLINE void exit_rt_read_position (const position_def *position,
+                                           uint32_t *seqno, int32_t *rba)
+{
+    *seqno = exit_rt_load_be32 (position->position);
+    *rba = (int32_t)exit_rt_load_be32 (position->position + sizeof(uint32_t));
+}
+
+/***************************************************************************
+  Position sampling.  GET_POSITION is a callback per read, so an exit
+  reads the current checkpoint at the granularity it asks for and keeps
+  the last one decoded:
+
+      exit_position_init (&positions, "CUSEREXIT_POSITION",
+                          EXIT_POSITION_TRANSACTION);
+      ...
+      case EXIT_CALL_BEGIN_TRANS:
+          exit_position_sample (&positions, EXIT_POSITION_TRANSACTION);
+
+  The environment variable names the granularity (OFF, CHECKPOINT,
+  TRANSACTION or RECORD, or its number); each one also samples at the
+  coarser events.  The startup checkpoint does not move while the process
+  runs and is read once, at the first sample.  Nothing is allocated.
+***************************************************************************/
+#define EXIT_POSITION_OFF         0 /* No GET_POSITION calls */
+#define EXIT_POSITION_CHECKPOINT  1 /* At EXIT_CALL_CHECKPOINT */
+#define EXIT_POSITION_TRANSACTION 2 /* Also at EXIT_CALL_BEGIN_TRANS */
+#define EXIT_POSITION_RECORD      3 /* Also at every record */
+
+typedef struct
+{
+    uint32_t seqno;
+    int32_t rba;
+} exit_position;
+
+typedef struct
+{
+    short sampling;             /* EXIT_POSITION_OFF to _RECORD */
+    short have_startup;         /* startup has been read */
+    short have_current;         /* current has been read */
+    exit_position startup;      /* Startup checkpoint */
+    exit_position current;      /* Last current checkpoint sampled */
+} exit_position_sampler;
+
+short exit_position_get (short position_type, exit_position *position);
+void exit_position_init (exit_position_sampler *sampler,
+                         const char *sampling_env, short default_sampling);
+short exit_position_sample (exit_position_sampler *sampler,
+                            short granularity);
+const char *exit_position_sampling_name (short sampling);
+
+void ReverseBytes (void *buf, short cnt);
+short IsPrint (int c);
+
+/***************************************************************************
+  ER callback.
+***************************************************************************/
+#ifdef WIN32
+short open_callback (char *executable_name, char *function_name);
+#endif
+void close_callback (void);
+void call_callback (ercallback_function_codes function_code,
+                    void *buf, short *result_code);
+
+/* Typed wrapper for one callback function code */
+#define EXIT_RT_CALLBACK(name, function_code, type) \
+    EXIT_RT_INLINE short name (type *buf) \
+    { \
+        short result_code; \
+        call_callback (function_code, buf, &result_code); \
+        return result_code; \
+    }
+
+EXIT_RT_CALLBACK (exit_compress_record, COMPRESS_RECORD, compressed_rec_def)
+EXIT_RT_CALLBACK (exit_decompress_record, DECOMPRESS_RECORD, compressed_rec_def)
+EXIT_RT_CALLBACK (exit_get_before_after_ind, GET_BEFORE_AFTER_IND, record_def)
+EXIT_RT_CALLBACK (exit_get_column_index_from_name, GET_COLUMN_INDEX_FROM_NAME, env_value_def)
+EXIT_RT_CALLBACK (exit_get_column_name_from_index, GET_COLUMN_NAME_FROM_INDEX, env_value_def)
+EXIT_RT_CALLBACK (exit_get_column_value_from_index, GET_COLUMN_VALUE_FROM_INDEX, column_def)
+EXIT_RT_CALLBACK (exit_get_column_value_from_name, GET_COLUMN_VALUE_FROM_NAME, column_def)
+EXIT_RT_CALLBACK (exit_get_error_info, GET_ERROR_INFO, error_info_def)
+EXIT_RT_CALLBACK (exit_get_marker_info, GET_MARKER_INFO, marker_info_def)
+EXIT_RT_CALLBACK (exit_get_operation_type, GET_OPERATION_TYPE, record_def)
+EXIT_RT_CALLBACK (exit_get_record_buffer, GET_RECORD_BUFFER, record_def)
+EXIT_RT_CALLBACK (exit_get_record_length, GET_RECORD_LENGTH, record_def)
+EXIT_RT_CALLBACK (exit_get_record_type, GET_RECORD_TYPE, record_def)
+EXIT_RT_CALLBACK (exit_get_statistics, GET_STATISTICS, statistics_def)
+EXIT_RT_CALLBACK (exit_get_table_column_count, GET_TABLE_COLUMN_COUNT, table_def)
+EXIT_RT_CALLBACK (exit_get_table_name, GET_TABLE_NAME, env_value_def)
+EXIT_RT_CALLBACK (exit_get_timestamp, GET_TIMESTAMP, record_def)
+EXIT_RT_CALLBACK (exit_get_transaction_ind, GET_TRANSACTION_IND, record_def)
+EXIT_RT_CALLBACK (exit_set_column_value_by_index, SET_COLUMN_VALUE_BY_INDEX, column_def)
+EXIT_RT_CALLBACK (exit_set_column_value_by_name, SET_COLUMN_VALUE_BY_NAME, column_def)
+EXIT_RT_CALLBACK (exit_set_operation_type, SET_OPERATION_TYPE, record_def)
+EXIT_RT_CALLBACK (exit_set_record_buffer, SET_RECORD_BUFFER, record_def)
+EXIT_RT_CALLBACK (exit_set_table_name, SET_TABLE_NAME, record_def)
+EXIT_RT_CALLBACK (exit_fetch_current_record, FETCH_CURRENT_RECORD, error_info_def)
+EXIT_RT_CALLBACK (exit_fetch_current_record_with_lock, FETCH_CURRENT_RECORD_WITH_LOCK, error_info_def)
+EXIT_RT_CALLBACK (exit_output_message_to_report, OUTPUT_MESSAGE_TO_REPORT, char)
+EXIT_RT_CALLBACK (exit_get_col_metadata_from_index, GET_COL_METADATA_FROM_INDEX, col_metadata_def)
+EXIT_RT_CALLBACK (exit_get_col_metadata_from_name, GET_COL_METADATA_FROM_NAME, col_metadata_def)
+EXIT_RT_CALLBACK (exit_get_table_metadata, GET_TABLE_METADATA, table_metadata_def)
+EXIT_RT_CALLBACK (exit_get_position, GET_POSITION, position_def)
+EXIT_RT_CALLBACK (exit_get_user_token_value, GET_USER_TOKEN_VALUE, token_value_def)
+EXIT_RT_CALLBACK (exit_get_env_value, GET_ENV_VALUE, getenv_value_def)
+EXIT_RT_CALLBACK (exit_get_ddl_record_properties, GET_DDL_RECORD_PROPERTIES, ddl_record_def)
+EXIT_RT_CALLBACK (exit_reset_userexit_stats, RESET_USEREXIT_STATS, void)
+EXIT_RT_CALLBACK (exit_get_gmt_timestamp, GET_GMT_TIMESTAMP, record_def)
+EXIT_RT_CALLBACK (exit_set_session_charset, SET_SESSION_CHARSET, session_def)
+EXIT_RT_CALLBACK (exit_get_session_charset, GET_SESSION_CHARSET, session_def)
+EXIT_RT_CALLBACK (exit_get_database_metadata, GET_DATABASE_METADATA, database_defs)
+EXIT_RT_CALLBACK (exit_get_table_name_only, GET_TABLE_NAME_ONLY, env_value_def)
+EXIT_RT_CALLBACK (exit_get_schema_name_only, GET_SCHEMA_NAME_ONLY, env_value_def)
+EXIT_RT_CALLBACK (exit_get_catalog_name_only, GET_CATALOG_NAME_ONLY, env_value_def)
+EXIT_RT_CALLBACK (exit_get_object_name_only, GET_OBJECT_NAME_ONLY, env_value_def)
+EXIT_RT_CALLBACK (exit_get_object_name, GET_OBJECT_NAME, env_value_def)
+EXIT_RT_CALLBACK (exit_get_base_object_name_only, GET_BASE_OBJECT_NAME_ONLY, env_value_def)
+EXIT_RT_CALLBACK (exit_get_base_schema_name_only, GET_BASE_SCHEMA_NAME_ONLY, env_value_def)
+EXIT_RT_CALLBACK (exit_get_base_object_name, GET_BASE_OBJECT_NAME, env_value_def)
+EXIT_RT_CALLBACK (exit_get_event_record, GET_EVENT_RECORD, event_record_def)
+
+#endif /* EXITRT_H__ */
@@ -0,0 +1,223 @@
+/**************************************************************************
+  Program description:
+
+  Sampled record diagnostics for the user exits.  See exitsample.h.
+
+***************************************************************************/
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "exitsample.h"
+
+static const char *mode_names[] = { "ALL", "EVERY", "RESERVOIR", "FIRST" };
+
+/***************************************************************************
+  Case insensitive FNV-1a hash of a table name, as tablemeta.c keys it.
+***************************************************************************/
+static unsigned int name_hash (const char *name, size_t length)
+{
+    unsigned int hash = 2166136261u;
+    size_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char)toupper ((unsigned char)name[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int same_name (const char *a, const char *b, size_t length)
+{
+    size_t i;
+
+    for (i = 0; i < length; i++)
+        if (toupper ((unsigned char)a[i]) != toupper ((unsigned char)b[i]))
+            return 0;
+    return 1;
+}
+
+/***************************************************************************
+  Small xorshift generator for the reservoir draws.
+***************************************************************************/
+static unsigned long long next_random (unsigned long long *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/***************************************************************************
+  Name of a mode, for the startup report.
+***************************************************************************/
+const char *exit_sample_mode_name (short mode)
+{
+    if (mode < EXIT_SAMPLE_ALL || mode > EXIT_SAMPLE_FIRST)
+        return "UNKNOWN";
+    return mode_names[mode];
+}
+
+/***************************************************************************
+  Set the sampler up from the environment variable mode_env, see
+  exitsample.h.  An unknown mode or a count of 0 samples every record.
+***************************************************************************/
+void exit_sample_init (exit_sampler *sampler, const char *mode_env)
+{
+    const char *value = mode_env ? getenv (mode_env) : NULL;
+    char *end;
+    short i;
+
+    memset (sampler, 0, sizeof(*sampler));
+    sampler->mode = EXIT_SAMPLE_ALL;
+    sampler->window = EXIT_SAMPLE_WINDOW;
+    sampler->random_state = 0x9e3779b97f4a7c15ULL;
+
+    if (!value || !*value)
+        return;
+
+    for (i = EXIT_SAMPLE_EVERY; i <= EXIT_SAMPLE_FIRST; i++)
+    {
+        const char *a = value;
+        const char *b = mode_names[i];
+
+        while (*a && *a != ':' && *b && toupper ((unsigned char)*a) == *b)
+        {
+            a++;
+            b++;
+        }
+        if ((!*a || *a == ':') && !*b)
+        {
+            value = a;
+            sampler->mode = i;
+            break;
+        }
+    }
+    if (sampler->mode == EXIT_SAMPLE_ALL || *value++ != ':')
+    {
+        sampler->mode = EXIT_SAMPLE_ALL;
+        return;
+    }
+
+    sampler->n = strtoul (value, &end, 10);
+    if (sampler->mode == EXIT_SAMPLE_FIRST && *end == ':')
+        sampler->window = strtol (end + 1, NULL, 10);
+    if (!sampler->n || sampler->window <= 0)
+        sampler->mode = EXIT_SAMPLE_ALL;
+}
+
+/***************************************************************************
+  Counters of a table, added the first time the table is sampled.
+  Returns NULL on allocation failure.
+***************************************************************************/
+static exit_sample_table *find_table (exit_sampler *sampler,
+                                      const char *table_name, size_t length)
+{
+    exit_sample_table *table;
+    unsigned int hash;
+    size_t bucket;
+
+    if (!table_name)
+        return &sampler->unnamed;
+
+    hash = name_hash (table_name, length);
+    bucket = hash & (EXIT_SAMPLE_BUCKETS - 1);
+    for (table = sampler->tables[bucket]; table; table = table->next)
+        if (table->hash == hash && table->length == length &&
+            same_name (table->name, table_name, length))
+            return table;
+
+    table = (exit_sample_table *)calloc (1, sizeof(exit_sample_table));
+    if (!table)
+        return NULL;
+    table->name = (char *)malloc (length + 1);
+    if (!table->name)
+    {
+        free (table);
+        return NULL;
+    }
+    memcpy (table->name, table_name, length);
+    table->name[length] = '\0';
+    table->length = length;
+    table->hash = hash;
+    table->next = sampler->tables[bucket];
+    sampler->tables[bucket] = table;
+    return table;
+}
+
+/***************************************************************************
+  Decide whether the current record of a table gets its diagnostics.
+  The name is only read in the per table modes.  A table whose counters
+  cannot be allocated is not sampled.
+***************************************************************************/
+int exit_sample_take (exit_sampler *sampler, const char *table_name,
+                      size_t length)
+{
+    exit_sample_table *table;
+    time_t now;
+    int take;
+
+    sampler->seen++;
+
+    switch (sampler->mode)
+    {
+        case EXIT_SAMPLE_EVERY:
+            take = (sampler->seen - 1) % sampler->n == 0;
+            break;
+
+        case EXIT_SAMPLE_RESERVOIR:
+            table = find_table (sampler, table_name, length);
+            if (!table)
+                return 0;
+            table->seen++;
+            take = table->seen <= sampler->n ||
+                   next_random (&sampler->random_state) % table->seen <
+                   sampler->n;
+            break;
+
+        case EXIT_SAMPLE_FIRST:
+            table = find_table (sampler, table_name, length);
+            if (!table)
+                return 0;
+            now = time (NULL);
+            if (!table->seen || now - table->window_start >= sampler->window)
+            {
+                table->window_start = now;
+                table->seen = 0;
+            }
+            table->seen++;
+            take = table->seen <= sampler->n;
+            break;
+
+        default:
+            take = 1;
+            break;
+    }
+
+    if (take)
+        sampler->taken++;
+    return take;
+}
+
+/***************************************************************************
+  Release the per table counters, called at EXIT_CALL_STOP.
+***************************************************************************/
+void exit_sample_free (exit_sampler *sampler)
+{
+    exit_sample_table *table;
+    exit_sample_table *next;
+    size_t i;
+
+    for (i = 0; i < EXIT_SAMPLE_BUCKETS; i++)
+    {
+        for (table = sampler->tables[i]; table; table = next)
+        {
+            next = table->next;
+            free (table->name);
+            free (table);
+        }
+        sampler->tables[i] = NULL;
+    }
+}
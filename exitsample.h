@@ -0,0 +1,89 @@
+/**************************************************************************
+  Program description:
+
+  Sampled record diagnostics for the user exits.
+
+  Dumping every column of every record to the report cannot be left on
+  under production load.  A sampler decides which records get their
+  diagnostics, so an exit keeps record level visibility at a bounded
+  cost:
+
+      ALL                    every record (the default)
+      EVERY:<n>              one record in n
+      RESERVOIR:<k>          per table, a uniform reservoir of k records
+      FIRST:<k>[:<seconds>]  per table, the first k records of every
+                             window, an hour by default
+
+  The mode is read from an environment variable at EXIT_CALL_START, the
+  name case insensitive:
+
+      exit_sample_init (&samples, "CUSEREXIT_SAMPLE");
+      ...
+      if (exit_sample_take (&samples, meta->table_name, meta->name_length))
+          display_record (...);
+
+  EVERY needs no table name; the other modes keep a counter per table
+  name, so an exit looks the name up only when exit_sample_by_table()
+  says so.  A NULL name counts as one stream of its own, e.g. for DDL.
+
+  A report can only show records as they go by, so RESERVOIR shows each
+  record at the moment it enters the reservoir of algorithm R: the first
+  k of a table, then record i with probability k/i.  About
+  k * (1 + ln(n/k)) of n records are shown, and the last reservoir is a
+  uniform sample of the table.
+
+  The sampler only bounds the records dumped; exit_log_rate_limit() in
+  exitlog.h bounds the report bytes per second on top of it.
+
+***************************************************************************/
+
+#ifndef EXITSAMPLE_H__
+#define EXITSAMPLE_H__
+
+#include <stddef.h>
+#include <time.h>
+
+#define EXIT_SAMPLE_ALL       0
+#define EXIT_SAMPLE_EVERY     1
+#define EXIT_SAMPLE_RESERVOIR 2
+#define EXIT_SAMPLE_FIRST     3
+
+/* FIRST window when the mode gives none, in seconds */
+#define EXIT_SAMPLE_WINDOW 3600
+
+/* Hash buckets of the per table counters, a power of two */
+#define EXIT_SAMPLE_BUCKETS 256
+
+typedef struct exit_sample_table
+{
+    char *name;                 /* Table name, NULL for the unnamed stream */
+    size_t length;              /* Length of name */
+    unsigned int hash;          /* Hash of name */
+    unsigned long seen;         /* Records seen, in this window for FIRST */
+    time_t window_start;        /* Start of the FIRST window */
+    struct exit_sample_table *next;
+} exit_sample_table;
+
+typedef struct
+{
+    short mode;                 /* EXIT_SAMPLE_ALL, _EVERY, ... */
+    unsigned long n;            /* n of EVERY, k of RESERVOIR and FIRST */
+    long window;                /* FIRST window in seconds */
+    unsigned long long random_state;
+    unsigned long seen;         /* Records offered */
+    unsigned long taken;        /* Records sampled */
+    exit_sample_table unnamed;  /* Records without a table name */
+    exit_sample_table *tables[EXIT_SAMPLE_BUCKETS];
+} exit_sampler;
+
+#define exit_sample_by_table(sampler) \
+    ((sampler)->mode == EXIT_SAMPLE_RESERVOIR || \
+     (sampler)->mode == EXIT_SAMPLE_FIRST)
+
+void exit_sample_init (exit_sampler *sampler, const char *mode_env);
+int exit_sample_take (exit_sampler *sampler, const char *table_name,
+                      size_t length);
+const char *exit_sample_mode_name (short mode);
+void exit_sample_free (exit_sampler *sampler);
+
+#endif /* EXITSAMPLE_H__ */
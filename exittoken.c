@@ -0,0 +1,164 @@
+/**************************************************************************
+  Program description:
+
+  User token cache for the user exits.  See exittoken.h.
+
+***************************************************************************/
+
+#include <string.h>
+
+/* The exit linking this library defines the version function */
+#define GOLDENGATE__
+#include "exitrt.h"
+#include "exittoken.h"
+
+/***************************************************************************
+  Fetch the value of a token of the current record into the value area at
+  offset.  Returns the offset after the value.
+***************************************************************************/
+static size_t fetch_token (exit_token_cache *cache, exit_token *token,
+                           size_t offset)
+{
+    token_value_def token_value;
+    size_t room = EXIT_TOKEN_VALUES - offset;
+    short result_code;
+
+    token->offset = offset;
+    token->truncated = 0;
+    if (room < 2)
+    {
+        /* Out of room, an empty value */
+        cache->values[offset] = '\0';
+        token->length = 0;
+        token->truncated = 1;
+        return offset;
+    }
+
+    memset (&token_value, 0, sizeof(token_value_def));
+    token_value.token_name = token->name;
+    token_value.token_value = cache->values + offset;
+    token_value.max_length = (long)room;
+    result_code = exit_get_user_token_value (&token_value);
+    cache->num_fetches++;
+
+    if (result_code != EXIT_FN_RET_OK || token_value.actual_length < 0)
+    {
+        cache->values[offset] = '\0';
+        token->length = -1;
+        return offset;
+    }
+
+    token->length = token_value.actual_length;
+    if (token->length > (long)room - 1)
+        token->length = (long)room - 1;
+    token->truncated = token_value.value_truncated ||
+                       token->length < token_value.actual_length;
+    cache->values[offset + token->length] = '\0';
+    return offset + token->length + 1;
+}
+
+/***************************************************************************
+  Fetch every declared token of the current record, once per transaction.
+***************************************************************************/
+static void load_tokens (exit_token_cache *cache)
+{
+    size_t offset = 0;
+    short i;
+
+    for (i = 0; i < cache->num_tokens; i++)
+        offset = fetch_token (cache, &cache->tokens[i], offset);
+    cache->loaded = 1;
+}
+
+/***************************************************************************
+  Declare a token the exit reads, called at EXIT_CALL_START.  Returns its
+  index, or -1 if the name is too long or the cache is full.
+***************************************************************************/
+short exit_token_declare (exit_token_cache *cache, const char *name)
+{
+    short index = exit_token_index (cache, name);
+    exit_token *token;
+
+    if (index >= 0)
+        return index;
+    if (cache->num_tokens == EXIT_TOKEN_MAX ||
+        strlen (name) > EXIT_TOKEN_NAME_MAX)
+        return -1;
+
+    token = &cache->tokens[cache->num_tokens];
+    memset (token, 0, sizeof(exit_token));
+    strcpy (token->name, name);
+    token->length = -1;
+    cache->loaded = 0;
+    return cache->num_tokens++;
+}
+
+/***************************************************************************
+  Index of a declared token, -1 if it was not declared.
+***************************************************************************/
+short exit_token_index (const exit_token_cache *cache, const char *name)
+{
+    short i;
+
+    for (i = 0; i < cache->num_tokens; i++)
+        if (!strcmp (cache->tokens[i].name, name))
+            return i;
+    return -1;
+}
+
+/***************************************************************************
+  Start a transaction, at EXIT_CALL_BEGIN_TRANS.  Its first lookup fetches
+  the tokens.
+***************************************************************************/
+void exit_token_begin (exit_token_cache *cache)
+{
+    cache->in_transaction = 1;
+    cache->loaded = 0;
+}
+
+/***************************************************************************
+  End the transaction, at EXIT_CALL_END_TRANS or EXIT_CALL_ABORT_TRANS.
+***************************************************************************/
+void exit_token_end (exit_token_cache *cache)
+{
+    cache->in_transaction = 0;
+    cache->loaded = 0;
+}
+
+/***************************************************************************
+  Value of a declared token in the current transaction, NUL terminated,
+  with its length in *length if not NULL.  Returns NULL if the record
+  has no such token.  Outside a transaction the value is valid until the
+  next lookup.
+***************************************************************************/
+const char *exit_token_value (exit_token_cache *cache, short index,
+                              long *length)
+{
+    exit_token *token;
+
+    if (index < 0 || index >= cache->num_tokens)
+        return NULL;
+    token = &cache->tokens[index];
+    cache->num_lookups++;
+
+    if (!cache->in_transaction)
+    {
+        cache->loaded = 0;
+        fetch_token (cache, token, 0);
+    }
+    else if (!cache->loaded)
+        load_tokens (cache);
+
+    if (length)
+        *length = token->length;
+    return token->length < 0 ? NULL : cache->values + token->offset;
+}
+
+/***************************************************************************
+  Value of a declared token by name, see exit_token_value().
+***************************************************************************/
+const char *exit_token_get (exit_token_cache *cache, const char *name,
+                            long *length)
+{
+    return exit_token_value (cache, exit_token_index (cache, name), length);
+}
@@ -0,0 +1,78 @@
+/**************************************************************************
+  Program description:
+
+  User token cache for the user exits.
+
+  User tokens set by an earlier Extract (the host name, the source
+  database, a batch id) are usually the same for every record of a
+  transaction.  Rather than building a token_value_def and calling
+  GET_USER_TOKEN_VALUE for every record, an exit declares the tokens it
+  reads at EXIT_CALL_START.  The first lookup inside a transaction
+  fetches every declared token once, into a fixed value area in the
+  cache, and the other lookups of the transaction read them from there
+  without a callback or an allocation:
+
+      exit_token_declare (&tokens, "TK-HOST");
+      ...
+      case EXIT_CALL_BEGIN_TRANS:
+          exit_token_begin (&tokens);
+      case EXIT_CALL_PROCESS_RECORD:
+          host = exit_token_get (&tokens, "TK-HOST", &length);
+      case EXIT_CALL_END_TRANS:
+      case EXIT_CALL_ABORT_TRANS:
+          exit_token_end (&tokens);
+
+  exit_token_index() turns a name into an index once, for callers that
+  look a token up on every record with exit_token_value().  A lookup
+  outside a transaction fetches that one token from the current record
+  every time.
+
+  A value is NUL terminated.  The values of a transaction share
+  EXIT_TOKEN_VALUES bytes; a value that does not fit is truncated and
+  flagged.
+
+***************************************************************************/
+
+#ifndef EXITTOKEN_H__
+#define EXITTOKEN_H__
+
+#include <stddef.h>
+
+/* Tokens one cache can declare */
+#define EXIT_TOKEN_MAX 16
+
+/* Longest token name */
+#define EXIT_TOKEN_NAME_MAX 64
+
+/* Room for the values of a transaction */
+#define EXIT_TOKEN_VALUES 4096
+
+typedef struct
+{
+    char name[EXIT_TOKEN_NAME_MAX + 1];
+    size_t offset;              /* Value at values + offset */
+    long length;                /* Value length, -1 if not in the record */
+    short truncated;            /* Value did not fit */
+} exit_token;
+
+typedef struct
+{
+    short num_tokens;           /* Declared tokens */
+    short in_transaction;       /* Between BEGIN_TRANS and END_TRANS */
+    short loaded;               /* Values are of the current transaction */
+    unsigned long num_fetches;  /* GET_USER_TOKEN_VALUE calls */
+    unsigned long num_lookups;  /* Tokens looked up */
+    exit_token tokens[EXIT_TOKEN_MAX];
+    char values[EXIT_TOKEN_VALUES];
+} exit_token_cache;
+
+short exit_token_declare (exit_token_cache *cache, const char *name);
+short exit_token_index (const exit_token_cache *cache, const char *name);
+void exit_token_begin (exit_token_cache *cache);
+void exit_token_end (exit_token_cache *cache);
+const char *exit_token_value (exit_token_cache *cache, short index,
+                              long *length);
+const char *exit_token_get (exit_token_cache *cache, const char *name,
+                            long *length);
+
+#endif /* EXITTOKEN_H__ */
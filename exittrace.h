@@ -0,0 +1,52 @@
+/**************************************************************************
+  Program description:
+
+  Static tracepoints in the user exits.
+
+  Where the platform has <sys/sdt.h> (Linux with the SystemTap SDT
+  headers) the runtime carries USDT probes of provider ggexit, which
+  perf, bpftrace and SystemTap can attach to in a running Extract or
+  Replicat without a rebuild:
+
+      exit_entry       (exit_call_type)
+      exit_return      (exit_call_type, io_type, result, record_bytes,
+                        elapsed_ns, callback_ns, callbacks)
+      callback_entry   (function_code)
+      callback_return  (function_code, result_code, io_type, bytes,
+                        elapsed_ns)
+
+  exit_return is fired when the exit returns from a call; io_type and
+  record_bytes are those of the last record_def callback of the call, -1
+  and 0 if there was none.  callback_ns and callbacks add up the
+  callback round trips of the call, so elapsed_ns - callback_ns is the
+  time spent in the exit itself.  bytes is the length of the value, name
+  or record a callback returned, or of the report message it wrote.
+
+      bpftrace -e 'usdt:./modified_exitdemo.so:ggexit:callback_return
+                   { @ns[arg0] = hist(arg4); }'
+
+  Each probe has a semaphore the tracer raises while it is attached; the
+  clock is only read and the payload only computed then, so an idle
+  probe costs a nop and a test of its semaphore.
+
+  The exported exit function wraps its body between
+  exit_trace_call_begin() and exit_trace_call_end(), which cover every
+  return path; they also time the call for the profiler of exitprof.h.
+  Elsewhere, or built with -DEXIT_TRACE_NONE, the probes are left out.
+
+***************************************************************************/
+
+#ifndef EXITTRACE_H__
+#define EXITTRACE_H__
+
+#if !defined(EXIT_TRACE_NONE) && !defined(EXIT_TRACE_USDT) && \
+    defined(__linux__) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define EXIT_TRACE_USDT 1
+#endif
+#endif
+
+void exit_trace_call_begin (short exit_call_type);
+void exit_trace_call_end (short exit_call_type, short result);
+
+#endif /* EXITTRACE_H__ */
@@ -0,0 +1,216 @@
+/**************************************************************************
+  Program description:
+
+  Transaction buffer for the user exits.  See exittxn.h.
+
+***************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "exittxn.h"
+
+/***************************************************************************
+  Make room for a record of size bytes in the buffer used to write and
+  read back spilled records.  Returns 0 on allocation failure.
+***************************************************************************/
+static int reserve_buffer (exit_txn *txn, size_t size)
+{
+    exit_txn_record *buffer;
+
+    if (size <= txn->read_size)
+        return 1;
+    buffer = (exit_txn_record *)realloc (txn->read_buffer, size);
+    if (!buffer)
+        return 0;
+    txn->read_buffer = buffer;
+    txn->read_size = size;
+    return 1;
+}
+
+/***************************************************************************
+  Copy a record view into the block stored, of size bytes.
+***************************************************************************/
+static void store_record (exit_txn_record *stored, size_t size,
+                          const exit_record *record, short io_type)
+{
+    size_t *offsets = (size_t *)(stored + 1);
+    unsigned short *lengths;
+    char *null_flags;
+    char *table_name;
+    size_t offset;
+    short i;
+
+    stored->size = size;
+    stored->io_type = io_type;
+    stored->source_or_target = record->source_or_target;
+    stored->num_columns = record->num_columns;
+    stored->table_length = record->meta ? (short)record->meta->name_length : 0;
+
+    lengths = (unsigned short *)(offsets + record->num_columns);
+    null_flags = (char *)(lengths + record->num_columns);
+    table_name = null_flags + record->num_columns;
+
+    memcpy (lengths, record->lengths,
+            record->num_columns * sizeof(unsigned short));
+    memcpy (null_flags, record->null_flags, record->num_columns);
+    if (stored->table_length)
+        memcpy (table_name, record->meta->table_name, stored->table_length);
+    table_name[stored->table_length] = '\0';
+
+    offset = (size_t)(table_name - (char *)stored) + stored->table_length + 1;
+    for (i = 0; i < record->num_columns; i++)
+    {
+        offsets[i] = offset;
+        memcpy ((char *)stored + offset, exit_record_value (record, i),
+                record->lengths[i]);
+        offset += record->lengths[i];
+        ((char *)stored)[offset++] = '\0';
+    }
+}
+
+/***************************************************************************
+  Set up the transaction buffer with a memory budget in bytes, or
+  EXIT_TXN_BUDGET if 0, called at EXIT_CALL_START.  Returns 0 on
+  allocation failure.
+***************************************************************************/
+int exit_txn_init (exit_txn *txn, size_t budget)
+{
+    txn->budget = budget ? budget : EXIT_TXN_BUDGET;
+    return exit_arena_init (&txn->arena,
+                            txn->budget < EXIT_TXN_INITIAL_ARENA ?
+                            txn->budget : EXIT_TXN_INITIAL_ARENA);
+}
+
+/***************************************************************************
+  Add a copy of a record view to the current transaction, in memory
+  while the transaction is within its budget, else in the spill file.
+  Returns 0 on allocation or write failure.
+***************************************************************************/
+int exit_txn_add (exit_txn *txn, const exit_record *record, short io_type)
+{
+    exit_txn_record *stored;
+    exit_txn_record **records;
+    size_t size;
+    short i;
+
+    size = sizeof(exit_txn_record) +
+           record->num_columns * (sizeof(size_t) + sizeof(unsigned short) + 1) +
+           (record->meta ? record->meta->name_length : 0) + 1;
+    for (i = 0; i < record->num_columns; i++)
+        size += record->lengths[i] + 1;
+
+    /* Over budget, this and the rest of the transaction go to disk so
+       the records stay in order */
+    if (txn->num_spilled || txn->memory_used + size > txn->budget)
+    {
+        if (!txn->spill)
+        {
+            txn->spill = tmpfile ();
+            if (!txn->spill)
+                return 0;
+        }
+        if (!reserve_buffer (txn, size))
+            return 0;
+        store_record (txn->read_buffer, size, record, io_type);
+        if (fwrite (txn->read_buffer, size, 1, txn->spill) != 1)
+            return 0;
+        txn->num_spilled++;
+        txn->spill_used += size;
+        return 1;
+    }
+
+    if (txn->num_records == txn->max_records)
+    {
+        size_t max_records = txn->max_records ? txn->max_records * 2 : 256;
+
+        records = (exit_txn_record **)realloc (txn->records,
+                                               max_records * sizeof(*records));
+        if (!records)
+            return 0;
+        txn->records = records;
+        txn->max_records = max_records;
+    }
+
+    stored = (exit_txn_record *)exit_arena_alloc (&txn->arena, size);
+    if (!stored)
+        return 0;
+    store_record (stored, size, record, io_type);
+    txn->records[txn->num_records++] = stored;
+    txn->memory_used += size;
+    return 1;
+}
+
+/***************************************************************************
+  Hand every record of the transaction to stage, in order, reading the
+  spilled ones back one at a time.  A record passed to stage is valid
+  during the call only.  Returns 0 if stage returns 0 or the spill file
+  cannot be read.
+***************************************************************************/
+int exit_txn_for_each (exit_txn *txn, exit_txn_stage stage, void *context)
+{
+    exit_txn_record header;
+    size_t i;
+
+    if (exit_txn_count (txn))
+    {
+        txn->num_transactions++;
+        if (txn->num_spilled)
+            txn->num_spilled_transactions++;
+    }
+
+    for (i = 0; i < txn->num_records; i++)
+        if (!stage (txn->records[i], context))
+            return 0;
+
+    if (!txn->num_spilled)
+        return 1;
+
+    if (fflush (txn->spill) || fseek (txn->spill, 0L, SEEK_SET))
+        return 0;
+    for (i = 0; i < txn->num_spilled; i++)
+    {
+        if (fread (&header, sizeof(header), 1, txn->spill) != 1 ||
+            header.size < sizeof(header) ||
+            !reserve_buffer (txn, header.size))
+            return 0;
+        *txn->read_buffer = header;
+        if (header.size > sizeof(header) &&
+            fread (txn->read_buffer + 1, header.size - sizeof(header), 1,
+                   txn->spill) != 1)
+            return 0;
+        if (!stage (txn->read_buffer, context))
+            return 0;
+    }
+    return 1;
+}
+
+/***************************************************************************
+  Drop the records of the transaction, at EXIT_CALL_END_TRANS once they
+  are processed or at EXIT_CALL_ABORT_TRANS.  The arena and spill file
+  are kept for the next transaction.
+***************************************************************************/
+void exit_txn_reset (exit_txn *txn)
+{
+    exit_arena_reset (&txn->arena);
+    txn->num_records = 0;
+    txn->memory_used = 0;
+    if (txn->spill)
+        fseek (txn->spill, 0L, SEEK_SET);
+    txn->num_spilled = 0;
+    txn->spill_used = 0;
+}
+
+/***************************************************************************
+  Release the transaction buffer, called at EXIT_CALL_STOP.  The spill
+  file is removed when closed.
+***************************************************************************/
+void exit_txn_release (exit_txn *txn)
+{
+    exit_arena_release (&txn->arena);
+    free (txn->records);
+    free (txn->read_buffer);
+    if (txn->spill)
+        fclose (txn->spill);
+    memset (txn, 0, sizeof(exit_txn));
+}
@@ -0,0 +1,100 @@
+/**************************************************************************
+  Program description:
+
+  Transaction buffer for the user exits.
+
+  Between EXIT_CALL_BEGIN_TRANS and EXIT_CALL_END_TRANS an exit adds the
+  records it accepts, each as a materialized record view (exitrecord.h),
+  and at EXIT_CALL_END_TRANS hands the whole transaction to a processing
+  stage, which sees the records in order:
+
+      exit_txn_add (&txn, &record_view, record->io_type);
+      ...
+      case EXIT_CALL_END_TRANS:
+          exit_txn_for_each (&txn, stage, context);
+          exit_txn_reset (&txn);
+
+  A stage can then write the transaction as one batch, or merge the
+  changes of a row, instead of doing I/O per record.
+  EXIT_CALL_ABORT_TRANS drops the buffered records with exit_txn_reset().
+
+  Each record is copied into one block: an exit_txn_record header, the
+  column offsets, lengths and null flags, the table name and the values,
+  each followed by a NUL.  Blocks come from a transaction arena that is
+  rewound when the transaction ends, so the arena settles at the size of
+  the largest transaction.  Once a transaction holds more than its memory
+  budget, it and all its later records go to an unnamed temporary file,
+  which is read back one record at a time by exit_txn_for_each().
+
+  Like exitarena.c this does not include usrdecs.h.
+
+***************************************************************************/
+
+#ifndef EXITTXN_H__
+#define EXITTXN_H__
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "exitarena.h"
+#include "exitrecord.h"
+
+/* Default bytes of records held in memory per transaction */
+#define EXIT_TXN_BUDGET (16 * 1024 * 1024)
+
+/* Initial size of the transaction arena */
+#define EXIT_TXN_INITIAL_ARENA (256 * 1024)
+
+/* One buffered record, followed by its columns, table name and values */
+typedef struct
+{
+    size_t size;                /* Bytes of the block, header included */
+    short io_type;              /* Operation type of the record */
+    short source_or_target;     /* Source or target record */
+    short num_columns;          /* Columns of the record */
+    short table_length;         /* Length of the table name */
+} exit_txn_record;
+
+#define exit_txn_record_offsets(r) ((const size_t *)((r) + 1))
+#define exit_txn_record_lengths(r) \
+    ((const unsigned short *)(exit_txn_record_offsets (r) + (r)->num_columns))
+#define exit_txn_record_null_flags(r) \
+    ((const char *)(exit_txn_record_lengths (r) + (r)->num_columns))
+#define exit_txn_record_table_name(r) \
+    (exit_txn_record_null_flags (r) + (r)->num_columns)
+#define exit_txn_record_value(r, i) \
+    ((const char *)(r) + exit_txn_record_offsets (r)[i])
+#define exit_txn_record_length(r, i) (exit_txn_record_lengths (r)[i])
+#define exit_txn_record_is_null(r, i) \
+    (exit_txn_record_null_flags (r)[i] != EXIT_RECORD_VALUE)
+
+typedef struct
+{
+    size_t budget;              /* Bytes held in memory before spilling */
+    exit_arena arena;           /* Records held in memory */
+    exit_txn_record **records;  /* Records in memory, in order */
+    size_t num_records;         /* Records in memory */
+    size_t max_records;         /* Room in records */
+    size_t memory_used;         /* Bytes of the records in memory */
+    FILE *spill;                /* Spill file, kept between transactions */
+    size_t num_spilled;         /* Records in the spill file */
+    size_t spill_used;          /* Bytes written to the spill file */
+    exit_txn_record *read_buffer; /* A spilled record read back */
+    size_t read_size;           /* Size of read_buffer */
+    size_t num_transactions;    /* Transactions ended with records */
+    size_t num_spilled_transactions; /* Of them, those that spilled */
+} exit_txn;
+
+/* Processing stage, returns 0 to stop with an error */
+typedef int (*exit_txn_stage) (const exit_txn_record *record,
+                               void *context);
+
+int exit_txn_init (exit_txn *txn, size_t budget);
+int exit_txn_add (exit_txn *txn, const exit_record *record, short io_type);
+int exit_txn_for_each (exit_txn *txn, exit_txn_stage stage, void *context);
+void exit_txn_reset (exit_txn *txn);
+void exit_txn_release (exit_txn *txn);
+
+#define exit_txn_count(txn) ((txn)->num_records + (txn)->num_spilled)
+
+#endif /* EXITTXN_H__ */
@@ -0,0 +1,587 @@
+/**************************************************************************
+  Program description:
+
+  Asynchronous side output for the user exits.  See exitwriter.h.
+
+  The ring holds entries of an 8 byte header, giving the length, and the
+  bytes, padded to 8.  An entry never wraps: when it does not fit before
+  the end of the ring, a WRAP header sends the reader back to the start,
+  and a RECORD header with no bytes marks the end of a record.
+  head and tail count bytes from the start of the run and are masked
+  into the ring.  A side that finds the ring full or empty sleeps on a
+  condition variable, after raising its waiting flag for the other side
+  to see; the sleep is timed, so a missed wake-up only costs the timeout.
+
+***************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(WIN32) || defined(__TANDEM)
+#define EXIT_WRITER_SYNC
+#else
+#include <pthread.h>
+#include <signal.h>
+#include <sys/time.h>
+#endif
+
+#include "exitwriter.h"
+
+/* Entries are aligned on this, and it is the size of an entry header */
+#define ENTRY_ALIGN 8
+
+/* Header of an entry that sends the reader back to the ring start */
+#define ENTRY_WRAP 0xFFFFFFFFU
+
+/* Header of an entry that marks the end of a record */
+#define ENTRY_RECORD 0xFFFFFFFEU
+
+#define ENTRY_SIZE(length) \
+    ((ENTRY_ALIGN + (length) + ENTRY_ALIGN - 1) & ~(size_t)(ENTRY_ALIGN - 1))
+
+/* Smallest ring */
+#define MIN_RING (64 * 1024)
+
+/* stdio buffer of the output file */
+#define FILE_BUFFER (64 * 1024)
+
+/* Longest sleep of a side waiting for the other, in milliseconds */
+#define WAIT_MS 50
+
+struct exit_writer
+{
+    char *path;                 /* Output file */
+    char *rotate_path;          /* Room for <path>.<n> */
+    FILE *file;
+    long rotate_bytes;          /* Rotate at this size, 0 never */
+    long file_bytes;            /* Bytes in the current file */
+    unsigned long rotations;    /* Files rotated out */
+    int error;                  /* errno of a failed write, 0 if none */
+    char *ring;
+    size_t ring_size;           /* A power of two */
+    size_t max_entry;           /* Longest reservation */
+    size_t reserved;            /* Length of the open reservation */
+    size_t head;                /* Bytes produced, moved by the exit */
+    size_t tail;                /* Bytes consumed, moved by the writer */
+#ifndef EXIT_WRITER_SYNC
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;        /* Data, a sync request or stop */
+    pthread_cond_t done;        /* Room in the ring or a sync done */
+    int writer_waiting;         /* Writer sleeps on wake */
+    int exit_waiting;           /* Exit sleeps on done */
+    int stopping;               /* Drain and stop */
+    size_t sync_request;        /* Sync everything before this head */
+    size_t synced;              /* Everything before this is on disk */
+#endif
+};
+
+/* Positions, flags and the error shared by the two threads */
+#if defined(EXIT_WRITER_SYNC)
+#define LOAD(p) (*(p))
+#define STORE(p, v) (*(p) = (v))
+#elif defined(__GNUC__) && \
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+#define LOAD(p) __atomic_load_n (p, __ATOMIC_SEQ_CST)
+#define STORE(p, v) __atomic_store_n (p, v, __ATOMIC_SEQ_CST)
+#else
+/* Without atomics they are read and written under a lock of their own,
+   which is then taken for every entry */
+static pthread_mutex_t shared_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static size_t locked_load (void *p, size_t size)
+{
+    size_t value;
+
+    pthread_mutex_lock (&shared_lock);
+    value = size == sizeof(int) ? (size_t)*(int *)p : *(size_t *)p;
+    pthread_mutex_unlock (&shared_lock);
+    return value;
+}
+
+static void locked_store (void *p, size_t size, size_t value)
+{
+    pthread_mutex_lock (&shared_lock);
+    if (size == sizeof(int))
+        *(int *)p = (int)value;
+    else
+        *(size_t *)p = value;
+    pthread_mutex_unlock (&shared_lock);
+}
+
+#define LOAD(p) locked_load ((void *)(p), sizeof(*(p)))
+#define STORE(p, v) locked_store ((void *)(p), sizeof(*(p)), (size_t)(v))
+#endif
+
+/***************************************************************************
+  Write the file's buffered bytes through to disk.  Returns 0 on error.
+***************************************************************************/
+static int sync_file (FILE *file)
+{
+    if (fflush (file))
+        return 0;
+#ifdef WIN32
+    return _commit (_fileno (file)) == 0;
+#else
+    return fsync (fileno (file)) == 0;
+#endif
+}
+
+/***************************************************************************
+  Open the output file for appending.  Returns 0 on error.
+***************************************************************************/
+static int open_file (exit_writer *writer)
+{
+    writer->file = fopen (writer->path, "ab");
+    if (!writer->file)
+        return 0;
+    setvbuf (writer->file, NULL, _IOFBF, FILE_BUFFER);
+    if (fseek (writer->file, 0L, SEEK_END) == 0)
+        writer->file_bytes = ftell (writer->file);
+    return 1;
+}
+
+/***************************************************************************
+  Sync and close the output file, rename it to <path>.<n> and start a new
+  one.  Returns 0 on error.
+***************************************************************************/
+static int rotate_file (exit_writer *writer)
+{
+    int ok = sync_file (writer->file);
+
+    ok = fclose (writer->file) == 0 && ok;
+    writer->file = NULL;
+    sprintf (writer->rotate_path, "%s.%lu", writer->path,
+             ++writer->rotations);
+    ok = rename (writer->path, writer->rotate_path) == 0 && ok;
+    writer->file_bytes = 0;
+    return open_file (writer) && ok;
+}
+
+/***************************************************************************
+  Write the bytes of one entry.  After an error nothing more is written.
+***************************************************************************/
+static void write_entry (exit_writer *writer, const char *data,
+                         size_t length)
+{
+    if (writer->error)
+        return;
+
+    if (fwrite (data, 1, length, writer->file) != length)
+    {
+        STORE (&writer->error, errno ? errno : EIO);
+        return;
+    }
+    writer->file_bytes += (long)length;
+}
+
+/***************************************************************************
+  End of a record: rotate the file if it is full.
+***************************************************************************/
+static void end_record (exit_writer *writer)
+{
+    if (!writer->error && writer->file_bytes >= writer->rotate_bytes &&
+        !rotate_file (writer))
+        STORE (&writer->error, errno ? errno : EIO);
+}
+
+#ifndef EXIT_WRITER_SYNC
+
+/***************************************************************************
+  Sleep on cond for at most WAIT_MS, with the lock held.
+***************************************************************************/
+static void timed_wait (pthread_cond_t *cond, pthread_mutex_t *lock)
+{
+    struct timeval now;
+    struct timespec until;
+
+    gettimeofday (&now, NULL);
+    until.tv_sec = now.tv_sec;
+    until.tv_nsec = now.tv_usec * 1000L + WAIT_MS * 1000000L;
+    if (until.tv_nsec >= 1000000000L)
+    {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait (cond, lock, &until);
+}
+
+/***************************************************************************
+  Background writer: write the entries the exit produced, sync when
+  asked, and when stopped drain the ring, sync and close the file.
+***************************************************************************/
+static void *writer_thread (void *arg)
+{
+    exit_writer *writer = (exit_writer *)arg;
+    size_t mask = writer->ring_size - 1;
+    size_t tail = writer->tail;
+    size_t head;
+    size_t request;
+    unsigned int length;
+
+    for (;;)
+    {
+        head = LOAD (&writer->head);
+        if (head == tail)
+        {
+            /* Idle: hand the buffered bytes to the system, then serve a
+               sync request, stop, or sleep */
+            if (!writer->error && fflush (writer->file))
+                STORE (&writer->error, errno ? errno : EIO);
+
+            pthread_mutex_lock (&writer->lock);
+            request = writer->sync_request;
+            if (request > writer->synced)
+            {
+                pthread_mutex_unlock (&writer->lock);
+                if (!writer->error && !sync_file (writer->file))
+                    STORE (&writer->error, errno ? errno : EIO);
+                pthread_mutex_lock (&writer->lock);
+                writer->synced = request;
+                pthread_cond_broadcast (&writer->done);
+                pthread_mutex_unlock (&writer->lock);
+                continue;
+            }
+            if (writer->stopping)
+            {
+                pthread_mutex_unlock (&writer->lock);
+                break;
+            }
+            STORE (&writer->writer_waiting, 1);
+            if (LOAD (&writer->head) == tail)
+                timed_wait (&writer->wake, &writer->lock);
+            STORE (&writer->writer_waiting, 0);
+            pthread_mutex_unlock (&writer->lock);
+            continue;
+        }
+
+        while (tail != head)
+        {
+            memcpy (&length, writer->ring + (tail & mask), sizeof(length));
+            if (length == ENTRY_WRAP)
+                tail += writer->ring_size - (tail & mask);
+            else if (length == ENTRY_RECORD)
+            {
+                end_record (writer);
+                tail += ENTRY_ALIGN;
+            }
+            else
+            {
+                write_entry (writer, writer->ring + (tail & mask) + ENTRY_ALIGN,
+                             length);
+                tail += ENTRY_SIZE (length);
+            }
+            STORE (&writer->tail, tail);
+        }
+
+        if (LOAD (&writer->exit_waiting))
+        {
+            pthread_mutex_lock (&writer->lock);
+            pthread_cond_signal (&writer->done);
+            pthread_mutex_unlock (&writer->lock);
+        }
+    }
+
+    if (!writer->error && !sync_file (writer->file))
+        STORE (&writer->error, errno ? errno : EIO);
+    return NULL;
+}
+
+/***************************************************************************
+  Wait until the ring has needed free bytes.  Returns 0 if the writer
+  failed.
+***************************************************************************/
+static int wait_for_room (exit_writer *writer, size_t needed)
+{
+    while (writer->ring_size - (writer->head - LOAD (&writer->tail)) < needed)
+    {
+        if (LOAD (&writer->error))
+            return 0;
+        pthread_mutex_lock (&writer->lock);
+        STORE (&writer->exit_waiting, 1);
+        pthread_cond_signal (&writer->wake);
+        if (writer->ring_size - (writer->head - LOAD (&writer->tail)) < needed)
+            timed_wait (&writer->done, &writer->lock);
+        STORE (&writer->exit_waiting, 0);
+        pthread_mutex_unlock (&writer->lock);
+    }
+    return 1;
+}
+
+#endif /* EXIT_WRITER_SYNC */
+
+/***************************************************************************
+  Open path for appending and start its writer, with a ring of ring_size
+  bytes (EXIT_WRITER_RING if 0), rotating the file every rotate_bytes (0
+  never).  Returns NULL if the file, memory or thread cannot be had.
+***************************************************************************/
+exit_writer *exit_writer_open (const char *path, size_t ring_size,
+                               long rotate_bytes)
+{
+    exit_writer *writer;
+    size_t size = MIN_RING;
+#ifndef EXIT_WRITER_SYNC
+    sigset_t all_signals, saved_signals;
+    int rc;
+#endif
+
+    if (!ring_size)
+        ring_size = EXIT_WRITER_RING;
+    while (size < ring_size)
+        size *= 2;
+
+    writer = (exit_writer *)calloc (1, sizeof(exit_writer));
+    if (!writer)
+        return NULL;
+    writer->path = (char *)malloc (strlen (path) + 1);
+    writer->rotate_path = (char *)malloc (strlen (path) + 24);
+    writer->ring = (char *)malloc (size);
+    if (!writer->path || !writer->rotate_path || !writer->ring)
+    {
+        free (writer->path);
+        free (writer->rotate_path);
+        free (writer->ring);
+        free (writer);
+        return NULL;
+    }
+    strcpy (writer->path, path);
+    writer->rotate_bytes = rotate_bytes;
+    writer->ring_size = size;
+    writer->max_entry = size / 4 - ENTRY_ALIGN;
+
+    if (!open_file (writer))
+    {
+        free (writer->path);
+        free (writer->rotate_path);
+        free (writer->ring);
+        free (writer);
+        return NULL;
+    }
+
+#ifndef EXIT_WRITER_SYNC
+    pthread_mutex_init (&writer->lock, NULL);
+    pthread_cond_init (&writer->wake, NULL);
+    pthread_cond_init (&writer->done, NULL);
+
+    /* Signals stay with the Extract or Replicat threads */
+    sigfillset (&all_signals);
+    pthread_sigmask (SIG_BLOCK, &all_signals, &saved_signals);
+    rc = pthread_create (&writer->thread, NULL, writer_thread, writer);
+    pthread_sigmask (SIG_SETMASK, &saved_signals, NULL);
+    if (rc)
+    {
+        pthread_cond_destroy (&writer->done);
+        pthread_cond_destroy (&writer->wake);
+        pthread_mutex_destroy (&writer->lock);
+        fclose (writer->file);
+        free (writer->path);
+        free (writer->rotate_path);
+        free (writer->ring);
+        free (writer);
+        return NULL;
+    }
+#endif
+
+    return writer;
+}
+
+/***************************************************************************
+  Room for an entry of at most max_length bytes, to be formatted in place
+  and published by exit_writer_commit().  Returns NULL if the writer
+  failed or max_length is more than a quarter of the ring.
+***************************************************************************/
+char *exit_writer_reserve (exit_writer *writer, size_t max_length)
+{
+#ifndef EXIT_WRITER_SYNC
+    size_t position;
+    size_t to_end;
+    size_t needed;
+    unsigned int wrap = ENTRY_WRAP;
+#endif
+
+    if (max_length > writer->max_entry || LOAD (&writer->error))
+        return NULL;
+    writer->reserved = max_length;
+
+#ifdef EXIT_WRITER_SYNC
+    return writer->ring;
+#else
+    position = writer->head & (writer->ring_size - 1);
+    to_end = writer->ring_size - position;
+    needed = ENTRY_SIZE (max_length);
+
+    if (needed > to_end)
+    {
+        /* Send the reader back to the start of the ring */
+        if (!wait_for_room (writer, to_end))
+            return NULL;
+        memcpy (writer->ring + position, &wrap, sizeof(wrap));
+        STORE (&writer->head, writer->head + to_end);
+        position = 0;
+    }
+    if (!wait_for_room (writer, needed))
+        return NULL;
+    return writer->ring + position + ENTRY_ALIGN;
+#endif
+}
+
+/***************************************************************************
+  Publish the first length bytes of the reservation.  Returns 0 if the
+  writer failed.
+***************************************************************************/
+int exit_writer_commit (exit_writer *writer, size_t length)
+{
+#ifndef EXIT_WRITER_SYNC
+    unsigned int entry_length;
+#endif
+
+    if (length > writer->reserved)
+        length = writer->reserved;
+    writer->reserved = 0;
+
+#ifdef EXIT_WRITER_SYNC
+    write_entry (writer, writer->ring, length);
+    return !writer->error;
+#else
+    entry_length = (unsigned int)length;
+    memcpy (writer->ring + (writer->head & (writer->ring_size - 1)),
+            &entry_length, sizeof(entry_length));
+    STORE (&writer->head, writer->head + ENTRY_SIZE (length));
+
+    if (LOAD (&writer->writer_waiting))
+    {
+        pthread_mutex_lock (&writer->lock);
+        pthread_cond_signal (&writer->wake);
+        pthread_mutex_unlock (&writer->lock);
+    }
+    return !LOAD (&writer->error);
+#endif
+}
+
+/***************************************************************************
+  Copy length bytes into the ring, in pieces if they are more than an
+  entry holds.  Returns 0 if the writer failed.
+***************************************************************************/
+int exit_writer_write (exit_writer *writer, const void *buf, size_t length)
+{
+    const char *p = (const char *)buf;
+    size_t piece;
+    char *entry;
+
+    do
+    {
+        piece = length < writer->max_entry ? length : writer->max_entry;
+        entry = exit_writer_reserve (writer, piece);
+        if (!entry)
+            return 0;
+        memcpy (entry, p, piece);
+        if (!exit_writer_commit (writer, piece))
+            return 0;
+        p += piece;
+        length -= piece;
+    } while (length);
+
+    return 1;
+}
+
+/***************************************************************************
+  Mark the end of a record, where the file may be rotated.  Only needed
+  with rotate_bytes set, and not while a reservation is open.  Returns 0
+  if the writer failed.
+***************************************************************************/
+int exit_writer_end_record (exit_writer *writer)
+{
+#ifndef EXIT_WRITER_SYNC
+    unsigned int mark = ENTRY_RECORD;
+#endif
+
+    if (writer->rotate_bytes <= 0)
+        return !LOAD (&writer->error);
+
+#ifdef EXIT_WRITER_SYNC
+    end_record (writer);
+    return !writer->error;
+#else
+    /* Entries are aligned, so a header always fits before the ring end */
+    if (!wait_for_room (writer, ENTRY_ALIGN))
+        return 0;
+    memcpy (writer->ring + (writer->head & (writer->ring_size - 1)),
+            &mark, sizeof(mark));
+    STORE (&writer->head, writer->head + ENTRY_ALIGN);
+
+    if (LOAD (&writer->writer_waiting))
+    {
+        pthread_mutex_lock (&writer->lock);
+        pthread_cond_signal (&writer->wake);
+        pthread_mutex_unlock (&writer->lock);
+    }
+    return !LOAD (&writer->error);
+#endif
+}
+
+/***************************************************************************
+  Durability barrier: return once everything written so far is on disk.
+  Returns 0 if the writer failed.
+***************************************************************************/
+int exit_writer_sync (exit_writer *writer)
+{
+#ifdef EXIT_WRITER_SYNC
+    if (!writer->error && !sync_file (writer->file))
+        writer->error = errno ? errno : EIO;
+    return !writer->error;
+#else
+    size_t request = writer->head;
+
+    pthread_mutex_lock (&writer->lock);
+    if (writer->sync_request < request)
+        writer->sync_request = request;
+    while (writer->synced < request && !LOAD (&writer->error))
+    {
+        pthread_cond_signal (&writer->wake);
+        timed_wait (&writer->done, &writer->lock);
+    }
+    pthread_mutex_unlock (&writer->lock);
+    return !LOAD (&writer->error);
+#endif
+}
+
+/***************************************************************************
+  Drain the ring, sync and close the file and free the writer.  Returns 0
+  if anything failed to reach the file.
+***************************************************************************/
+int exit_writer_close (exit_writer *writer)
+{
+    int ok;
+
+#ifdef EXIT_WRITER_SYNC
+    if (!writer->error && !sync_file (writer->file))
+        writer->error = errno ? errno : EIO;
+#else
+    pthread_mutex_lock (&writer->lock);
+    writer->stopping = 1;
+    pthread_cond_signal (&writer->wake);
+    pthread_mutex_unlock (&writer->lock);
+    pthread_join (writer->thread, NULL);
+
+    pthread_cond_destroy (&writer->done);
+    pthread_cond_destroy (&writer->wake);
+    pthread_mutex_destroy (&writer->lock);
+#endif
+
+    ok = !writer->error;
+    if (writer->file && fclose (writer->file))
+        ok = 0;
+    free (writer->path);
+    free (writer->rotate_path);
+    free (writer->ring);
+    free (writer);
+    return ok;
+}
@@ -0,0 +1,67 @@
+/**************************************************************************
+  Program description:
+
+  Asynchronous side output for the user exits.
+
+  An exit that writes its own files (flat files, dumps, audit logs) hands
+  the bytes to a writer instead of calling fwrite on the Extract or
+  Replicat thread.  The bytes are copied into a single producer, single
+  consumer ring buffer and a background thread writes them to the file,
+  rotates it and syncs it to disk:
+
+      writer = exit_writer_open ("./dirdat/flatfile.dat", 0, 0);
+      ...
+      case EXIT_CALL_PROCESS_RECORD:
+          exit_writer_write (writer, buf, length);
+          exit_writer_end_record (writer);
+      case EXIT_CALL_CHECKPOINT:
+          exit_writer_sync (writer);
+      case EXIT_CALL_STOP:
+          exit_writer_close (writer);
+
+  A record can also be formatted straight into the ring:
+
+      p = exit_writer_reserve (writer, 200);
+      exit_writer_commit (writer, sprintf (p, ...));
+
+  The exit thread only moves the ring's head and the writer thread only
+  its tail, so neither takes a lock while the ring has room and data.
+  The exit waits only when the ring is full.  exit_writer_sync() is a
+  durability barrier: it returns once everything written before it is
+  on disk.  exit_writer_close() drains the ring, syncs and closes the
+  file.  An I/O error on the writer thread is returned by the next call
+  from the exit.
+
+  With rotate_bytes set, the file is renamed to <path>.<n> and started
+  afresh once it holds that many bytes, at the next record end the exit
+  marks with exit_writer_end_record(), so a record written in pieces is
+  never split across two files.  A writer whose exit marks no records
+  never rotates.
+
+  Where the runtime has no threads (Windows, NonStop) the same calls
+  write the file synchronously.
+
+***************************************************************************/
+
+#ifndef EXITWRITER_H__
+#define EXITWRITER_H__
+
+#include <stddef.h>
+
+/* Default ring size, rounded up to a power of two */
+#define EXIT_WRITER_RING (1024 * 1024)
+
+/* The writer's state is private to exitwriter.c, which keeps the thread
+   types out of the exits */
+typedef struct exit_writer exit_writer;
+
+exit_writer *exit_writer_open (const char *path, size_t ring_size,
+                               long rotate_bytes);
+char *exit_writer_reserve (exit_writer *writer, size_t max_length);
+int exit_writer_commit (exit_writer *writer, size_t length);
+int exit_writer_write (exit_writer *writer, const void *buf, size_t length);
+int exit_writer_end_record (exit_writer *writer);
+int exit_writer_sync (exit_writer *writer);
+int exit_writer_close (exit_writer *writer);
+
+#endif /* EXITWRITER_H__ */
@@ -123,566 +123,438 @@
   #include <ctype.h>
 #endif
 
-#include "usrdecs.h"
-
-/* ER callback routine */
-#ifndef WIN32
-void ERCALLBACK(ercallback_function_codes function_code,
-                void *buf, short *presult_code);
-#else
-typedef void (*FPERCALLBACK)(ercallback_function_codes function_code,
-                             void *buf, short *presult_code);
-
-HINSTANCE hEXE; /* EXE handle */
-FPERCALLBACK fp_ERCallback; /* Callback function pointer */
+#include "exitrt.h"
+#include "exitarena.h"
+#include "tablemeta.h"
+#include "exitrecord.h"
+#include "exittxn.h"
+#include "orgfilter.h"
+#include "exitparam.h"
+#include "exittoken.h"
+#include "exitsample.h"
+#include "exittrace.h"
+#include "exitprof.h"
+
+/* Environment variable giving the report log level, see exitlog.h */
+#define LOG_LEVEL_ENV "CUSEREXIT_LOG_LEVEL"
+
+/* Environment variable turning on per-record diagnostics */
+#define VERBOSE_ENV "CUSEREXIT_VERBOSE"
+
+/* Environment variable choosing the records that get per-record
+   diagnostics, see exitsample.h */
+#define SAMPLE_ENV "CUSEREXIT_SAMPLE"
+
+/* Environment variable capping the report bytes per second, see
+   exitlog.h */
+#define REPORT_RATE_ENV "CUSEREXIT_REPORT_RATE"
+
+/* Environment variable giving the number of keys from which an IN list
+   gets a Bloom prefilter */
+#define BLOOM_ENV "CUSEREXIT_BLOOM"
+
+/* Environment variable giving the checkpoint position sampling, see
+   exitrt.h */
+#define POSITION_ENV "CUSEREXIT_POSITION"
+
+/* Environment variable turning on the callback profiler, giving the
+   seconds between its summaries, see exitprof.h */
+#define PROFILE_ENV "CUSEREXIT_PROFILE"
+
+/* Environment variable turning on transaction batching, optionally giving
+   the bytes of a transaction held in memory before it spills, see
+   exittxn.h */
+#define BATCH_ENV "CUSEREXIT_BATCH"
+
+/* Report tokens, metadata and column values of accepted
+   records?  Off by default, so that a rejected record costs the operation
+   type and the filter probe only. */
+static short verbose_diagnostics = 0;
+
+/* Records shown in verbose mode, every one by default */
+static exit_sampler samples;
+
+/* Checkpoint positions, read once per transaction by default */
+static exit_position_sampler positions;
+
+/* Per-call scratch memory */
+static exit_arena arena;
+
+/* Columns of the record being displayed */
+static exit_record record_view;
+
+/* User tokens, fetched once per transaction */
+static exit_token_cache tokens;
+static short host_token = -1;
+
+/* Accepted records of the current transaction, if batching is on */
+static short batch_transactions = 0;
+static exit_txn txn;
+
+/* Operation counts of a batched transaction */
+typedef struct
+{
+    long inserts;
+    long updates;
+    long deletes;
+    long others;
+} batch_summary;
 
-/***************************************************************************
-  Open the ER callback function explicitly.
-***************************************************************************/
-short open_callback (char *executable_name,
-                     char *function_name)
+short xstrcpy(char *p, char *q)
 {
-    printf ("Opening callback for %s, %s.\n",
-            executable_name,
-            function_name);
+    while (*p != '\0')
+        {
+                *q = *p;
+                        p++;
+                                q++;
 
-    hEXE = LoadLibrary (executable_name);
-    if (hEXE != NULL)
-    {
-        /* Function should always be exported in uppercase, since
-           GetProcAddress converts to uppercase then does a case-sensitive
-           search.  Don't use /NOIGNORE (/NOI) linker option. */
-        fp_ERCallback = (FPERCALLBACK)GetProcAddress(hEXE, function_name);
+                                    }
+                                        *q = '\0';
+                                            printf("Copied String: %s", q);
+                                            return 0;
+                                            }
 
-        if (!fp_ERCallback)
-        {
-            FreeLibrary (hEXE);
-            return 0;
-        }
-    }
-    else
-        return 0;
 
-    return 1;
-}
-#endif
 
 /***************************************************************************
-  Close the callback function.
+  Report the partition filter compiled from a filter file.
 ***************************************************************************/
-void close_callback (void)
+void report_partition_filter (const char *filter_file,
+                              const org_filter_def *filter)
 {
-#ifdef WIN32
-    FreeLibrary (hEXE);
-#endif
+    if (!filter)
+        exit_log (EXIT_LOG_ERROR, "Error compiling partition filter %s: %s\n",
+                  filter_file, org_filter_error ());
+    else
+    if (!filter->file_found)
+        output_msg ("Init file %s not found to read the Org Ids, "
+                    "records will not be filtered\n", filter_file);
+    else
+    if (!filter->num_rules)
+        output_msg ("Init file %s is empty, records will not be filtered\n",
+                    filter_file);
+    else
+    if (filter->org_id_list)
+        output_msg ("Loaded %lu Org Ids from %s%s\n",
+                    (unsigned long)filter->num_keys, filter_file,
+                    filter->default_program->ops[0].op == ORG_RULE_IN_INT ?
+                    " into an integer bitmap" :
+                    filter->default_program->ops[0].set->mapping ?
+                    ", mapped precompiled" : "");
+    else
+        output_msg ("Compiled %lu partition filter rules for %hd tables%s "
+                    "from %s\n", (unsigned long)filter->num_rules,
+                    filter->num_programs,
+                    filter->default_program ? " and TABLE *" : "",
+                    filter_file);
 }
 
 /***************************************************************************
-  Call the callback function.
+  Report the hit counters of a Bloom prefilter.  The false positive rate
+  is over the lookups of keys not in the list.
 ***************************************************************************/
-void call_callback (ercallback_function_codes function_code,
-                    void *buf, short *result_code)
+void report_bloom (const char *filter_file, const char *table_name,
+                   const char *column, const org_bloom_filter *bloom)
 {
-#ifdef WIN32
-    fp_ERCallback (function_code, buf, result_code);
-#else
-    ERCALLBACK (function_code, buf, result_code);
-#endif
+    uint64_t misses = bloom->rejects + bloom->false_positives;
+
+    output_msg ("Bloom prefilter of %s %s in %s:\n"
+                "Lookups:             \t%lu\n"
+                "Rejected by Bloom:   \t%lu\n"
+                "False positives:     \t%lu (%.4f%%)\n",
+                table_name, column, filter_file,
+                (unsigned long)bloom->probes, (unsigned long)bloom->rejects,
+                (unsigned long)bloom->false_positives,
+                misses ? 100.0 * bloom->false_positives / misses : 0.0);
 }
 
 /***************************************************************************
-  Test for Little Endian machine format
+  Compile the filter file named by the EXITPARAM and report what was
+  found.  The filter stays registered under the path for the life of the
+  process and is recompiled at checkpoints when the file changes.
 ***************************************************************************/
-short LittleEndian( void )
+org_filter_def *load_partition_filter (char *filter_file)
 {
-    short little_endian = 1;
-    char *little_endian_c = (char *)&little_endian;
+    org_filter_def *filter;
 
-    if (*little_endian_c)
-    {
-        return 1;
-    }
-    return 0;
+    filter = org_filter_load (filter_file);
+    report_partition_filter (filter_file, filter);
+
+    return filter;
 }
 
 /***************************************************************************
-  Reverse bytes for Little Endian/Big Endian
+  Parse an EXITPARAM seen for the first time and compile the partition
+  filter it names.  Returns NULL if either fails.
 ***************************************************************************/
-void ReverseBytes (void *buf, short cnt)
+exit_param *compile_exit_param (const char *function_param)
 {
-    char *b = (char *)buf, *e = (char *)buf + cnt - 1;
-    char temp;
+    exit_param *param;
+
+    param = exit_param_add (function_param);
+    if (!param)
+    {
+        exit_log (EXIT_LOG_ERROR, "Error allocating the options of EXITPARAM %s.\n",
+                  function_param);
+        return NULL;
+    }
 
-    for (; b < e; b++, e--)
+    if (param->filter_file)
     {
-        temp = *b;
-        *b = *e;
-        *e = temp;
+        param->filter = org_filter_find (param->filter_file);
+        if (!param->filter)
+            param->filter = load_partition_filter (param->filter_file);
+        if (!param->filter)
+            return NULL;
     }
+    return param;
 }
 
 /***************************************************************************
-  Output a message to the report file (or console).
+  Drop the cached metadata and filter column indexes of the table a DDL
+  record touches, and of its base table for DDL on an index or trigger.
 ***************************************************************************/
-void output_msg (char *msg,...)
+void invalidate_ddl_object (short source_or_target)
 {
+    static const ercallback_function_codes name_codes[] =
+        { GET_OBJECT_NAME, GET_BASE_OBJECT_NAME };
     short result_code;
-    char temp_msg[1000];
-
-    va_list args;
-
-    va_start (args, msg);
+    env_value_def env_value;
+    char object_name[500];
+    int i;
 
-    vsprintf (temp_msg, msg, args);
+    for (i = 0; i < 2; i++)
+    {
+        memset (&env_value, 0, sizeof(env_value_def));
+        env_value.buffer = object_name;
+        env_value.max_length = sizeof(object_name);
+        env_value.source_or_target = source_or_target;
 
-    va_end (args);
+        call_callback (name_codes[i], &env_value, &result_code);
+        if (result_code != EXIT_FN_RET_OK || !env_value.actual_length)
+            continue;
 
-    call_callback (OUTPUT_MESSAGE_TO_REPORT, temp_msg, &result_code);
-}
-
-short IsPrint(int c)
-{
-    if (c != EOF) c = (unsigned char)c;
-    return isprint(c) ? 1 : 0;
+        table_meta_invalidate (object_name, env_value.actual_length);
+        org_table_columns_invalidate (object_name, env_value.actual_length);
+    }
 }
 
-short xstrcpy(char *p, char *q)
-{
-    while (*p != '\0')
-        {
-                *q = *p;
-                        p++;
-                                q++;
-
-                                    }
-                                        *q = '\0';
-                                            printf("Copied String: %s", q);
-                                            return 0;
-                                            }
-
-
-
-short partition_filter (short source_or_target, short ascii_or_internal, char ue_name[])
-
+/***************************************************************************
+  Resolve the index and data type of every column a table's rules test,
+  once per table and filter, from the table's cached metadata, so records
+  are read by column index instead of having the host look the column
+  name up on every record.
+***************************************************************************/
+short resolve_filter_columns (short source_or_target,
+                              const org_filter_def *filter,
+                              const org_rule_program *program,
+                              const char *table_name, size_t length,
+                              org_table_columns *columns)
 {
-
-    int i, j, k;
-    unsigned short col_len;
-    char hex_str[31];
-    char ascii_str[11];
-    char *a;
     short result_code;
-    table_def table;
-    column_def column;
-    env_value_def env_value;
-    char *table_column_name;
-    char *table_column_value;
-    unsigned short value_length;
-
-    /* initialize */
-    memset (&env_value, 0, sizeof(env_value_def));
-    env_value.max_length = 500;
-    env_value.buffer = (char *)malloc(500);
-    if (source_or_target == EXIT_FN_CURRENT_VAL)
-        env_value.source_or_target = EXIT_FN_TARGET_VAL;
-    else
-        env_value.source_or_target = source_or_target;
-
-    memset(&column, 0, sizeof (column_def));
-    column.source_or_target = source_or_target;
-    column.column_value_mode = ascii_or_internal;
-    column.column_value = (char*)malloc(4000);
-    column.max_value_length = 4000;
-    column.column_name = "ORGANIZATION_ID";
-
-       /* get column value from name*/
-       call_callback (GET_COLUMN_VALUE_FROM_NAME, &column, &result_code);
-       if (result_code != EXIT_FN_RET_OK &&
-           result_code != EXIT_FN_RET_COLUMN_NOT_FOUND)
-       {
-            output_msg ("Error (%hd) retrieving column value.\n", result_code);
-            free (env_value.buffer);
-            free (column.column_value);
-            return result_code;
-       }
-       table_column_value = column.column_value;
-        //*table_column_value = *column.column_value;
-       //output_msg ("Column Value: %s \n", table_column_value);
-       value_length = column.actual_value_length;
-       char act_col_val_arr[value_length];
-       char ref_col_val_arr[100][25];
-       //Read from File
-       output_msg("\n Reading the Orgids.init file: %s\n",ue_name);
-        FILE *fp = fopen(ue_name, "r");
-        const char s[2] = ", ";
-        char *token;
-        int nt = 0;
-        int boolIFP = 0; //Init File Present Or Not
-        if(fp != NULL)
-        {
-            char line[20];
-            while(fgets(line, sizeof line, fp) != NULL)
-            {
-                token = strtok(line, s);
-                while ( token != NULL )
-                {
-                    nt++;
-                    //output_msg("nt is:%d, String is:%s\n",nt,token);
-                    if(strcmp(token, "\n") != 0 && strlen(token) > 0)
-                    {
-                        strcpy(ref_col_val_arr[nt-1], token);
-                        boolIFP = 1;
-                    }
-                    token = strtok(NULL,s);
-                }
-           }
-           fclose(fp);
-        } else {
-            output_msg("Init file not found to read the Org Ids\n");
-        }
-
-       int ai;
-      for( ai = 0; ai < value_length ; ai++) {
-        //output_msg("Printing:%c\n",*table_column_value);
-        act_col_val_arr[ai] =  *table_column_value;
-        table_column_value++;
-        //value_length--;
-       }
-       act_col_val_arr[ai]='\0';
-        //output_msg ("Column Value 2  = %.*s  \n",
-        //             column.actual_value_length, column.column_value);
-        //output_msg ("Column Value length: %d \n",column.actual_value_length);
-      //output_msg("Printing array\n");
-      //for(ai = 0 ; ai < value_length; ai++) {
-      //      output_msg("Print Array:%c\n",act_col_val_arr[ai]);
-      //}
-      int boolInt = 0;
-      ai = 0;
-       //output_msg("ai:%d, nt:%d\n",ai,nt);
-      for (ai = 0; ai < nt; ai++) {
-        //if(act_col_val_arr[ai] != ref_col_val_arr[ai]) {
-        int cmpi = strcmp(act_col_val_arr, ref_col_val_arr[ai]);
-        //output_msg("Matched for %s and %s\n", act_col_val_arr, ref_col_val_arr[ai]);
-        //output_msg("Compare Value:%d\n",cmpi);
-        if (cmpi == 0) {
-            boolInt = 1;
-            break;
-        }
-      }
+    short i;
+    table_meta *meta;
 
-      if (boolIFP ==1 )
-      {
-        if (boolInt == 0)
-        {
-            //Equal Records found, so skip the record
-            output_msg("Org ID is not found in Init file. So ignoring to extract the record\n");
-            output_msg("Ignored Org ID %s \n",act_col_val_arr);
-            //*exit_call_result = EXIT_IGNORE_VAL;
-            if (source_or_target == EXIT_FN_SOURCE_VAL) {
-                return EXIT_IGNORE_VAL;
-            }
-        }
-        else {
-            output_msg("Org ID found in Init file, so not skipping the record \n");
-            output_msg("Processed Org ID %s \n",act_col_val_arr);
-        }
-     }
-     else {
-        output_msg("Either Init file not there or Init file is empty \n");
-     }
+    meta = find_table_metadata (source_or_target, table_name, length,
+                                &result_code);
+    if (!meta)
+        return result_code;
 
-    return 0;
+    for (i = 0; i < program->num_columns; i++)
+    {
+        columns->column_index[i] =
+            table_meta_column_index (meta, program->columns[i]);
+        if (columns->column_index[i] >= 0)
+            columns->data_type[i] =
+                meta->columns[columns->column_index[i]].gg_data_type;
+    }
 
+    columns->source_or_target = source_or_target;
+    columns->generation = filter->generation;
+    return EXIT_FN_RET_OK;
 }
 
 /***************************************************************************
-  Display record information.
+  Filter a record with the rules compiled for its table.  Each column a
+  rule tests is fetched once, by its cached index, and only when a
+  previous rule held.  Returns EXIT_IGNORE_VAL for source records failing
+  a rule.
 ***************************************************************************/
-short display_record (short source_or_target,
-                      short ascii_or_internal)
+short partition_filter (short source_or_target, short ascii_or_internal,
+                        const org_filter_def *filter)
 {
-    int i, j, k;
-    unsigned short col_len;
-    char hex_str[31];
-    char ascii_str[11];
-    char *a;
+    static char column_values[ORG_RULE_MAX_COLUMNS][4000];
+    org_value_def values[ORG_RULE_MAX_COLUMNS];
+    short fetched[ORG_RULE_MAX_COLUMNS];
+    const org_rule_program *program;
+    const org_rule_op *op;
+    org_table_columns *columns;
     short result_code;
-    table_def table;
+    short i;
     column_def column;
     env_value_def env_value;
-    char *table_column_name;
-    char *table_column_value;
-    unsigned short value_length;
+    char table_name[500];
+
+    if (!filter || (!filter->num_programs && !filter->default_program))
+        return EXIT_FN_RET_OK;
 
-    /* initialize */
     memset (&env_value, 0, sizeof(env_value_def));
-    env_value.max_length = 500;
-    env_value.buffer = (char *)malloc(500);
-    if (source_or_target == EXIT_FN_CURRENT_VAL)
-        env_value.source_or_target = EXIT_FN_TARGET_VAL;
-    else
-        env_value.source_or_target = source_or_target;
+    env_value.buffer = table_name;
+    env_value.max_length = sizeof(table_name);
+    env_value.source_or_target = source_or_target;
 
-    /* Get column value from name  */
-    call_callback (GET_CATALOG_NAME_ONLY, &env_value, &result_code);
+    call_callback (GET_TABLE_NAME, &env_value, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving catalog name.\n", result_code);
-        free (env_value.buffer);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving fully qualified table name.\n",
+                  result_code);
         return result_code;
     }
-    output_msg ("Catalog name: %.*s \n",
-                    env_value.actual_length, env_value.buffer);
 
+    /* No rules for this table */
+    program = org_filter_program (filter, env_value.buffer,
+                                  env_value.actual_length);
+    if (!program)
+        return EXIT_FN_RET_OK;
 
-    /* Get catalog name only */
-    call_callback (GET_CATALOG_NAME_ONLY, &env_value, &result_code);
-    if (result_code != EXIT_FN_RET_OK)
+    columns = org_table_columns_find (env_value.buffer,
+                                      env_value.actual_length);
+    if (!columns)
     {
-        output_msg ("Error (%hd) retrieving catalog name.\n", result_code);
-        free (env_value.buffer);
-        return result_code;
+        exit_log (EXIT_LOG_ERROR, "Error allocating the column cache of %s.\n", table_name);
+        return EXIT_ABEND_VAL;
     }
-    output_msg ("Catalog name: %.*s \n",
-                 env_value.actual_length, env_value.buffer);
-
-    /* Get schema name only */
-    call_callback (GET_SCHEMA_NAME_ONLY, &env_value, &result_code);
-    if (result_code != EXIT_FN_RET_OK)
+    if (columns->generation != filter->generation ||
+        columns->source_or_target != source_or_target)
     {
-        output_msg ("Error (%hd) retrieving catalog name.\n", result_code);
-        free (env_value.buffer);
-        return result_code;
+        result_code = resolve_filter_columns (source_or_target, filter,
+                                              program, env_value.buffer,
+                                              env_value.actual_length,
+                                              columns);
+        if (result_code != EXIT_FN_RET_OK)
+            return result_code;
     }
-    output_msg ("Schema  name: %.*s \n",
-                 env_value.actual_length, env_value.buffer);
 
-    /* Get table name only */
-    call_callback (GET_TABLE_NAME_ONLY, &env_value, &result_code);
-    if (result_code != EXIT_FN_RET_OK)
+    memset (fetched, 0, sizeof(fetched));
+    for (i = 0; i < program->num_ops; i++)
     {
-        output_msg ("Error (%hd) retrieving table name.\n", result_code);
-        free (env_value.buffer);
-        return result_code;
-    }
-    output_msg ("Table   name: %.*s \n",
-                 env_value.actual_length, env_value.buffer);
+        op = &program->ops[i];
 
-    /* Get fully qualified table name */
-    call_callback (GET_TABLE_NAME, &env_value, &result_code);
-    if (result_code != EXIT_FN_RET_OK)
-    {
-        output_msg ("Error (%hd) retrieving fully qualified table name.\n",
-                     result_code);
-        free (env_value.buffer);
-        return result_code;
-    }
-    output_msg ("Fully qualified table name: %.*s \n",
-                 env_value.actual_length, env_value.buffer);
-
-    /* Get table column information */
-    memset (&table, 0, sizeof(table_def));
-    if (source_or_target == EXIT_FN_CURRENT_VAL)
-        table.source_or_target = EXIT_FN_TARGET_VAL;
-    else
-        table.source_or_target = source_or_target;
-
-    call_callback (GET_TABLE_COLUMN_COUNT, &table, &result_code);
-    if (result_code != EXIT_FN_RET_OK)
-    {
-        output_msg ("Error (%hd) retrieving table column count.\n",
-                     result_code);
-        free (env_value.buffer);
-        return result_code;
-    }
-    output_msg ("Number of columns: %hd\n", table.num_columns);
-
-    memset(&column, 0, sizeof (column_def));
-    column.source_or_target = source_or_target;
-    column.column_value_mode = ascii_or_internal;
-    column.column_value = (char*)malloc(4000);
-    column.max_value_length = 4000;
-    column.column_name = "ORGANIZATION_ID";
-
-       /* get column value from name*/
-       call_callback (GET_COLUMN_VALUE_FROM_NAME, &column, &result_code);
-       if (result_code != EXIT_FN_RET_OK &&
-           result_code != EXIT_FN_RET_COLUMN_NOT_FOUND)
-       {
-            output_msg ("Error (%hd) retrieving column value.\n", result_code);
-            free (env_value.buffer);
-            free (column.column_value);
-            return result_code;
-       }
-       //xstrcpy(column.column_value, table_column_value);
-        table_column_value = column.column_value;
-        //*table_column_value = *column.column_value;
-       //output_msg ("Column Value: %s \n", table_column_value);
-       value_length = column.actual_value_length;
-       char act_col_val_arr[value_length];
-       char ref_col_val_arr[100][25];
-       //Read from File
-        FILE *fp = fopen("//oracle//goldengate//12.3.0.4//dirue//orgids.init", "r");
-        const char s[2] = ", ";
-        char *token;
-        int nt = 0;
-        int boolIFP = 0; //Init File Present Or Not
-        if(fp != NULL)
+        if (!fetched[op->column])
         {
-            char line[20];
-            while(fgets(line, sizeof line, fp) != NULL)
+            values[op->column].data = column_values[op->column];
+            values[op->column].length = 0;
+            values[op->column].null_value = 1;
+            values[op->column].data_type =
+                ascii_or_internal == EXIT_FN_INTERNAL_FORMAT ?
+                columns->data_type[op->column] : 0;
+            fetched[op->column] = 1;
+
+            /* Column not in the table, the value stays NULL */
+            if (columns->column_index[op->column] >= 0)
             {
-                token = strtok(line, s);
-                while ( token != NULL )
+                memset (&column, 0, sizeof (column_def));
+                column.source_or_target = source_or_target;
+                column.column_value_mode = ascii_or_internal;
+                column.column_value = column_values[op->column];
+                column.max_value_length = sizeof(column_values[op->column]);
+                column.column_index = columns->column_index[op->column];
+
+                call_callback (GET_COLUMN_VALUE_FROM_INDEX, &column, &result_code);
+                if (result_code != EXIT_FN_RET_OK &&
+                    result_code != EXIT_FN_RET_COLUMN_NOT_FOUND)
                 {
-                    nt++;
-                    //output_msg("nt is:%d, String is:%s\n",nt,token);
-                    if(strcmp(token, "\n") != 0 && strlen(token) > 0)
-                    {
-                        strcpy(ref_col_val_arr[nt-1], token);
-                        boolIFP = 1;
-                    }
-                    token = strtok(NULL,s);
+                    exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving column value.\n",
+                              result_code);
+                    return result_code;
                 }
-           }
-           fclose(fp);
-        } else {
-            output_msg("Init file not found to read the Org Ids\n");
-        }
 
-       int ai;
-       for( ai = 0; ai < value_length ; ai++) {
-        //output_msg("Printing:%c\n",*table_column_value);
-        act_col_val_arr[ai] =  *table_column_value;
-        table_column_value++;
-        //value_length--;
-       }
-       act_col_val_arr[ai]='\0';
-        //output_msg ("Column Value 2  = %.*s  \n",
-        //             column.actual_value_length, column.column_value);
-        //output_msg ("Column Value length: %d \n",column.actual_value_length);
-      //output_msg("Printing array\n");
-      //for(ai = 0 ; ai < value_length; ai++) {
-      //      output_msg("Print Array:%c\n",act_col_val_arr[ai]);
-      //}
-      int boolInt = 0;
-      ai = 0;
-       //output_msg("ai:%d, nt:%d\n",ai,nt);
-      for (ai = 0; ai < nt; ai++) {
-        //if(act_col_val_arr[ai] != ref_col_val_arr[ai]) {
-        int cmpi = strcmp(act_col_val_arr, ref_col_val_arr[ai]);
-        //output_msg("Matched for %s and %s\n", act_col_val_arr, ref_col_val_arr[ai]);
-        //output_msg("Compare Value:%d\n",cmpi);
-        if (cmpi == 0) {
-            boolInt = 1;
-            break;
+                values[op->column].length = column.actual_value_length;
+                values[op->column].null_value =
+                    result_code == EXIT_FN_RET_COLUMN_NOT_FOUND ||
+                    column.null_value;
+            }
         }
-      }
 
-      if (boolIFP ==1 )
-      {
-        if (boolInt == 0)
+        if (!org_rule_test (op, &values[op->column]))
         {
-            //Equal Records found, so skip the record
-            output_msg("Org ID is not found in Init file. So ignring to extract the record\n");
-            output_msg("Ignored Org ID %s \n",act_col_val_arr);
-            //*exit_call_result = EXIT_IGNORE_VAL;
-            if (source_or_target == EXIT_FN_SOURCE_VAL) {
+            exit_log (EXIT_LOG_DEBUG, "Ignored %s %.*s \n",
+                      program->columns[op->column],
+                      (int)values[op->column].length,
+                      values[op->column].data);
+            if (source_or_target == EXIT_FN_SOURCE_VAL)
                 return EXIT_IGNORE_VAL;
-            }
+            return EXIT_FN_RET_OK;
         }
-        else {
-            output_msg("Org ID found in Init file, so not skipping the record \n");
-            output_msg("Processed Org ID %s \n",act_col_val_arr);
-        }
-     }
-     else {
-        output_msg("Either Init file not there or Init file is empty \n");
-     }
+    }
 
-    for (i = 0; i < table.num_columns; i++)
-    {
-        env_value.index = column.column_index = i;
+    exit_log (EXIT_LOG_DEBUG, "Processed %s %.*s \n", program->columns[0],
+              (int)values[0].length, values[0].data);
 
-        /* get column name */
-        call_callback (GET_COLUMN_NAME_FROM_INDEX, &env_value, &result_code);
-        if (result_code != EXIT_FN_RET_OK)
-        {
-            output_msg ("Error (%hd) retrieving column name.\n", result_code);
-            free (env_value.buffer);
-            free (column.column_value);
-            return result_code;
-        }
-        output_msg ("Column index (%d) = %.*s.\n",
-                    i, env_value.actual_length, env_value.buffer);
+    return EXIT_FN_RET_OK;
+}
 
-        table_column_name = env_value.buffer;
-        /* output_msg ("Column Name: %s \n", table_column_name); */
-        //if(strcmp(table_column_name, "FIELD1") == 0)
-        //{
+/***************************************************************************
+  Display record information.
+***************************************************************************/
+short display_record (short source_or_target,
+                      short ascii_or_internal)
+{
+    int i;
+    unsigned short col_len;
+    const char *value;
+    short result_code;
+    table_meta *meta;
 
-          //  output_msg ("Column Name check FIELD1, actual column name:%s \n",table_column_name);
-       // }
+    /* The whole record is read once, names come from the metadata cache */
+    result_code = exit_record_load (&record_view, source_or_target,
+                                    ascii_or_internal);
+    if (result_code != EXIT_FN_RET_OK)
+        return result_code;
+    meta = record_view.meta;
 
-        /* get column value */
-        call_callback (GET_COLUMN_VALUE_FROM_INDEX, &column, &result_code);
-        if (result_code != EXIT_FN_RET_OK &&
-            result_code != EXIT_FN_RET_COLUMN_NOT_FOUND)
-        {
-            output_msg ("Error (%hd) retrieving column value.\n", result_code);
-            free (env_value.buffer);
-            free (column.column_value);
-            return result_code;
-        }
+    output_msg ("Catalog name: %s \n", meta->catalog_name);
+    output_msg ("Schema  name: %s \n", meta->schema_name);
+    output_msg ("Table   name: %s \n", meta->object_name);
+    output_msg ("Fully qualified table name: %s \n", meta->table_name);
+    output_msg ("Number of columns: %hd\n", meta->num_columns);
 
-        if (result_code == EXIT_FN_RET_COLUMN_NOT_FOUND)
+    for (i = 0; i < record_view.num_columns; i++)
+    {
+        output_msg ("Column index (%d) = %s.\n", i,
+                    exit_record_name (&record_view, i));
+
+        if (record_view.null_flags[i] == EXIT_RECORD_MISSING)
             output_msg ("Column not found in record.\n");
         else
-        if (column.null_value)
+        if (record_view.null_flags[i] == EXIT_RECORD_NULL)
         {
-            if (column.is_hidden_column)
+            if (meta->columns[i].is_hidden_column)
                 output_msg ("Hidden column value is NULL.\n");
             else
                 output_msg ("Column value is NULL.\n");
         }
         else
         {
+            value = exit_record_value (&record_view, i);
+
             if (ascii_or_internal == EXIT_FN_ASCII_FORMAT)
-                output_msg ("Column value = %s.\n", column.column_value);
+                output_msg ("Column value = %s.\n", value);
             else
             {
                 /* Ouput internal value in hex */
-                if (column.is_hidden_column)
+                if (meta->columns[i].is_hidden_column)
                     output_msg ("Internal source hidden column value = \n");
                 else
                     output_msg ("Internal source column value = \n");
 
-                col_len = column.actual_value_length;
+                col_len = exit_record_length (&record_view, i);
 
-                for (j = 0; j < col_len; j += 10)
-                {
-                    for (a = column.column_value + j, k = 0;
-                         k < 10 && j + k < col_len;
-                         a++, k++)
-                    {
-                        ascii_str[k] =
-                            IsPrint (column.column_value[j + k]) ?
-                                     column.column_value[j + k] : '.';
-                        sprintf (hex_str + (k * 3), "%02X ",
-                                 (unsigned char)column.column_value[j + k]);
-                    }
-                    ascii_str[k] = 0;
-
-                    output_msg ("%5d:  %-10s   %-30s\n",
-                                j, ascii_str, hex_str);
-                }
+                exit_log_hex_dump (EXIT_LOG_INFO, value, col_len);
             }
         }
     }
 
-    free (env_value.buffer);
-    free (column.column_value);
-
     return EXIT_FN_RET_OK;
 }
 
@@ -704,30 +576,25 @@ short display_ddl (short source_or_target,
         ddl_rec.source_or_target = source_or_target;
 
     ddl_rec.ddl_type_max_length = 500;
-    ddl_rec.ddl_type = (char *)malloc(500);
+    ddl_rec.ddl_type = (char *)exit_arena_alloc (&arena, 500);
 
     ddl_rec.object_type_max_length = 500;
-    ddl_rec.object_type = (char *)malloc(500);
+    ddl_rec.object_type = (char *)exit_arena_alloc (&arena, 500);
 
     ddl_rec.object_max_length = 500;
-    ddl_rec.object_name = (char *)malloc(500);
+    ddl_rec.object_name = (char *)exit_arena_alloc (&arena, 500);
 
-    ddl_rec.owner_name = (char *)malloc(500);
+    ddl_rec.owner_name = (char *)exit_arena_alloc (&arena, 500);
     ddl_rec.owner_max_length = 500;
 
     ddl_rec.ddl_text_max_length = 1000;
-    ddl_rec.ddl_text = (char *)malloc(1000);
+    ddl_rec.ddl_text = (char *)exit_arena_alloc (&arena, 1000);
 
     /* Get DDL properties */
     call_callback (GET_DDL_RECORD_PROPERTIES, &ddl_rec, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving DDL properties.\n", result_code);
-        free(ddl_rec.ddl_type);
-        free(ddl_rec.object_type);
-        free(ddl_rec.object_name);
-        free(ddl_rec.owner_name);
-        free(ddl_rec.ddl_text);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving DDL properties.\n", result_code);
         return result_code;
     }
 
@@ -741,17 +608,10 @@ short display_ddl (short source_or_target,
                                          ddl_rec.object_name);
     output_msg ("----------------------------------------- \n");
 
-    free(ddl_rec.ddl_type);
-    free(ddl_rec.object_type);
-    free(ddl_rec.object_name);
-    free(ddl_rec.owner_name);
-    free(ddl_rec.ddl_text);
-
-
     /* initialize env_value*/
     memset (&env_value, 0, sizeof(env_value_def));
     env_value.max_length = 500;
-    env_value.buffer = (char *)malloc(500);
+    env_value.buffer = (char *)exit_arena_alloc (&arena, 500);
     if (source_or_target == EXIT_FN_CURRENT_VAL)
         env_value.source_or_target = EXIT_FN_TARGET_VAL;
     else
@@ -761,8 +621,7 @@ short display_ddl (short source_or_target,
     call_callback (GET_TABLE_NAME_ONLY, &env_value, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving table name.\n", result_code);
-        free (env_value.buffer);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving table name.\n", result_code);
         return result_code;
     }
     output_msg ("Table   name only: %.*s \n",
@@ -772,8 +631,7 @@ short display_ddl (short source_or_target,
     call_callback (GET_OBJECT_NAME_ONLY, &env_value, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving object name.\n", result_code);
-        free (env_value.buffer);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving object name.\n", result_code);
         return result_code;
     }
     output_msg ("Object  name only: %.*s \n",
@@ -783,8 +641,7 @@ short display_ddl (short source_or_target,
     call_callback (GET_SCHEMA_NAME_ONLY, &env_value, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving schema name.\n", result_code);
-        free (env_value.buffer);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving schema name.\n", result_code);
         return result_code;
     }
     output_msg ("Schema  name only: %.*s \n",
@@ -794,8 +651,7 @@ short display_ddl (short source_or_target,
     call_callback (GET_CATALOG_NAME_ONLY, &env_value, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving catalog name.\n", result_code);
-        free (env_value.buffer);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving catalog name.\n", result_code);
         return result_code;
     }
     output_msg ("Catalog name only: %.*s \n",
@@ -805,8 +661,7 @@ short display_ddl (short source_or_target,
     call_callback (GET_TABLE_NAME, &env_value, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving fully qualified table name.\n", result_code);
-        free (env_value.buffer);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving fully qualified table name.\n", result_code);
         return result_code;
     }
 
@@ -817,8 +672,7 @@ short display_ddl (short source_or_target,
     call_callback (GET_OBJECT_NAME, &env_value, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving fully qualified object name.\n", result_code);
-        free (env_value.buffer);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving fully qualified object name.\n", result_code);
         return result_code;
     }
     output_msg ("Object  name full: %.*s \n",
@@ -828,8 +682,7 @@ short display_ddl (short source_or_target,
     call_callback (GET_BASE_OBJECT_NAME_ONLY, &env_value, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving base object name.\n", result_code);
-        free (env_value.buffer);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving base object name.\n", result_code);
         return result_code;
     }
     output_msg ("Base object name only: %.*s \n",
@@ -839,8 +692,7 @@ short display_ddl (short source_or_target,
     call_callback (GET_BASE_SCHEMA_NAME_ONLY, &env_value, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving base schema name.\n", result_code);
-        free (env_value.buffer);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving base schema name.\n", result_code);
         return result_code;
     }
     output_msg ("Base schema name only: %.*s \n",
@@ -850,49 +702,149 @@ short display_ddl (short source_or_target,
     call_callback (GET_BASE_OBJECT_NAME, &env_value, &result_code);
     if (result_code != EXIT_FN_RET_OK)
     {
-        output_msg ("Error (%hd) retrieving fully qualified base object name.\n", result_code);
-        free (env_value.buffer);
+        exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving fully qualified base object name.\n", result_code);
         return result_code;
     }
     output_msg ("Base object name full: %.*s \n",
                  env_value.actual_length, env_value.buffer);
 
-    free(env_value.buffer);
     return EXIT_FN_RET_OK;
 }
 
 /***************************************************************************
-  ER user exit object called from various user exit points in extract and
-  replicat.
+  Decide whether the current record gets its per-record diagnostics: in
+  verbose mode, if the sampler takes it and this second's report output
+  has room for it.  DDL records are sampled as one stream, not by table.
 ***************************************************************************/
-#ifdef WIN32
-__declspec(dllexport) void CUSEREXIT (exit_call_type_def exit_call_type,
-                      exit_result_def    *exit_call_result,
-                      exit_params_def    *exit_params)
-#else
-void CUSEREXIT (exit_call_type_def exit_call_type,
-                exit_result_def    *exit_call_result,
-                exit_params_def    *exit_params)
-#endif
+short sample_diagnostics (short is_ddl)
+{
+    short result_code;
+    table_meta *meta = NULL;
+
+    if (!verbose_diagnostics || exit_log_rate_exceeded ())
+        return 0;
+    if (!is_ddl && exit_sample_by_table (&samples))
+        meta = current_table_metadata (EXIT_FN_SOURCE_VAL, &result_code);
+    return (short)exit_sample_take (&samples, meta ? meta->table_name : NULL,
+                                    meta ? meta->name_length : 0);
+}
+
+/***************************************************************************
+  Display the TK-HOST user token.
+***************************************************************************/
+void display_host_token (void)
+{
+    const char *host;
+    long length;
+
+    host = exit_token_value (&tokens, host_token, &length);
+    if (host && length > 0)
+    {
+        output_msg ("\nGET_TOKEN_VALUE for Token TK-HOST giving HOSTNAME %s ",
+                    host);
+    }
+}
+
+/***************************************************************************
+  Display the table and column metadata of a record.
+***************************************************************************/
+short display_table_metadata (record_def *record)
+{
+    short result_code;
+    short i;
+    table_meta *meta;
+    table_meta_column *column;
+
+    meta = current_table_metadata (record->mapped ? EXIT_FN_TARGET_VAL :
+                                                    EXIT_FN_SOURCE_VAL,
+                                   &result_code);
+    if (!meta)
+        return result_code;
+
+    output_msg ("*** GET_TABLE_METADATA ***\n");
+    output_msg ("table_name: (%s)\n  num_columns: (%hd)\n"
+        "num_key_columns (%hd)\n key_columns0 (%hd)\n using_pseudo_key (%hd)\n"
+        "source_or_target (%hd)\n num_user_columns (%hd)\n", meta->table_name,
+        meta->num_columns,
+        meta->num_key_columns,
+        meta->num_key_columns ? meta->key_columns[0] : (short)-1,
+        meta->using_pseudo_key, meta->source_or_target,
+        meta->num_user_columns);
+
+    for (i = 0; i < meta->num_columns; i++)
+    {
+        column = &meta->columns[i];
+
+        output_msg ("*** GET_COL_METADATA_FROM_INDEX *** \n");
+        output_msg ("column_name: (%s)\n native_data_type: (%hd)\n"
+            "gg_data_type (%hd)\n gg_sub_data_type (%hd)\n is_nullable (%hd)\n"
+            "is_part_of_key (%hd)\n length (%ld)\n precision (%ld)\n scale (%hd)\n"
+            "source_or_target (%hd).\n KEYCOLIDX %hd\n is_hidden_column (%hd)\n", column->name,
+            column->native_data_type,
+            column->gg_data_type, column->gg_sub_data_type, column->is_nullable,
+            column->is_part_of_key, column->length, column->precision, column->scale,
+            meta->source_or_target, column->key_column_index,
+            column->is_hidden_column);
+    }
+
+    return EXIT_FN_RET_OK;
+}
+
+/***************************************************************************
+  Processing stage of a batched transaction: count the operations and, at
+  DEBUG, list the records.  The report lines of the whole transaction go
+  out with the one exit_log_flush() at EXIT_CALL_END_TRANS.
+***************************************************************************/
+static int summarize_batched_record (const exit_txn_record *record,
+                                     void *context)
+{
+    batch_summary *summary = (batch_summary *)context;
+
+    switch (record->io_type)
+    {
+        case INSERT_VAL:
+            summary->inserts++;
+            break;
+        case UPDATE_VAL:
+        case UPDATE_COMP_SQL_VAL:
+        case UPDATE_COMP_PK_SQL_VAL:
+        case UNIFIED_UPDATE_COMP_SQL_VAL:
+        case UNIFIED_UPDATE_COMP_PK_SQL_VAL:
+            summary->updates++;
+            break;
+        case DELETE_VAL:
+            summary->deletes++;
+            break;
+        default:
+            summary->others++;
+            break;
+    }
+
+    exit_log (EXIT_LOG_DEBUG, "  Batched operation (%hd) on %s, %hd columns\n",
+              record->io_type, exit_txn_record_table_name (record),
+              record->num_columns);
+    return 1;
+}
+
+/***************************************************************************
+  Handle one call of the user exit, for CUSEREXIT.
+***************************************************************************/
+static void process_exit_call (exit_call_type_def exit_call_type,
+                               exit_result_def    *exit_call_result,
+                               exit_params_def    *exit_params)
 {
     static short callback_opened = 0;
     short result_code;
     char table_name[200];
     char column_name_buf[200];
-    char print_msg[500];
-    exit_rec_buf_def *record_buffer = NULL;
-    exit_rec_buf_ascii_def *ascii_record_buffer = NULL;
-    record_def *record = NULL;
-    position_def *position_rec = NULL;
-    token_value_def *token_rec = NULL;
+    static exit_rec_buf_def *record_buffer = NULL;
+    static exit_rec_buf_ascii_def *ascii_record_buffer = NULL;
+    static record_def *record = NULL;
     marker_info_def marker_info;
     error_info_def error_info;
     statistics_def statistics;
     env_value_def env_value;
     column_def column;
-    col_metadata_def col_meta;
-    table_metadata_def table_meta;
-    table_def table;
     session_def    session_cs;
     database_defs  dbMetadata;
     event_record_def event_record;
@@ -903,7 +855,9 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
     char srcDB_locale[200];
     char tgtDB_locale[200];
     size_t actualLen;
-    char ue_name[200];
+    exit_param *param;
+    short sampled;
+    batch_summary summary;
 
     char *dbObjTyp [] = {
            "GENERIC",
@@ -927,16 +881,6 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
            "MEMBER"
      };
 
-    uint32_t seqno;
-    int32_t rba;
-
-    typedef struct
-    {
-        char ch_seqno[4];
-        char ch_rba[4];
-    } char_position;
-    char_position position_char;
-
     if (!callback_opened)
     {
         callback_opened = 1;
@@ -955,16 +899,116 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
 #endif
     }
 
-    record = (record_def *) malloc(sizeof (record_def));
-    record_buffer = (exit_rec_buf_def *) malloc(sizeof(exit_rec_buf_def));
-    ascii_record_buffer  = (exit_rec_buf_ascii_def *) malloc(sizeof (exit_rec_buf_ascii_def));
+    /* Scratch memory of the previous call is released here, so an early
+       return below never leaks it */
+    exit_arena_reset (&arena);
+
+    /* The record buffers are allocated by the first call and kept until
+       EXIT_CALL_STOP; their pages are only touched once a record fills
+       them */
+    if (!record)
+    {
+        record = (record_def *) malloc(sizeof (record_def));
+        record_buffer = (exit_rec_buf_def *) malloc(sizeof(exit_rec_buf_def));
+        ascii_record_buffer  = (exit_rec_buf_ascii_def *) malloc(sizeof (exit_rec_buf_ascii_def));
+        if (!record || !record_buffer || !ascii_record_buffer)
+        {
+            printf ("Error allocating the user exit record buffers.\n");
+            free (record);
+            free (record_buffer);
+            free (ascii_record_buffer);
+            record = NULL;
+            *exit_call_result = EXIT_ABEND_VAL;
+            return;
+        }
+    }
 
     switch (exit_call_type)
     {
         case EXIT_CALL_START:
+            exit_log_init (LOG_LEVEL_ENV);
             output_msg ("\nUser exit: EXIT_CALL_START.  Called from program: %s\n",
                         exit_params->program_name);
 
+            /* Size the scratch block once for the life of the process */
+            if (!exit_arena_init (&arena, EXIT_ARENA_SCRATCH))
+            {
+                exit_log (EXIT_LOG_ERROR, "Error allocating the user exit scratch memory.\n");
+                *exit_call_result = EXIT_ABEND_VAL;
+                return;
+            }
+
+            /* Per-record diagnostics are opt in and log at DEBUG */
+            if (getenv (VERBOSE_ENV) != NULL &&
+                strcmp (getenv (VERBOSE_ENV), "0") != 0 &&
+                exit_log_level < EXIT_LOG_DEBUG)
+                exit_log_level = EXIT_LOG_DEBUG;
+            verbose_diagnostics = exit_log_enabled (EXIT_LOG_DEBUG);
+            output_msg ("\nUser exit: log level %s (%s), per-record "
+                        "diagnostics %s (%s)\n",
+                        exit_log_level_name (exit_log_level), LOG_LEVEL_ENV,
+                        verbose_diagnostics ? "on" : "off", VERBOSE_ENV);
+
+            /* Time the callbacks, with a summary every interval */
+            exit_prof_init (PROFILE_ENV);
+            if (exit_prof_enabled)
+                output_msg ("\nUser exit: callback profile every %s seconds "
+                            "(%s)\n", getenv (PROFILE_ENV), PROFILE_ENV);
+
+            /* Sample the records dumped and cap the report rate, so
+               verbose mode can stay on under production load */
+            exit_sample_init (&samples, SAMPLE_ENV);
+            if (getenv (REPORT_RATE_ENV))
+            {
+                exit_log_rate_limit ((size_t)strtoul (getenv (REPORT_RATE_ENV),
+                                                      NULL, 10));
+                output_msg ("\nUser exit: report output limited to %s bytes "
+                            "per second (%s)\n", getenv (REPORT_RATE_ENV),
+                            REPORT_RATE_ENV);
+            }
+            if (verbose_diagnostics && samples.mode != EXIT_SAMPLE_ALL)
+                output_msg ("\nUser exit: %s %lu sampling of records (%s)\n",
+                            exit_sample_mode_name (samples.mode), samples.n,
+                            SAMPLE_ENV);
+
+            exit_position_init (&positions, POSITION_ENV,
+                                EXIT_POSITION_TRANSACTION);
+            output_msg ("\nUser exit: position sampling %s (%s)\n",
+                        exit_position_sampling_name (positions.sampling),
+                        POSITION_ENV);
+
+            /* Example of getting a token placed in a prior extract as
+               TABLE OWNER.TABLE, tokens (TK-HOST = @GETENV ("GGENVIRONMENT" , "HOSTNAME"));
+               It is read once per transaction */
+            host_token = exit_token_declare (&tokens, "TK-HOST");
+
+            /* Bloom prefilters are opt in as well */
+            if (getenv (BLOOM_ENV))
+            {
+                org_filter_bloom_threshold ((size_t)strtoul (getenv (BLOOM_ENV),
+                                                             NULL, 10));
+                output_msg ("\nUser exit: Bloom prefilter for IN lists of %s "
+                            "keys or more (%s)\n", getenv (BLOOM_ENV),
+                            BLOOM_ENV);
+            }
+
+            /* So is transaction batching; the value is the memory budget */
+            if (getenv (BATCH_ENV) != NULL &&
+                strcmp (getenv (BATCH_ENV), "0") != 0)
+            {
+                if (!exit_txn_init (&txn, (size_t)strtoul (getenv (BATCH_ENV),
+                                                           NULL, 10)))
+                {
+                    exit_log (EXIT_LOG_ERROR, "Error allocating the transaction buffer.\n");
+                    *exit_call_result = EXIT_ABEND_VAL;
+                    return;
+                }
+                batch_transactions = 1;
+                output_msg ("\nUser exit: transaction batching, %lu bytes "
+                            "in memory per transaction (%s)\n",
+                            (unsigned long) txn.budget, BATCH_ENV);
+            }
+
             /* Retrieve the default session character set */
             memset (&session_cs, 0, sizeof(session_cs));
             call_callback (GET_SESSION_CHARSET, &session_cs, &result_code);
@@ -1101,6 +1145,18 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
                }
             }
 
+            /* Compile the options and partition filter of a parameter
+               already known up front, so the first record does not pay
+               for them */
+            if (exit_params->function_param[0] &&
+                !exit_param_find (exit_params->function_param) &&
+                !compile_exit_param (exit_params->function_param))
+            {
+                *exit_call_result = EXIT_ABEND_VAL;
+                return;
+            }
+
+            exit_log_flush ();
             break;
 
         case EXIT_CALL_STOP:
@@ -1119,10 +1175,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
             if (result_code != EXIT_FN_RET_OK &&
                 result_code != EXIT_FN_RET_TABLE_NOT_FOUND)
             {
-                output_msg ("Error (%hd) retrieving statistics.\n", result_code);
-                free (record);
-                free (record_buffer);
-                free (ascii_record_buffer);
+                exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving statistics.\n", result_code);
                 *exit_call_result = EXIT_ABEND_VAL;
                 return;
             }
@@ -1154,10 +1207,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
             if (result_code != EXIT_FN_RET_OK &&
                 result_code != EXIT_FN_RET_TABLE_NOT_FOUND)
             {
-                output_msg ("Error (%hd) retrieving statistics.\n", result_code);
-                free (record);
-                free (record_buffer);
-                free (ascii_record_buffer);
+                exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving statistics.\n", result_code);
                 *exit_call_result = EXIT_ABEND_VAL;
                 return;
             }
@@ -1180,44 +1230,81 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
                             statistics.total_db_operations, statistics.total_operations);
             }
 
+            org_filter_report_bloom (report_bloom);
+            exit_param_free_all ();
+            org_filter_unload_all ();
+            if (batch_transactions)
+                output_msg ("\nUser exit: %lu batched transactions, %lu "
+                            "spilled to disk\n",
+                            (unsigned long) txn.num_transactions,
+                            (unsigned long) txn.num_spilled_transactions);
+            exit_txn_release (&txn);
+            if (samples.mode != EXIT_SAMPLE_ALL)
+                output_msg ("\nUser exit: %lu of %lu records sampled\n",
+                            samples.taken, samples.seen);
+            exit_sample_free (&samples);
+            exit_prof_report ();
+            exit_prof_free ();
+            if (tokens.num_lookups)
+                output_msg ("\nUser exit: %lu user token lookups, %lu "
+                            "GET_USER_TOKEN_VALUE calls\n",
+                            tokens.num_lookups, tokens.num_fetches);
+            exit_record_free (&record_view);
+            table_meta_free_all ();
+            exit_log_flush ();
             close_callback();
             break;
 
         case EXIT_CALL_BEGIN_TRANS:
             output_msg ("\nUser exit: EXIT_CALL_BEGIN_TRANS.\n");
+            exit_position_sample (&positions, EXIT_POSITION_TRANSACTION);
+            exit_token_begin (&tokens);
             break;
 
         case EXIT_CALL_END_TRANS:
             output_msg ("\nUser exit: EXIT_CALL_END_TRANS.\n");
-            break;
-
-        case EXIT_CALL_CHECKPOINT:
-            output_msg ("\nUser exit: EXIT_CALL_CHECKPOINT.\n");
-
-            position_rec = (position_def *) malloc (sizeof(position_def));
-            position_rec->position = (char *) malloc (sizeof (uint32_t) + sizeof (int32_t));  /* current expected size of seqno and rba */
 
-            position_rec->ascii_or_internal = EXIT_FN_INTERNAL_FORMAT;
-            position_rec->position_type = CURRENT_CHECKPOINT;
-            call_callback (GET_POSITION,  position_rec,&result_code);
-            if (!result_code)
+            /* Hand the transaction to the processing stage as one batch */
+            if (batch_transactions && exit_txn_count (&txn))
             {
-                memcpy (&position_char, position_rec->position, position_rec->position_len);
-                if (LittleEndian())
+                memset (&summary, 0, sizeof(summary));
+                if (!exit_txn_for_each (&txn, summarize_batched_record,
+                                        &summary))
                 {
-                    ReverseBytes (&position_char.ch_seqno, sizeof (position_char.ch_seqno));
-                    ReverseBytes (&position_char.ch_rba, sizeof (position_char.ch_rba));
+                    exit_log (EXIT_LOG_ERROR, "Error reading back the batched transaction.\n");
+                    exit_txn_reset (&txn);
+                    *exit_call_result = EXIT_ABEND_VAL;
+                    return;
                 }
+                exit_log (EXIT_LOG_INFO, "Transaction of %lu records: %ld inserts, "
+                          "%ld updates, %ld deletes, %ld other, %lu spilled\n",
+                          (unsigned long) exit_txn_count (&txn),
+                          summary.inserts, summary.updates, summary.deletes,
+                          summary.others, (unsigned long) txn.num_spilled);
+            }
+            exit_txn_reset (&txn);
+            exit_token_end (&tokens);
+            exit_log_flush ();
+            break;
 
-                memcpy (&seqno, position_char.ch_seqno, sizeof (seqno));
-                memcpy (&rba, &position_char.ch_rba[0], sizeof (rba));
-                sprintf (print_msg, "\nGET_POSITION CURRENT_CHECKPOINT, values seqno %ld rba %ld\n",
-                                                                       (long) seqno, (long) rba );
+        case EXIT_CALL_ABORT_TRANS:
+            output_msg ("\nUser exit: EXIT_CALL_ABORT_TRANS.\n");
 
-                call_callback (OUTPUT_MESSAGE_TO_REPORT, &print_msg, &result_code);
-            }
-            free(position_rec->position);
-            free(position_rec);
+            /* The transaction is rolled back, drop what was batched */
+            exit_txn_reset (&txn);
+            exit_token_end (&tokens);
+            break;
+
+        case EXIT_CALL_CHECKPOINT:
+            output_msg ("\nUser exit: EXIT_CALL_CHECKPOINT.\n");
+
+            /* Pick up edits to the Org Id init files, off the record path */
+            if (org_filter_reload_changed (report_partition_filter))
+                exit_param_refresh_filters ();
+
+            exit_position_sample (&positions, EXIT_POSITION_CHECKPOINT);
+            exit_prof_checkpoint ();
+            exit_log_flush ();
             break;
 
         case EXIT_CALL_PROCESS_MARKER:
@@ -1228,10 +1315,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
             call_callback (GET_MARKER_INFO, &marker_info, &result_code);
             if (result_code != EXIT_FN_RET_OK)
             {
-                output_msg ("Error (%hd) retrieving marker information.\n", result_code);
-                free (record);
-                free (record_buffer);
-                free (ascii_record_buffer);
+                exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving marker information.\n", result_code);
                 *exit_call_result = EXIT_ABEND_VAL;
                 return;
             }
@@ -1249,61 +1333,21 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
             break;
 
         case EXIT_CALL_PROCESS_RECORD:
-            output_msg ("\nUser exit: EXIT_CALL_PROCESS_RECORD.\n");
-
-            position_rec = (position_def *) malloc (sizeof(position_def));
-            position_rec->position = (char *) malloc (sizeof (uint32_t) + sizeof (int32_t));  /* current expected size of seqno and rba */
-
-            position_rec->ascii_or_internal = EXIT_FN_INTERNAL_FORMAT;
-            position_rec->position_type = STARTUP_CHECKPOINT;
-            call_callback (GET_POSITION,  position_rec,&result_code);
-            if (!result_code)
-            {
-                memcpy (&position_char, position_rec->position, position_rec->position_len);
-                if (LittleEndian())
-                {
-                    ReverseBytes (&position_char.ch_seqno, sizeof (position_char.ch_seqno));
-                    ReverseBytes (&position_char.ch_rba, sizeof (position_char.ch_rba));
-                }
-                memcpy (&seqno, position_char.ch_seqno, sizeof (seqno));
-                memcpy (&rba, position_char.ch_rba, sizeof (rba));
-                sprintf (print_msg, "\nGET_POSITION STARTUP_CHECKPOINT, values seqno %ld rba %ld\n",
-                                                                       (long) seqno, (long) rba );
-                call_callback (OUTPUT_MESSAGE_TO_REPORT, &print_msg, &result_code);
-            }
-
-            position_rec->ascii_or_internal = EXIT_FN_INTERNAL_FORMAT;
-            position_rec->position_type = CURRENT_CHECKPOINT;
-            call_callback (GET_POSITION,  position_rec,&result_code);
-            if (!result_code)
-            {
-                memcpy (&position_char, position_rec->position, position_rec->position_len);
-                if (LittleEndian())
-                {
-                    ReverseBytes (&position_char.ch_seqno, sizeof (position_char.ch_seqno));
-                    ReverseBytes (&position_char.ch_rba, sizeof (position_char.ch_rba));
-                }
-                memcpy (&seqno, position_char.ch_seqno, sizeof (seqno));
-                memcpy (&rba, position_char.ch_rba, sizeof (rba));
-                sprintf (print_msg, "\nGET_POSITION CURRENT_CHECKPOINT, values seqno %ld rba %ld\n",
-                                                                       (long) seqno, (long) rba );
-                call_callback (OUTPUT_MESSAGE_TO_REPORT, &print_msg, &result_code);
-            }
-
-            free(position_rec->position);
-            free(position_rec);
-
-            memset (record, 0, sizeof(record));
+            if (verbose_diagnostics && samples.mode == EXIT_SAMPLE_ALL)
+                output_msg ("\nUser exit: EXIT_CALL_PROCESS_RECORD.\n");
+            exit_position_sample (&positions, EXIT_POSITION_RECORD);
+
+            /* Fast path: a record rejected by the partition filter costs
+               GET_OPERATION_TYPE and the filter probe only, diagnostics
+               are reported for accepted records in verbose mode */
+            memset (record, 0, sizeof(record_def));
             record->source_or_target = EXIT_FN_SOURCE_VAL;
             record->buffer = (char *) record_buffer;
 
             call_callback (GET_OPERATION_TYPE, record, &result_code);
             if (result_code != EXIT_FN_RET_OK)
             {
-                output_msg ("Error (%hd) retrieving operation type.\n", result_code);
-                free (record);
-                free (record_buffer);
-                free (ascii_record_buffer);
+                exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving operation type.\n", result_code);
                 *exit_call_result = EXIT_ABEND_VAL;
                 return;
             }
@@ -1311,16 +1355,22 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
             /* Process DDL Commands */
             if (record->io_type == SQL_DDL_VAL)
             {
+                /* The DDL may change the table's columns or key */
+                invalidate_ddl_object (EXIT_FN_SOURCE_VAL);
+                invalidate_ddl_object (EXIT_FN_TARGET_VAL);
+
+                if (!sample_diagnostics (1))
+                    break;
+
+                if (samples.mode != EXIT_SAMPLE_ALL)
+                    output_msg ("\nUser exit: EXIT_CALL_PROCESS_RECORD.\n");
                 output_msg ("\n*** SOURCE DDL COMMAND***\n");
                 result_code = display_ddl (EXIT_FN_SOURCE_VAL,
                                            EXIT_FN_INTERNAL_FORMAT);
                 if (result_code != EXIT_FN_RET_OK)
                 {
-                    output_msg ("Error (%hd) displaying DDL information.\n",
-                                 result_code);
-                    free (record);
-                    free (record_buffer);
-                    free (ascii_record_buffer);
+                    exit_log (EXIT_LOG_ERROR, "Error (%hd) displaying DDL information.\n",
+                               result_code);
                     *exit_call_result = EXIT_ABEND_VAL;
                     return;
                 }
@@ -1331,71 +1381,46 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
                                            EXIT_FN_INTERNAL_FORMAT);
                 if (result_code != EXIT_FN_RET_NOT_SUPPORTED && result_code != EXIT_FN_RET_OK)
                 {
-                    output_msg ("Error (%hd) displaying DDL information.\n",
-                                 result_code);
-                    free (record);
-                    free (record_buffer);
-                    free (ascii_record_buffer);
+                    exit_log (EXIT_LOG_ERROR, "Error (%hd) displaying DDL information.\n",
+                               result_code);
                     *exit_call_result = EXIT_ABEND_VAL;
                     return;
                 }
                 break;
             }
 
-            /* Example of getting a token placed in a prior extract as
-               TABLE OWNER.TABLE, tokens (TK-HOST = @GETENV ("GGENVIRONMENT" , "HOSTNAME"));
-            */
-
-            token_rec = (token_value_def *) malloc (sizeof(token_value_def));
-            token_rec->max_length = 50;
-            token_rec->token_value = (char *) malloc (token_rec->max_length + 1);
-            token_rec->token_name = (char *) malloc (sizeof ("TK-HOST"));
-            strcpy (token_rec->token_name, "TK-HOST");
-            call_callback (GET_USER_TOKEN_VALUE, token_rec, &result_code);
-
-            if (token_rec->actual_length > 0)
-            {
-                sprintf ( print_msg, "\nGET_TOKEN_VALUE for Token TK-HOST giving HOSTNAME %s ", token_rec->token_value);
-                call_callback (OUTPUT_MESSAGE_TO_REPORT, &print_msg, &result_code);
-            }
-            free(token_rec->token_name);
-            free(token_rec->token_value);
-            free(token_rec);
-
             /* An example of how a user exit parameter can be used...
 
                We can ignore deletes on the TCUSTMER table by specifying the
                following in the EXTRACT/REPLICAT parameter file:
-               MAP TCUSTMER, TARGET TCUSTMER, EXITPARAM "IGNOREDELETES" */
+               MAP TCUSTMER, TARGET TCUSTMER, EXITPARAM "IGNOREDELETES"
+
+               The options of each distinct EXITPARAM are parsed, and the
+               partition filter it names compiled, on first use */
 
-            if (!strcmp (exit_params->function_param, "IGNOREDELETES") &&
-                record->io_type == DELETE_VAL)
+            param = exit_param_find (exit_params->function_param);
+            if (!param)
             {
-                free (record);
-                free (record_buffer);
-                free (ascii_record_buffer);
-                *exit_call_result = EXIT_IGNORE_VAL;
-                return;
+                param = compile_exit_param (exit_params->function_param);
+                if (!param)
+                {
+                    *exit_call_result = EXIT_ABEND_VAL;
+                    return;
+                }
             }
 
-            call_callback (GET_RECORD_BUFFER, record, &result_code);
-            if (result_code != EXIT_FN_RET_OK)
+            if (param->ignore_deletes && record->io_type == DELETE_VAL)
             {
-                output_msg ("Error (%hd) retrieving record buffer.\n", result_code);
-                free (record);
-                free (record_buffer);
-                free (ascii_record_buffer);
-                *exit_call_result = EXIT_ABEND_VAL;
+                *exit_call_result = EXIT_IGNORE_VAL;
                 return;
             }
 
-            output_msg ("Processing record with operation type (%hd).\n",
-                        record->io_type);
+            if (verbose_diagnostics && samples.mode == EXIT_SAMPLE_ALL)
+                output_msg ("\n*** SOURCE RECORD ***\n");
 
-            output_msg ("\n*** SOURCE RECORD ***\n");
-            strcpy (ue_name, exit_params->function_param);
             result_code = partition_filter (EXIT_FN_SOURCE_VAL,
-                                                      EXIT_FN_INTERNAL_FORMAT,ue_name);
+                                            EXIT_FN_INTERNAL_FORMAT,
+                                            param->filter);
 
             //result_code = display_record (EXIT_FN_SOURCE_VAL,
                                           //EXIT_FN_INTERNAL_FORMAT);
@@ -1408,105 +1433,55 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
 
             if (result_code != EXIT_FN_RET_OK)
             {
-                output_msg ("Error (%hd) displaying source column values.\n", result_code);
-                free (record);
-                free (record_buffer);
-                free (ascii_record_buffer);
+                exit_log (EXIT_LOG_ERROR, "Error (%hd) displaying source column values.\n", result_code);
                 *exit_call_result = EXIT_ABEND_VAL;
                 return;
             }
 
-            memset (&table, 0, sizeof(table_def));
-
-            if (record->mapped)
-                table.source_or_target = EXIT_FN_TARGET_VAL;
-            else
-                table.source_or_target = EXIT_FN_SOURCE_VAL;
-
-            call_callback (GET_TABLE_COLUMN_COUNT, &table, &result_code);
-            if (result_code != EXIT_FN_RET_OK)
+            /* Keep the accepted record for the end of the transaction */
+            if (batch_transactions)
             {
-                output_msg ("Error (%hd) retrieving table column count.\n", result_code);
-                free (record);
-                free (record_buffer);
-                free (ascii_record_buffer);
-                *exit_call_result = EXIT_ABEND_VAL;
-               return;
+                result_code = exit_record_load (&record_view, EXIT_FN_SOURCE_VAL,
+                                                EXIT_FN_INTERNAL_FORMAT);
+                if (result_code != EXIT_FN_RET_OK ||
+                    !exit_txn_add (&txn, &record_view, record->io_type))
+                {
+                    exit_log (EXIT_LOG_ERROR, "Error (%hd) batching the record.\n", result_code);
+                    *exit_call_result = EXIT_ABEND_VAL;
+                    return;
+                }
             }
 
-            memset (&table_meta, 0, sizeof(table_meta));
-            if (record->mapped)
-                table_meta.source_or_target = EXIT_FN_TARGET_VAL;
-            else
-                table_meta.source_or_target = EXIT_FN_SOURCE_VAL;
-            table_meta.table_name = (char *)malloc(100);
-            table_meta.max_name_length = 100;
-            table_meta.key_columns = (short *)malloc( table.num_key_columns *  sizeof(short)); /* Must know the number of expected keys */
-
-            call_callback (GET_TABLE_METADATA, &table_meta, &result_code);
+            call_callback (GET_RECORD_BUFFER, record, &result_code);
             if (result_code != EXIT_FN_RET_OK)
             {
-                output_msg ("Error (%hd) retrieving table metadata.\n", result_code);
-                free (table_meta.table_name);
-                free (table_meta.key_columns);
-                free (record);
-                free (record_buffer);
-                free (ascii_record_buffer);
+                exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving record buffer.\n", result_code);
                 *exit_call_result = EXIT_ABEND_VAL;
                 return;
             }
 
-            output_msg ("*** GET_TABLE_METADATA ***\n");
-            output_msg ("table_name: (%s)\n  num_columns: (%hd)\n"
-                "num_key_columns (%hd)\n key_columns0 (%hd)\n using_pseudo_key (%hd)\n"
-                "source_or_target (%hd)\n num_user_columns (%hd)\n", table_meta.table_name,
-                table_meta.num_columns,
-                table_meta.num_key_columns, table_meta.key_columns[0],
-                table_meta.using_pseudo_key, table_meta.source_or_target,
-                table_meta.num_user_columns);
-
-            free (table_meta.table_name);
-            free (table_meta.key_columns);
-
-            memset (&col_meta, 0, sizeof(col_meta));
-            if (record->mapped)
-                col_meta.source_or_target = EXIT_FN_TARGET_VAL;
-            else
-                col_meta.source_or_target = EXIT_FN_SOURCE_VAL;
-            col_meta.source_or_target = EXIT_FN_SOURCE_VAL;
-            col_meta.column_name = (char *)malloc(100);
-            col_meta.max_name_length = 100;
+            /* Diagnostics of the accepted record, if sampled */
+            sampled = sample_diagnostics (0);
+            if (sampled && samples.mode != EXIT_SAMPLE_ALL)
+                output_msg ("\nUser exit: EXIT_CALL_PROCESS_RECORD.\n"
+                            "\n*** SOURCE RECORD ***\n");
 
-            for (i=0; i < table.num_columns;i++)
+            if (sampled)
             {
-                col_meta.column_index = i;
+                display_host_token ();
+
+                output_msg ("Processing record with operation type (%hd).\n",
+                            record->io_type);
 
-                call_callback (GET_COL_METADATA_FROM_INDEX, &col_meta, &result_code);
+                result_code = display_table_metadata (record);
                 if (result_code != EXIT_FN_RET_OK)
                 {
-                    output_msg ("Error (%hd) retrieving column metadata.\n", result_code);
-                    free (col_meta.column_name);
-                    free (record);
-                    free (record_buffer);
-                    free (ascii_record_buffer);
                     *exit_call_result = EXIT_ABEND_VAL;
                     return;
                 }
-
-                output_msg ("*** GET_COL_METADATA_FROM_INDEX *** \n");
-                output_msg ("column_name: (%s)\n native_data_type: (%hd)\n"
-                    "gg_data_type (%hd)\n gg_sub_data_type (%hd)\n is_nullable (%hd)\n"
-                    "is_part_of_key (%hd)\n length (%hd)\n precision (%hd)\n scale (%hd)\n"
-                    "source_or_target (%hd).\n KEYCOLIDX %hd\n is_hidden_column (%hd)\n", col_meta.column_name,
-                    col_meta.native_data_type,
-                    col_meta.gg_data_type, col_meta.gg_sub_data_type, col_meta.is_nullable,
-                    col_meta.is_part_of_key, col_meta.length, col_meta.precision, col_meta.scale,
-                    col_meta.source_or_target, col_meta.key_column_index,
-                    col_meta.is_hidden_column);
             }
-            free (col_meta.column_name);
 
-            if (record->mapped) /* We have a target record */
+            if (sampled && record->mapped) /* We have a target record */
             {
                 output_msg ("\n*** TARGET RECORD ***\n");
                 result_code = display_record (EXIT_FN_TARGET_VAL,
@@ -1519,10 +1494,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
                 }
                 if (result_code != EXIT_FN_RET_OK)
                 {
-                    output_msg ("Error (%hd) displaying target column values.\n", result_code);
-                    free (record);
-                    free (record_buffer);
-                    free (ascii_record_buffer);
+                    exit_log (EXIT_LOG_ERROR, "Error (%hd) displaying target column values.\n", result_code);
                     *exit_call_result = EXIT_ABEND_VAL;
                     return;
                 }
@@ -1532,7 +1504,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
                 column.source_or_target = EXIT_FN_CURRENT_VAL;
 
                 memset (&error_info, 0, sizeof(error_info));
-                error_info.error_msg = (char *)malloc(500);
+                error_info.error_msg = (char *)exit_arena_alloc (&arena, 500);
                 error_info.max_length = 500; /* Including null terminator */
 
                 call_callback (FETCH_CURRENT_RECORD_WITH_LOCK, &error_info, &result_code);
@@ -1540,31 +1512,22 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
                     result_code != EXIT_FN_RET_NOT_SUPPORTED)
                 {
                     if (result_code == EXIT_FN_RET_FETCH_ERROR)
-                        output_msg ("SQL error (%ld, %s) fetching current record.\n",
-                                    error_info.error_num, error_info.error_msg);
+                        exit_log (EXIT_LOG_ERROR, "SQL error (%ld, %s) fetching current record.\n",
+                                  error_info.error_num, error_info.error_msg);
                     else
-                        output_msg ("Error (%hd) fetching current record.\n", result_code);
+                        exit_log (EXIT_LOG_ERROR, "Error (%hd) fetching current record.\n", result_code);
 
-                    free (record);
-                    free (record_buffer);
-                    free (ascii_record_buffer);
                     *exit_call_result = EXIT_ABEND_VAL;
-                    free (error_info.error_msg);
                     return;
                 }
 
-                free (error_info.error_msg);
-
                 if (result_code == EXIT_FN_RET_OK)
                 {
                     result_code = display_record (EXIT_FN_CURRENT_VAL,
                                                   EXIT_FN_INTERNAL_FORMAT);
                     if (result_code != EXIT_FN_RET_OK)
                     {
-                        output_msg ("Error (%hd) displaying current column values.\n", result_code);
-                        free (record);
-                        free (record_buffer);
-                        free (ascii_record_buffer);
+                        exit_log (EXIT_LOG_ERROR, "Error (%hd) displaying current column values.\n", result_code);
                         *exit_call_result = EXIT_ABEND_VAL;
                         return;
                     }
@@ -1578,17 +1541,13 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
             /* Get target table name */
             memset (&env_value, 0, sizeof(env_value_def));
             env_value.source_or_target = EXIT_FN_TARGET_VAL;
-            env_value.buffer = (char *)malloc(500);
+            env_value.buffer = (char *)exit_arena_alloc (&arena, 500);
             env_value.max_length = 500;
 
             call_callback (GET_TABLE_NAME_ONLY, &env_value, &result_code);
             if (result_code != EXIT_FN_RET_OK)
             {
-                output_msg ("Error (%hd) retrieving table name.\n", result_code);
-                free (env_value.buffer);
-                free (record);
-                free (record_buffer);
-                free (ascii_record_buffer);
+                exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving table name.\n", result_code);
                 *exit_call_result = EXIT_ABEND_VAL;
                 return;
             }
@@ -1605,7 +1564,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
                 else
                     column.source_or_target = EXIT_FN_SOURCE_VAL;
                 column.column_value_mode = EXIT_FN_ASCII_FORMAT;
-                column.column_value = (char*)malloc(4000);
+                column.column_value = (char*)exit_arena_alloc (&arena, 4000);
                 column.max_value_length = 4000;
                 column.column_name = column_name_buf;
 
@@ -1615,13 +1574,8 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
                 if (result_code != EXIT_FN_RET_OK &&
                     result_code != EXIT_FN_RET_COLUMN_NOT_FOUND)
                 {
-                    output_msg ("Error (%hd) retrieving column value.\n",
-                                 result_code);
-                    free (env_value.buffer);
-                    free (column.column_value);
-                    free (record);
-                    free (record_buffer);
-                    free (ascii_record_buffer);
+                    exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving column value.\n",
+                               result_code);
                     *exit_call_result = EXIT_ABEND_VAL;
                     return;
                 }
@@ -1637,12 +1591,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
                     call_callback (SET_COLUMN_VALUE_BY_NAME, &column, &result_code);
                     if (result_code != EXIT_FN_RET_OK)
                     {
-                        output_msg ("Error (%hd) setting column value.\n", result_code);
-                        free (env_value.buffer);
-                        free (column.column_value);
-                        free (record);
-                        free (record_buffer);
-                        free (ascii_record_buffer);
+                        exit_log (EXIT_LOG_ERROR, "Error (%hd) setting column value.\n", result_code);
                         *exit_call_result = EXIT_ABEND_VAL;
                         return;
                     }
@@ -1657,50 +1606,37 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
                         call_callback (SET_COLUMN_VALUE_BY_NAME, &column, &result_code);
                         if (result_code != EXIT_FN_RET_OK)
                         {
-                            output_msg ("Error (%hd) setting column value.\n", result_code);
-                            free (env_value.buffer);
-                            free (column.column_value);
-                            free (record);
-                            free (record_buffer);
-                            free (ascii_record_buffer);
+                            exit_log (EXIT_LOG_ERROR, "Error (%hd) setting column value.\n", result_code);
                             *exit_call_result = EXIT_ABEND_VAL;
                             return;
                         }
                     }
                 }
 
-                free (column.column_value);
             }
 
-            free (env_value.buffer);
             break;
 
         case EXIT_CALL_DISCARD_ASCII_RECORD:
             output_msg ("\nUser exit: EXIT_CALL_DISCARD_ASCII_RECORD.\n");
 
             memset (&error_info, 0, sizeof(error_info));
-            error_info.error_msg = (char *)malloc(500);
+            error_info.error_msg = (char *)exit_arena_alloc (&arena, 500);
             error_info.max_length = 500; /* Including null terminator */
 
             call_callback (GET_ERROR_INFO, &error_info, &result_code);
             if (result_code != EXIT_FN_RET_OK)
             {
-                output_msg ("Error (%hd) retrieving error information.\n", result_code);
-                free (error_info.error_msg);
-                free (record);
-                free (record_buffer);
-                free (ascii_record_buffer);
+                exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving error information.\n", result_code);
                 *exit_call_result = EXIT_ABEND_VAL;
                 return;
             }
 
-            output_msg ("Error information:\n"
-                        "Error number: %ld.\n"
-                        "Error message: %s.\n\n",
-                        error_info.error_num,
-                        error_info.error_msg);
-
-            free (error_info.error_msg);
+            exit_log (EXIT_LOG_ERROR, "Error information:\n"
+                      "Error number: %ld.\n"
+                      "Error message: %s.\n\n",
+                      error_info.error_num,
+                      error_info.error_msg);
 
             memset (record, 0, sizeof(record));
             record->source_or_target = EXIT_FN_SOURCE_VAL;
@@ -1709,10 +1645,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
             call_callback (GET_RECORD_BUFFER, record, &result_code);
             if (result_code != EXIT_FN_RET_OK)
             {
-                output_msg ("Error (%hd) retrieving ASCII record buffer.\n", result_code);
-                free (record);
-                free (record_buffer);
-                free (ascii_record_buffer);
+                exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving ASCII record buffer.\n", result_code);
                 *exit_call_result = EXIT_ABEND_VAL;
                 return;
             }
@@ -1724,28 +1657,22 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
             output_msg ("\nUser exit: EXIT_CALL_DISCARD_RECORD.\n");
 
             memset (&error_info, 0, sizeof(error_info));
-            error_info.error_msg = (char *)malloc(500);
+            error_info.error_msg = (char *)exit_arena_alloc (&arena, 500);
             error_info.max_length = 500; /* Including null terminator */
 
             call_callback (GET_ERROR_INFO, &error_info, &result_code);
             if (result_code != EXIT_FN_RET_OK)
             {
-                output_msg ("Error (%hd) retrieving error information.\n", result_code);
-                free (error_info.error_msg);
-                free (record);
-                free (record_buffer);
-                free (ascii_record_buffer);
+                exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving error information.\n", result_code);
                 *exit_call_result = EXIT_ABEND_VAL;
                 return;
             }
 
-            output_msg ("Error information:\n"
-                        "Error number: %ld.\n"
-                        "Error message: %s.\n\n",
-                        error_info.error_num,
-                        error_info.error_msg);
-
-            free (error_info.error_msg);
+            exit_log (EXIT_LOG_ERROR, "Error information:\n"
+                      "Error number: %ld.\n"
+                      "Error message: %s.\n\n",
+                      error_info.error_num,
+                      error_info.error_msg);
 
             memset (record, 0, sizeof(record));
             record->source_or_target = EXIT_FN_SOURCE_VAL;
@@ -1754,10 +1681,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
             call_callback (GET_RECORD_BUFFER, record, &result_code);
             if (result_code != EXIT_FN_RET_OK)
             {
-                output_msg ("Error (%hd) retrieving ASCII record buffer.\n", result_code);
-                free (record);
-                free (record_buffer);
-                free (ascii_record_buffer);
+                exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving ASCII record buffer.\n", result_code);
                 *exit_call_result = EXIT_ABEND_VAL;
                 return;
             }
@@ -1766,10 +1690,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
                                           EXIT_FN_ASCII_FORMAT);
             if (result_code != EXIT_FN_RET_OK)
             {
-                output_msg ("Error (%hd) displaying source column values.\n", result_code);
-                free (record);
-                free (record_buffer);
-                free (ascii_record_buffer);
+                exit_log (EXIT_LOG_ERROR, "Error (%hd) displaying source column values.\n", result_code);
                 *exit_call_result = EXIT_ABEND_VAL;
                 return;
             }
@@ -1780,10 +1701,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
                                               EXIT_FN_ASCII_FORMAT);
                 if (result_code != EXIT_FN_RET_OK)
                 {
-                    output_msg ("Error (%hd) displaying target column values.\n", result_code);
-                    free (record);
-                    free (record_buffer);
-                    free (ascii_record_buffer);
+                    exit_log (EXIT_LOG_ERROR, "Error (%hd) displaying target column values.\n", result_code);
                     *exit_call_result = EXIT_ABEND_VAL;
                     return;
                 }
@@ -1794,7 +1712,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
             output_msg ("\nUser exit: EXIT_CALL_EVENT_RECORD.\n");
 
             /* allocate event object name storage */
-            event_record.object_name     = (char*)malloc(300);
+            event_record.object_name     = (char*)exit_arena_alloc (&arena, 300);
             event_record.max_name_length = 300;
 
             /* get event detail */
@@ -1802,11 +1720,7 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
 
             if (result_code != EXIT_FN_RET_OK)
             {
-                output_msg("Error (%hd) retrieving event record.\n", result_code);
-                free(event_record.object_name);
-                free(record);
-                free(record_buffer);
-                free(ascii_record_buffer);
+                exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving event record.\n", result_code);
                 *exit_call_result = EXIT_ABEND_VAL;
                 return;
             }
@@ -1822,6 +1736,12 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
             {
                 /* new or updated table metadata available */
                 output_msg("\nTable (%s) metadata event record.\n", event_record.object_name);
+
+                /* Column indexes of the table may have moved */
+                table_meta_invalidate (event_record.object_name,
+                                       event_record.actual_length);
+                org_table_columns_invalidate (event_record.object_name,
+                                              event_record.actual_length);
             }
             /* check if ref-table metadata record event */
             else if (event_record.event_id == EXIT_REF_TABLE_METADATA_EVENT)
@@ -1835,43 +1755,62 @@ void CUSEREXIT (exit_call_type_def exit_call_type,
                 output_msg("\nUnknown event identifier: %hd.\n", event_record.event_id);
             }
 
-            free(event_record.object_name);
-
             break;
 
         case EXIT_CALL_FATAL_ERROR:
             output_msg ("\nUser exit: EXIT_CALL_FATAL_ERROR.\n");
 
             memset (&error_info, 0, sizeof(error_info));
-            error_info.error_msg = (char *)malloc(500);
+            error_info.error_msg = (char *)exit_arena_alloc (&arena, 500);
             error_info.max_length = 500; /* Including null terminator */
 
             call_callback (GET_ERROR_INFO, &error_info, &result_code);
             if (result_code != EXIT_FN_RET_OK)
             {
-                output_msg ("Error (%hd) retrieving error information.\n", result_code);
-                free (error_info.error_msg);
-                free (record);
-                free (record_buffer);
-                free (ascii_record_buffer);
+                exit_log (EXIT_LOG_ERROR, "Error (%hd) retrieving error information.\n", result_code);
                 *exit_call_result = EXIT_ABEND_VAL;
                 return;
             }
 
-            output_msg ("Error information:\n"
-                        "Error number: %ld.\n"
-                        "Error message: %s.\n\n",
-                        error_info.error_num,
-                        error_info.error_msg);
+            exit_log (EXIT_LOG_ERROR, "Error information:\n"
+                      "Error number: %ld.\n"
+                      "Error message: %s.\n\n",
+                      error_info.error_num,
+                      error_info.error_msg);
 
-            free (error_info.error_msg);
+            exit_log_flush ();
             close_callback();
             break;
     }
 
-    free (record);
-    free (record_buffer);
-    free (ascii_record_buffer);
+    if (exit_call_type == EXIT_CALL_STOP)
+    {
+        free (record);
+        free (record_buffer);
+        free (ascii_record_buffer);
+        record = NULL;
+        exit_arena_release (&arena);
+    }
+
     *exit_call_result = EXIT_OK_VAL;
     fflush (stdout);
 }
+
+/***************************************************************************
+  ER user exit object called from various user exit points in extract and
+  replicat.  The call is traced as a whole, see exittrace.h.
+***************************************************************************/
+#ifdef WIN32
+__declspec(dllexport) void CUSEREXIT (exit_call_type_def exit_call_type,
+                      exit_result_def    *exit_call_result,
+                      exit_params_def    *exit_params)
+#else
+void CUSEREXIT (exit_call_type_def exit_call_type,
+                exit_result_def    *exit_call_result,
+                exit_params_def    *exit_params)
+#endif
+{
+    exit_trace_call_begin (exit_call_type);
+    process_exit_call (exit_call_type, exit_call_result, exit_params);
+    exit_trace_call_end (exit_call_type, *exit_call_result);
+}
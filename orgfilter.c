@@ -0,0 +1,2259 @@
+/**************************************************************************
+  Program description:
+
+  In-memory partition filter sets for the CUSEREXIT partition filter.
+  See orgfilter.h.
+
+***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <sys/stat.h>
+#ifndef WIN32
+  #include <sys/mman.h>
+#endif
+
+#include "SQLDataTypes.h"
+#include "orgfilter.h"
+
+/* Characters separating the keys of a filter file */
+#define ORG_FILTER_SEPARATORS " ,\t\r\n"
+
+/* Length of the compile error message */
+#define MAX_ERROR_LEN 300
+
+/* A reloaded filter is published with a single pointer store; readers
+   load the pointer once per record.  The replaced filter is retired and
+   only freed on the next reload pass, by which time no record can still
+   be using it. */
+#if defined(__GNUC__)
+  #define PUBLISH_SET(p, v) __atomic_store_n (&(p), (v), __ATOMIC_RELEASE)
+  #define READ_SET(p)       __atomic_load_n (&(p), __ATOMIC_ACQUIRE)
+#else
+  #define PUBLISH_SET(p, v) ((p) = (v))
+  #define READ_SET(p)       (p)
+#endif
+
+/* Minimum number of container slots in an integer set, a power of two */
+#define ORG_INT_MIN_SLOTS 8
+
+/* 64 bit words in a bitmap container */
+#define ORG_INT_BITMAP_WORDS (65536 / 64)
+
+/* Binary integer column in the internal format? */
+#define IS_BINARY_INT(t) ((t) >= _SQLDT_16BIT_S && (t) <= _SQLDT_64BIT_U)
+
+/* Perfect hash: average keys per displacement bucket, one spare slot
+   per ORG_PERFECT_SLACK keys and displacements tried per bucket */
+#define ORG_PERFECT_BUCKET_SIZE      4
+#define ORG_PERFECT_SLACK            8
+#define ORG_PERFECT_MAX_DISPLACEMENT (1 << 20)
+
+/* Initial number of table column cache buckets, a power of two */
+#define ORG_TABLE_MIN_BUCKETS 64
+
+/* Column filtered on by a plain Org Id list */
+#define ORG_ID_COLUMN "ORGANIZATION_ID"
+
+typedef struct org_filter_entry
+{
+    char *path;                     /* Filter file path (EXITPARAM) */
+    org_filter_def *filter;         /* Current filter compiled from the file */
+    org_filter_def *retired;        /* Previous filter, freed on next reload */
+    struct org_filter_entry *next;
+} org_filter_entry;
+
+static org_filter_entry *filter_entries = NULL;
+static org_filter_entry *last_entry = NULL;
+static char filter_error[MAX_ERROR_LEN];
+static unsigned long filter_generation = 0;
+static size_t bloom_min_keys = 0;
+
+static org_table_columns **table_buckets = NULL;
+static size_t num_table_buckets = 0;
+static size_t num_tables = 0;
+
+/***************************************************************************
+  Hash a key: djb2 followed by an integer finalizer so that keys differing
+  only in the last digits spread over the whole table.  Never returns 0,
+  which marks a free slot.
+***************************************************************************/
+static unsigned int finish_hash (unsigned int hash)
+{
+    hash = ((hash >> 16) ^ hash) * 0x45d9f3b;
+    hash = ((hash >> 16) ^ hash) * 0x45d9f3b;
+    hash = (hash >> 16) ^ hash;
+
+    return hash ? hash : 1;
+}
+
+unsigned int org_filter_hash (const char *key, size_t length)
+{
+    unsigned int hash = 5381;
+    size_t i;
+
+    for (i = 0; i < length; i++)
+        hash = ((hash << 5) + hash) + (unsigned char)key[i]; /* hash * 33 + c */
+
+    return finish_hash (hash);
+}
+
+/***************************************************************************
+  Hash a table name, ignoring case.
+***************************************************************************/
+static unsigned int name_hash (const char *name, size_t length)
+{
+    unsigned int hash = 5381;
+    size_t i;
+
+    for (i = 0; i < length; i++)
+        hash = ((hash << 5) + hash) + toupper ((unsigned char)name[i]);
+
+    return finish_hash (hash);
+}
+
+/***************************************************************************
+  Create an empty filter set.
+***************************************************************************/
+org_filter_set *org_filter_set_create (void)
+{
+    org_filter_set *set;
+
+    set = (org_filter_set *)calloc (1, sizeof(org_filter_set));
+    if (!set)
+        return NULL;
+
+    set->num_slots = ORG_FILTER_MIN_SLOTS;
+    set->slots = (org_filter_slot_def *)calloc (set->num_slots,
+                                                sizeof(org_filter_slot_def));
+    if (!set->slots)
+    {
+        free (set);
+        return NULL;
+    }
+    return set;
+}
+
+/***************************************************************************
+  Release a filter set.
+***************************************************************************/
+void org_filter_set_free (org_filter_set *set)
+{
+    if (!set)
+        return;
+    if (set->mapping)
+    {
+        /* Arrays live in the precompiled file */
+#ifndef WIN32
+        munmap (set->mapping, set->mapping_length);
+#else
+        free (set->mapping);
+#endif
+        free (set);
+        return;
+    }
+    free (set->slots);
+    free (set->displacements);
+    free (set->key_heap);
+    free (set);
+}
+
+/***************************************************************************
+  Find the slot holding a key, or the free slot where it would go.
+***************************************************************************/
+static org_filter_slot_def *find_slot (const org_filter_set *set,
+                                       unsigned int hash,
+                                       const char *key, size_t length)
+{
+    size_t mask = set->num_slots - 1;
+    size_t i = hash & mask;
+    org_filter_slot_def *slot;
+
+    for (;;)
+    {
+        slot = &set->slots[i];
+        if (!slot->hash)
+            return slot;
+        if (slot->hash == hash &&
+            slot->key_length == length &&
+            !memcmp (set->key_heap + slot->key_offset, key, length))
+            return slot;
+        i = (i + 1) & mask;
+    }
+}
+
+/***************************************************************************
+  Double the number of slots, keeping the load factor under 1/2.
+***************************************************************************/
+static int grow_slots (org_filter_set *set)
+{
+    org_filter_slot_def *old_slots = set->slots;
+    size_t old_num_slots = set->num_slots;
+    size_t i;
+
+    set->num_slots = old_num_slots * 2;
+    set->slots = (org_filter_slot_def *)calloc (set->num_slots,
+                                                sizeof(org_filter_slot_def));
+    if (!set->slots)
+    {
+        set->slots = old_slots;
+        set->num_slots = old_num_slots;
+        return 0;
+    }
+
+    for (i = 0; i < old_num_slots; i++)
+    {
+        org_filter_slot_def *slot;
+        size_t j;
+
+        if (!old_slots[i].hash)
+            continue;
+        j = old_slots[i].hash & (set->num_slots - 1);
+        for (slot = &set->slots[j]; slot->hash; slot = &set->slots[j])
+            j = (j + 1) & (set->num_slots - 1);
+        *slot = old_slots[i];
+    }
+
+    free (old_slots);
+    return 1;
+}
+
+/***************************************************************************
+  Add a key to a filter set.  Returns 1 if added, 2 if the key was
+  already present and 0 on allocation failure or if the set is frozen.
+***************************************************************************/
+int org_filter_set_add (org_filter_set *set, const char *key, size_t length)
+{
+    unsigned int hash;
+    org_filter_slot_def *slot;
+
+    if (set->displacements)
+        return 0;                       /* Frozen */
+    if ((set->num_keys + 1) * 2 > set->num_slots && !grow_slots (set))
+        return 0;
+
+    hash = org_filter_hash (key, length);
+    slot = find_slot (set, hash, key, length);
+    if (slot->hash)
+        return 2;
+
+    if (set->key_heap_length + length > set->key_heap_max)
+    {
+        size_t new_max = set->key_heap_max ? set->key_heap_max * 2 : 256;
+        char *new_heap;
+
+        while (new_max < set->key_heap_length + length)
+            new_max *= 2;
+        new_heap = (char *)realloc (set->key_heap, new_max);
+        if (!new_heap)
+            return 0;
+        set->key_heap = new_heap;
+        set->key_heap_max = new_max;
+    }
+
+    memcpy (set->key_heap + set->key_heap_length, key, length);
+    slot->hash = hash;
+    slot->key_length = (unsigned int)length;
+    slot->key_offset = set->key_heap_length;
+    set->key_heap_length += length;
+    set->num_keys++;
+    return 1;
+}
+
+/***************************************************************************
+  64 bit hash of a key for the perfect hash: FNV-1a followed by the
+  splitmix64 finalizer.  32 bits are not enough, two keys sharing a hash
+  can never be told apart by displacement.
+***************************************************************************/
+static uint64_t mix64 (uint64_t x)
+{
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static uint64_t perfect_hash (const char *key, size_t length)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    size_t i;
+
+    for (i = 0; i < length; i++)
+        hash = (hash ^ (unsigned char)key[i]) * 0x100000001b3ULL;
+
+    return mix64 (hash);
+}
+
+/***************************************************************************
+  Map 32 random bits onto [0, n) without a division.
+***************************************************************************/
+static size_t fast_range (uint32_t bits, size_t n)
+{
+    return (size_t)(((uint64_t)bits * n) >> 32);
+}
+
+/***************************************************************************
+  Slot of a key in a frozen set, given its bucket displacement.
+***************************************************************************/
+static size_t perfect_slot (uint64_t hash, uint32_t displacement,
+                            size_t num_slots)
+{
+    return fast_range ((uint32_t)mix64 (hash + displacement *
+                                        0x9e3779b97f4a7c15ULL), num_slots);
+}
+
+/***************************************************************************
+  Fingerprint kept in the slot of a frozen set, never 0.
+***************************************************************************/
+static unsigned int perfect_fingerprint (uint64_t hash)
+{
+    unsigned int fingerprint = (unsigned int)hash;
+
+    return fingerprint ? fingerprint : 1;
+}
+
+/***************************************************************************
+  Rebuild a filter set as a minimal-ish perfect hash (CHD: compress, hash
+  and displace).  Keys are hashed into buckets of about
+  ORG_PERFECT_BUCKET_SIZE keys; the largest buckets are placed first, each
+  trying displacements until all of its keys land in distinct free slots
+  of a table only slightly larger than the number of keys.  A lookup is
+  then one bucket read and one slot probe, with no collision chain.
+  The set can no longer be added to.  Returns 0 if no displacement was
+  found or on allocation failure, leaving the set as it was.
+***************************************************************************/
+int org_filter_set_freeze (org_filter_set *set)
+{
+    size_t num_keys = set->num_keys;
+    size_t num_slots;
+    size_t num_buckets;
+    uint64_t *hashes = NULL;
+    size_t *key_slots = NULL;
+    size_t *bucket_start = NULL;
+    size_t *bucket_keys = NULL;
+    size_t *order = NULL;
+    size_t *size_start = NULL;
+    size_t *positions = NULL;
+    unsigned char *taken = NULL;
+    uint32_t *displacements = NULL;
+    org_filter_slot_def *slots = NULL;
+    size_t max_size = 0;
+    size_t i, j, k;
+    int ok = 0;
+
+    if (set->displacements || !num_keys)
+        return 1;
+
+    num_slots = num_keys + num_keys / ORG_PERFECT_SLACK + 1;
+    num_buckets = (num_keys + ORG_PERFECT_BUCKET_SIZE - 1) /
+                  ORG_PERFECT_BUCKET_SIZE;
+
+    hashes = (uint64_t *)malloc (num_keys * sizeof(uint64_t));
+    key_slots = (size_t *)malloc (num_keys * sizeof(size_t));
+    bucket_start = (size_t *)calloc (num_buckets + 1, sizeof(size_t));
+    bucket_keys = (size_t *)malloc (num_keys * sizeof(size_t));
+    order = (size_t *)malloc (num_buckets * sizeof(size_t));
+    taken = (unsigned char *)calloc (num_slots, 1);
+    displacements = (uint32_t *)calloc (num_buckets, sizeof(uint32_t));
+    slots = (org_filter_slot_def *)calloc (num_slots,
+                                           sizeof(org_filter_slot_def));
+    if (!hashes || !key_slots || !bucket_start || !bucket_keys || !order ||
+        !taken || !displacements || !slots)
+        goto done;
+
+    /* Hash every key and count the keys of each bucket */
+    for (i = 0, j = 0; i < set->num_slots; i++)
+    {
+        if (!set->slots[i].hash)
+            continue;
+        hashes[j] = perfect_hash (set->key_heap + set->slots[i].key_offset,
+                                  set->slots[i].key_length);
+        key_slots[j] = i;
+        bucket_start[fast_range ((uint32_t)(hashes[j] >> 32),
+                                 num_buckets) + 1]++;
+        j++;
+    }
+
+    /* Group the keys by bucket */
+    for (i = 0; i < num_buckets; i++)
+    {
+        if (bucket_start[i + 1] > max_size)
+            max_size = bucket_start[i + 1];
+        bucket_start[i + 1] += bucket_start[i];
+    }
+    positions = (size_t *)malloc ((max_size + 1) * sizeof(size_t));
+    size_start = (size_t *)calloc (max_size + 2, sizeof(size_t));
+    if (!positions || !size_start)
+        goto done;
+    {
+        size_t *fill = (size_t *)malloc (num_buckets * sizeof(size_t));
+
+        if (!fill)
+            goto done;
+        memcpy (fill, bucket_start, num_buckets * sizeof(size_t));
+        for (j = 0; j < num_keys; j++)
+            bucket_keys[fill[fast_range ((uint32_t)(hashes[j] >> 32),
+                                         num_buckets)]++] = j;
+        free (fill);
+    }
+
+    /* Order the buckets, largest first */
+    for (i = 0; i < num_buckets; i++)
+        size_start[max_size - (bucket_start[i + 1] - bucket_start[i]) + 1]++;
+    for (i = 0; i <= max_size; i++)
+        size_start[i + 1] += size_start[i];
+    for (i = 0; i < num_buckets; i++)
+        order[size_start[max_size - (bucket_start[i + 1] - bucket_start[i])]++] = i;
+
+    /* Displace each bucket until its keys fit */
+    for (i = 0; i < num_buckets; i++)
+    {
+        size_t bucket = order[i];
+        size_t first = bucket_start[bucket];
+        size_t size = bucket_start[bucket + 1] - first;
+        uint32_t displacement;
+
+        if (!size)
+            break;
+
+        for (displacement = 0; ; displacement++)
+        {
+            if (displacement == ORG_PERFECT_MAX_DISPLACEMENT)
+                goto done;
+
+            for (k = 0; k < size; k++)
+            {
+                positions[k] = perfect_slot (hashes[bucket_keys[first + k]],
+                                             displacement, num_slots);
+                if (taken[positions[k]])
+                    break;
+                taken[positions[k]] = 1;
+            }
+            if (k == size)
+                break;
+
+            /* Give back the slots of this attempt */
+            while (k-- > 0)
+                taken[positions[k]] = 0;
+        }
+
+        displacements[bucket] = displacement;
+        for (k = 0; k < size; k++)
+        {
+            const org_filter_slot_def *slot =
+                &set->slots[key_slots[bucket_keys[first + k]]];
+
+            slots[positions[k]].hash =
+                perfect_fingerprint (hashes[bucket_keys[first + k]]);
+            slots[positions[k]].key_length = slot->key_length;
+            slots[positions[k]].key_offset = slot->key_offset;
+        }
+    }
+
+    free (set->slots);
+    set->slots = slots;
+    set->num_slots = num_slots;
+    set->displacements = displacements;
+    set->num_buckets = num_buckets;
+    slots = NULL;
+    displacements = NULL;
+    ok = 1;
+
+done:
+    free (hashes);
+    free (key_slots);
+    free (bucket_start);
+    free (bucket_keys);
+    free (order);
+    free (size_start);
+    free (positions);
+    free (taken);
+    free (displacements);
+    free (slots);
+    return ok;
+}
+
+/***************************************************************************
+  Blocked Bloom filter in front of the exact set of an IN rule.  A key
+  sets one bit in each of the 8 words of a single 64 byte block, picked
+  by the upper half of its 64 bit hash; the lower half multiplied by a
+  salt per word gives the bit.  A lookup is one cache line and 8
+  independent shift/and steps the compiler can vectorise, against a
+  displacement, slot and key heap access for the exact set.
+***************************************************************************/
+static const uint32_t bloom_salts[ORG_BLOOM_BLOCK_WORDS] =
+{
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+static org_bloom_filter *bloom_create (size_t num_keys)
+{
+    org_bloom_filter *bloom;
+    size_t num_blocks;
+
+    num_blocks = (num_keys * ORG_BLOOM_BITS_PER_KEY + 511) / 512;
+    if (!num_blocks)
+        num_blocks = 1;
+
+    bloom = (org_bloom_filter *)calloc (1, sizeof(org_bloom_filter));
+    if (!bloom)
+        return NULL;
+
+    /* Align the blocks on a cache line */
+    bloom->memory = calloc (num_blocks * ORG_BLOOM_BLOCK_WORDS + 8,
+                            sizeof(uint64_t));
+    if (!bloom->memory)
+    {
+        free (bloom);
+        return NULL;
+    }
+    bloom->blocks = (uint64_t *)(((size_t)bloom->memory + 63) & ~(size_t)63);
+    bloom->num_blocks = num_blocks;
+    return bloom;
+}
+
+static void bloom_free (org_bloom_filter *bloom)
+{
+    if (!bloom)
+        return;
+    free (bloom->memory);
+    free (bloom);
+}
+
+static void bloom_add (org_bloom_filter *bloom, uint64_t hash)
+{
+    uint64_t *block = bloom->blocks + ORG_BLOOM_BLOCK_WORDS *
+                      fast_range ((uint32_t)(hash >> 32), bloom->num_blocks);
+    uint32_t key = (uint32_t)hash;
+    int i;
+
+    for (i = 0; i < ORG_BLOOM_BLOCK_WORDS; i++)
+        block[i] |= (uint64_t)1 << ((key * bloom_salts[i]) >> 26);
+}
+
+/***************************************************************************
+  Might the key be in the set?  Counts the probe, and the rejection.
+***************************************************************************/
+static int bloom_pass (org_bloom_filter *bloom, uint64_t hash)
+{
+    const uint64_t *block = bloom->blocks + ORG_BLOOM_BLOCK_WORDS *
+                            fast_range ((uint32_t)(hash >> 32),
+                                        bloom->num_blocks);
+    uint32_t key = (uint32_t)hash;
+    uint64_t missing = 0;
+    int i;
+
+    for (i = 0; i < ORG_BLOOM_BLOCK_WORDS; i++)
+        missing |= ~block[i] & ((uint64_t)1 << ((key * bloom_salts[i]) >> 26));
+
+    bloom->probes++;
+    if (!missing)
+        return 1;
+    bloom->rejects++;
+    return 0;
+}
+
+/***************************************************************************
+  Test a key for membership of a frozen set: one displacement read, one
+  slot probe, and a key compare only if the fingerprint matches.
+***************************************************************************/
+static int perfect_contains (const org_filter_set *set, uint64_t hash,
+                             const char *key, size_t length)
+{
+    const org_filter_slot_def *slot;
+    uint32_t displacement;
+
+    displacement = set->displacements[fast_range ((uint32_t)(hash >> 32),
+                                                  set->num_buckets)];
+    slot = &set->slots[perfect_slot (hash, displacement, set->num_slots)];
+
+    return slot->hash == perfect_fingerprint (hash) &&
+           slot->key_length == length &&
+           !memcmp (set->key_heap + slot->key_offset, key, length);
+}
+
+/***************************************************************************
+  Test a key for membership.
+***************************************************************************/
+int org_filter_set_contains (const org_filter_set *set,
+                             const char *key, size_t length)
+{
+    if (!set->num_keys)
+        return 0;
+    if (set->displacements)
+        return perfect_contains (set, perfect_hash (key, length), key, length);
+    return find_slot (set, org_filter_hash (key, length), key, length)->hash != 0;
+}
+
+/***************************************************************************
+  Create an empty integer set.  Keys are split like a roaring bitmap: the
+  upper 48 bits select a container through a hash table, the lower 16 bits
+  are held in the container as a sorted array while it has at most
+  ORG_INT_ARRAY_MAX keys and as a bitmap beyond, so that a container never
+  takes more than 8 KB and a lookup is a probe plus a bit test or a short
+  binary search.
+***************************************************************************/
+org_int_set *org_int_set_create (void)
+{
+    org_int_set *set;
+
+    set = (org_int_set *)calloc (1, sizeof(org_int_set));
+    if (!set)
+        return NULL;
+
+    set->num_slots = ORG_INT_MIN_SLOTS;
+    set->slots = (org_int_container *)calloc (set->num_slots,
+                                              sizeof(org_int_container));
+    if (!set->slots)
+    {
+        free (set);
+        return NULL;
+    }
+    return set;
+}
+
+/***************************************************************************
+  Release an integer set.
+***************************************************************************/
+void org_int_set_free (org_int_set *set)
+{
+    size_t i;
+
+    if (!set)
+        return;
+    for (i = 0; i < set->num_slots; i++)
+    {
+        free (set->slots[i].values);
+        free (set->slots[i].bits);
+    }
+    free (set->slots);
+    free (set);
+}
+
+/***************************************************************************
+  Hash the upper bits of a key.
+***************************************************************************/
+static unsigned int high_hash (int64_t high)
+{
+    uint64_t bits = (uint64_t)high;
+
+    return finish_hash ((unsigned int)(bits ^ (bits >> 32)));
+}
+
+/***************************************************************************
+  Find the container for the upper bits of a key, or the free slot where
+  it would go.
+***************************************************************************/
+static org_int_container *find_container (const org_int_set *set,
+                                          int64_t high)
+{
+    size_t mask = set->num_slots - 1;
+    size_t i = high_hash (high) & mask;
+    org_int_container *container;
+
+    for (;;)
+    {
+        container = &set->slots[i];
+        if (!container->cardinality || container->high == high)
+            return container;
+        i = (i + 1) & mask;
+    }
+}
+
+/***************************************************************************
+  Double the number of container slots.
+***************************************************************************/
+static int grow_containers (org_int_set *set)
+{
+    org_int_container *old_slots = set->slots;
+    size_t old_num_slots = set->num_slots;
+    size_t i;
+
+    set->num_slots = old_num_slots * 2;
+    set->slots = (org_int_container *)calloc (set->num_slots,
+                                              sizeof(org_int_container));
+    if (!set->slots)
+    {
+        set->slots = old_slots;
+        set->num_slots = old_num_slots;
+        return 0;
+    }
+
+    for (i = 0; i < old_num_slots; i++)
+        if (old_slots[i].cardinality)
+            *find_container (set, old_slots[i].high) = old_slots[i];
+
+    free (old_slots);
+    return 1;
+}
+
+/***************************************************************************
+  Binary search the sorted low bits of an array container.  Returns the
+  index of the value, or of the first larger value if it is not there.
+***************************************************************************/
+static unsigned int array_search (const org_int_container *container,
+                                  uint16_t low)
+{
+    unsigned int lo = 0;
+    unsigned int hi = container->cardinality;
+
+    while (lo < hi)
+    {
+        unsigned int mid = (lo + hi) / 2;
+
+        if (container->values[mid] < low)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/***************************************************************************
+  Turn a full array container into a bitmap.
+***************************************************************************/
+static int array_to_bitmap (org_int_container *container)
+{
+    unsigned int i;
+
+    container->bits = (uint64_t *)calloc (ORG_INT_BITMAP_WORDS,
+                                          sizeof(uint64_t));
+    if (!container->bits)
+        return 0;
+    for (i = 0; i < container->cardinality; i++)
+        container->bits[container->values[i] >> 6] |=
+            (uint64_t)1 << (container->values[i] & 63);
+
+    free (container->values);
+    container->values = NULL;
+    container->capacity = 0;
+    return 1;
+}
+
+/***************************************************************************
+  Add a key to an integer set.  Returns 1 if added, 2 if the key was
+  already present and 0 on allocation failure.
+***************************************************************************/
+int org_int_set_add (org_int_set *set, int64_t key)
+{
+    int64_t high = key >> 16;
+    uint16_t low = (uint16_t)(key & 0xffff);
+    org_int_container *container;
+    unsigned int i;
+
+    container = find_container (set, high);
+    if (!container->cardinality)
+    {
+        if ((set->num_containers + 1) * 2 > set->num_slots)
+        {
+            if (!grow_containers (set))
+                return 0;
+            container = find_container (set, high);
+        }
+        container->high = high;
+        container->capacity = 4;
+        container->values = (uint16_t *)malloc (container->capacity *
+                                                sizeof(uint16_t));
+        if (!container->values)
+            return 0;
+        container->values[0] = low;
+        container->cardinality = 1;
+        set->num_containers++;
+        set->num_keys++;
+        return 1;
+    }
+
+    if (container->bits)
+    {
+        uint64_t bit = (uint64_t)1 << (low & 63);
+
+        if (container->bits[low >> 6] & bit)
+            return 2;
+        container->bits[low >> 6] |= bit;
+        container->cardinality++;
+        set->num_keys++;
+        return 1;
+    }
+
+    i = array_search (container, low);
+    if (i < container->cardinality && container->values[i] == low)
+        return 2;
+
+    if (container->cardinality == ORG_INT_ARRAY_MAX)
+    {
+        if (!array_to_bitmap (container))
+            return 0;
+        container->bits[low >> 6] |= (uint64_t)1 << (low & 63);
+        container->cardinality++;
+        set->num_keys++;
+        return 1;
+    }
+
+    if (container->cardinality == container->capacity)
+    {
+        unsigned int new_capacity = container->capacity * 2;
+        uint16_t *new_values;
+
+        if (new_capacity > ORG_INT_ARRAY_MAX)
+            new_capacity = ORG_INT_ARRAY_MAX;
+        new_values = (uint16_t *)realloc (container->values,
+                                          new_capacity * sizeof(uint16_t));
+        if (!new_values)
+            return 0;
+        container->values = new_values;
+        container->capacity = new_capacity;
+    }
+
+    memmove (&container->values[i + 1], &container->values[i],
+             (container->cardinality - i) * sizeof(uint16_t));
+    container->values[i] = low;
+    container->cardinality++;
+    set->num_keys++;
+    return 1;
+}
+
+/***************************************************************************
+  Test an integer key for membership.
+***************************************************************************/
+int org_int_set_contains (const org_int_set *set, int64_t key)
+{
+    const org_int_container *container;
+    uint16_t low = (uint16_t)(key & 0xffff);
+    unsigned int i;
+
+    container = find_container (set, key >> 16);
+    if (!container->cardinality)
+        return 0;
+    if (container->bits)
+        return (container->bits[low >> 6] >> (low & 63)) & 1;
+
+    i = array_search (container, low);
+    return i < container->cardinality && container->values[i] == low;
+}
+
+
+/***************************************************************************
+  Capture the state of a filter file.
+***************************************************************************/
+static void stamp_file (const char *path, org_filter_stamp *stamp)
+{
+    struct stat st;
+
+    memset (stamp, 0, sizeof(org_filter_stamp));
+    if (stat (path, &st))
+        return;
+
+    stamp->found = 1;
+    stamp->mtime = st.st_mtime;
+    stamp->size = st.st_size;
+    stamp->dev = st.st_dev;
+    stamp->ino = st.st_ino;
+}
+
+/***************************************************************************
+  Record a file as a source of the filter, stamped before it is read so
+  that an edit made while reading is seen by the next reload pass.
+***************************************************************************/
+static int add_source (org_filter_def *filter, const char *path)
+{
+    org_filter_source *source;
+
+    source = (org_filter_source *)calloc (1, sizeof(org_filter_source));
+    if (!source)
+        return 0;
+    source->path = (char *)malloc (strlen (path) + 1);
+    if (!source->path)
+    {
+        free (source);
+        return 0;
+    }
+    strcpy (source->path, path);
+    stamp_file (path, &source->stamp);
+    source->next = filter->sources;
+    filter->sources = source;
+    return 1;
+}
+
+/***************************************************************************
+  Read a whole source file of the filter into a null terminated buffer.
+***************************************************************************/
+static char *read_source (org_filter_def *filter, const char *path,
+                          size_t *length)
+{
+    FILE *fp;
+    char *buf = NULL;
+    size_t max = 0;
+    size_t len = 0;
+    size_t n;
+
+    if (!add_source (filter, path))
+        return NULL;
+
+    fp = fopen (path, "rb");
+    if (!fp)
+        return NULL;
+
+    do
+    {
+        if (len + 1 >= max)
+        {
+            char *new_buf;
+
+            max = max ? max * 2 : 4096;
+            new_buf = (char *)realloc (buf, max);
+            if (!new_buf)
+            {
+                free (buf);
+                fclose (fp);
+                return NULL;
+            }
+            buf = new_buf;
+        }
+        n = fread (buf + len, 1, max - len - 1, fp);
+        len += n;
+    } while (n > 0);
+
+    fclose (fp);
+    buf[len] = '\0';
+    *length = len;
+    return buf;
+}
+
+/***************************************************************************
+  Write a frozen filter set as a precompiled key file (see
+  org_binary_header): the header, the bucket displacements, the slots and
+  the key heap, each section 8 byte aligned.  The file is written under a
+  temporary name and renamed, so a process reloading it never sees a
+  partial file and a process still mapping the old one keeps it intact.
+  Returns 0 on failure, see org_filter_error().
+***************************************************************************/
+int org_filter_set_write (const org_filter_set *set, const char *path)
+{
+    org_binary_header header;
+    static const char padding[8] = { 0 };
+    char *temp_path;
+    FILE *fp;
+    size_t displacements_length;
+    size_t slots_length;
+    int ok;
+
+    if (!set->displacements)
+    {
+        strcpy (filter_error, "the key set is not frozen");
+        return 0;
+    }
+
+    displacements_length = set->num_buckets * sizeof(uint32_t);
+    slots_length = set->num_slots * sizeof(org_filter_slot_def);
+
+    memset (&header, 0, sizeof(header));
+    memcpy (header.magic, ORG_BINARY_MAGIC, sizeof(header.magic));
+    header.version = ORG_BINARY_VERSION;
+    header.byte_order = ORG_BINARY_BYTE_ORDER;
+    header.slot_size = sizeof(org_filter_slot_def);
+    header.num_keys = set->num_keys;
+    header.num_slots = set->num_slots;
+    header.num_buckets = set->num_buckets;
+    header.displacements_offset = sizeof(header);
+    header.slots_offset = ORG_BINARY_ALIGN (header.displacements_offset +
+                                            displacements_length);
+    header.key_heap_offset = header.slots_offset + slots_length;
+    header.key_heap_length = set->key_heap_length;
+    header.file_length = header.key_heap_offset + set->key_heap_length;
+
+    temp_path = (char *)malloc (strlen (path) + 5);
+    if (!temp_path)
+    {
+        strcpy (filter_error, "out of memory");
+        return 0;
+    }
+    sprintf (temp_path, "%s.tmp", path);
+
+    fp = fopen (temp_path, "wb");
+    if (!fp)
+    {
+        sprintf (filter_error, "cannot create %.250s", temp_path);
+        free (temp_path);
+        return 0;
+    }
+
+    ok = fwrite (&header, sizeof(header), 1, fp) == 1 &&
+         fwrite (set->displacements, 1, displacements_length, fp) ==
+             displacements_length &&
+         fwrite (padding, 1, (size_t)(header.slots_offset -
+                                      header.displacements_offset -
+                                      displacements_length), fp) ==
+             (size_t)(header.slots_offset - header.displacements_offset -
+                      displacements_length) &&
+         fwrite (set->slots, 1, slots_length, fp) == slots_length &&
+         fwrite (set->key_heap, 1, set->key_heap_length, fp) ==
+             set->key_heap_length;
+    if (fclose (fp))
+        ok = 0;
+
+    if (!ok || rename (temp_path, path))
+    {
+        sprintf (filter_error, "cannot write %.250s", path);
+        remove (temp_path);
+        free (temp_path);
+        return 0;
+    }
+    free (temp_path);
+    return 1;
+}
+
+/***************************************************************************
+  Check the header of a precompiled key file against its length and the
+  layout of this build.
+***************************************************************************/
+static int valid_header (const org_binary_header *header, size_t length)
+{
+    if (header->version != ORG_BINARY_VERSION)
+        sprintf (filter_error, "precompiled key file version %lu, expected %d",
+                 (unsigned long)header->version, ORG_BINARY_VERSION);
+    else
+    if (header->byte_order != ORG_BINARY_BYTE_ORDER ||
+        header->slot_size != sizeof(org_filter_slot_def))
+        strcpy (filter_error,
+                "precompiled key file built on a different platform");
+    else
+    if (header->file_length != length ||
+        !header->num_slots || !header->num_buckets ||
+        header->num_keys > header->num_slots ||
+        header->num_slots > 0xffffffffUL ||
+        header->displacements_offset < sizeof(org_binary_header) ||
+        header->displacements_offset % 8 || header->slots_offset % 8 ||
+        header->displacements_offset +
+            header->num_buckets * sizeof(uint32_t) > header->slots_offset ||
+        header->slots_offset + header->num_slots * sizeof(org_filter_slot_def) >
+            header->key_heap_offset ||
+        header->key_heap_offset + header->key_heap_length > length)
+        strcpy (filter_error, "precompiled key file is truncated or corrupt");
+    else
+        return 1;
+    return 0;
+}
+
+/***************************************************************************
+  Map a precompiled key file read-only and use it as a frozen filter set,
+  with nothing to parse or hash.  The pages are shared with every other
+  process mapping the file.  Returns 1 and the set if the file is
+  precompiled, 0 if it is not (or cannot be opened) and -1 if it is
+  precompiled but unusable, see org_filter_error().
+***************************************************************************/
+static int map_key_file (org_filter_def *filter, const char *path,
+                         org_filter_set **set)
+{
+    org_binary_header header;
+    struct stat st;
+    FILE *fp;
+    char *base;
+
+    fp = fopen (path, "rb");
+    if (!fp)
+        return 0;
+    if (fread (&header, sizeof(header), 1, fp) != 1 ||
+        memcmp (header.magic, ORG_BINARY_MAGIC, sizeof(header.magic)))
+    {
+        fclose (fp);
+        return 0;
+    }
+
+    if (!add_source (filter, path) || fstat (fileno (fp), &st))
+    {
+        fclose (fp);
+        sprintf (filter_error, "cannot read %.250s", path);
+        return -1;
+    }
+    if (!valid_header (&header, (size_t)st.st_size))
+    {
+        fclose (fp);
+        return -1;
+    }
+
+#ifndef WIN32
+    base = (char *)mmap (NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED,
+                         fileno (fp), 0);
+    fclose (fp);
+    if (base == (char *)MAP_FAILED)
+    {
+        sprintf (filter_error, "cannot map %.250s", path);
+        return -1;
+    }
+#else
+    base = (char *)malloc ((size_t)st.st_size);
+    if (!base || fseek (fp, 0, SEEK_SET) ||
+        fread (base, 1, (size_t)st.st_size, fp) != (size_t)st.st_size)
+    {
+        free (base);
+        fclose (fp);
+        sprintf (filter_error, "cannot read %.250s", path);
+        return -1;
+    }
+    fclose (fp);
+#endif
+
+    *set = (org_filter_set *)calloc (1, sizeof(org_filter_set));
+    if (!*set)
+    {
+#ifndef WIN32
+        munmap (base, (size_t)st.st_size);
+#else
+        free (base);
+#endif
+        strcpy (filter_error, "out of memory");
+        return -1;
+    }
+
+    (*set)->mapping = base;
+    (*set)->mapping_length = (size_t)st.st_size;
+    (*set)->num_keys = (size_t)header.num_keys;
+    (*set)->num_slots = (size_t)header.num_slots;
+    (*set)->num_buckets = (size_t)header.num_buckets;
+    (*set)->displacements = (uint32_t *)(base + header.displacements_offset);
+    (*set)->slots = (org_filter_slot_def *)(base + header.slots_offset);
+    (*set)->key_heap = base + header.key_heap_offset;
+    (*set)->key_heap_length = (size_t)header.key_heap_length;
+    (*set)->key_heap_max = (size_t)header.key_heap_length;
+    return 1;
+}
+
+/***************************************************************************
+  Add the keys of a plain Org Id list to a set.  Keys are separated by
+  commas or white space and have no length limit.
+***************************************************************************/
+int org_filter_set_add_list (org_filter_set *set, const char *text)
+{
+    const char *p;
+    size_t n;
+
+    for (p = text; *p; p += n)
+    {
+        p += strspn (p, ORG_FILTER_SEPARATORS);
+        n = strcspn (p, ORG_FILTER_SEPARATORS);
+        if (n && !org_filter_set_add (set, p, n))
+            return 0;
+    }
+    return 1;
+}
+
+/***************************************************************************
+  Parse a signed decimal integer, rejecting anything else.
+***************************************************************************/
+static int parse_int64 (const char *text, size_t length, int64_t *value)
+{
+    size_t i = 0;
+    int negative = 0;
+    uint64_t result = 0;
+    uint64_t limit;
+
+    if (i < length && (text[i] == '-' || text[i] == '+'))
+        negative = text[i++] == '-';
+    if (i == length)
+        return 0;
+
+    limit = negative ? (uint64_t)1 << 63 : ((uint64_t)1 << 63) - 1;
+    for (; i < length; i++)
+    {
+        unsigned int digit = (unsigned char)text[i] - '0';
+
+        if (digit > 9 || result > (limit - digit) / 10)
+            return 0;
+        result = result * 10 + digit;
+    }
+
+    *value = negative ? (int64_t)(0 - result) : (int64_t)result;
+    return 1;
+}
+
+/***************************************************************************
+  Parse an integer written the way it would print: no sign other than a
+  leading minus, no leading zeros.  Only such keys can be held in an
+  integer set, since "0101" and "101" are different keys as text.
+***************************************************************************/
+static int parse_canonical_int64 (const char *text, size_t length,
+                                  int64_t *value)
+{
+    size_t i = (length && text[0] == '-') ? 1 : 0;
+
+    if (i == length || text[0] == '+' ||
+        (text[i] == '0' && (length > i + 1 || i)))
+        return 0;
+    return parse_int64 (text, length, value);
+}
+
+/***************************************************************************
+  Convert a column value to an integer.  Binary integer columns are big
+  endian in the internal format; any other value must be a canonical
+  decimal integer.  Returns 0 if the value is not an integer.
+***************************************************************************/
+int org_value_to_int64 (const org_value_def *value, int64_t *number)
+{
+    const unsigned char *p = (const unsigned char *)value->data;
+    uint64_t bits = 0;
+    size_t i;
+
+    if (!IS_BINARY_INT (value->data_type))
+        return parse_canonical_int64 (value->data, value->length, number);
+
+    if (value->length != 2 && value->length != 4 && value->length != 8)
+        return 0;
+    for (i = 0; i < value->length; i++)
+        bits = (bits << 8) | p[i];
+
+    if (value->data_type == _SQLDT_16BIT_S ||
+        value->data_type == _SQLDT_32BIT_S ||
+        value->data_type == _SQLDT_64BIT_S)
+    {
+        /* Sign extend from the value width */
+        if (value->length < 8 && (bits >> (value->length * 8 - 1)))
+            bits |= ~(uint64_t)0 << (value->length * 8);
+    }
+    else
+    if (bits >> 63)
+        return 0;                       /* Unsigned, beyond int64 */
+
+    *number = (int64_t)bits;
+    return 1;
+}
+
+/***************************************************************************
+  Replace the key set of an IN rule by an integer set if every key is an
+  integer.  Lookups then parse the column value once instead of hashing
+  it and the keys take a fraction of the memory.  Text keys are frozen
+  into a perfect hash instead; should that fail the plain set is kept.
+***************************************************************************/
+static int pack_keys (org_rule_op *op)
+{
+    org_int_set *int_set;
+    int64_t key;
+    size_t i;
+
+    for (i = 0; i < op->set->num_slots; i++)
+    {
+        const org_filter_slot_def *slot = &op->set->slots[i];
+
+        if (slot->hash &&
+            !parse_canonical_int64 (op->set->key_heap + slot->key_offset,
+                                    slot->key_length, &key))
+        {
+            org_filter_set_freeze (op->set);
+            return 1;
+        }
+    }
+
+    int_set = org_int_set_create ();
+    if (!int_set)
+        return 0;
+    for (i = 0; i < op->set->num_slots; i++)
+    {
+        const org_filter_slot_def *slot = &op->set->slots[i];
+
+        if (!slot->hash)
+            continue;
+        parse_canonical_int64 (op->set->key_heap + slot->key_offset,
+                               slot->key_length, &key);
+        if (!org_int_set_add (int_set, key))
+        {
+            org_int_set_free (int_set);
+            return 0;
+        }
+    }
+
+    org_filter_set_free (op->set);
+    op->set = NULL;
+    op->int_set = int_set;
+    op->op = ORG_RULE_IN_INT;
+    return 1;
+}
+
+/***************************************************************************
+  Put a Bloom filter in front of the keys of an IN rule when it has at
+  least org_filter_bloom_threshold() keys.  Text keys are hashed as the
+  perfect hash does, integer keys by the integer finalizer.
+***************************************************************************/
+static int add_bloom (org_rule_op *op)
+{
+    size_t num_keys;
+    size_t i;
+    unsigned int j;
+
+    num_keys = op->int_set ? op->int_set->num_keys : op->set->num_keys;
+    if (!bloom_min_keys || num_keys < bloom_min_keys)
+        return 1;
+
+    op->bloom = bloom_create (num_keys);
+    if (!op->bloom)
+        return 0;
+
+    if (op->set)
+    {
+        for (i = 0; i < op->set->num_slots; i++)
+        {
+            const org_filter_slot_def *slot = &op->set->slots[i];
+
+            if (slot->hash)
+                bloom_add (op->bloom,
+                           perfect_hash (op->set->key_heap + slot->key_offset,
+                                         slot->key_length));
+        }
+        return 1;
+    }
+
+    for (i = 0; i < op->int_set->num_slots; i++)
+    {
+        const org_int_container *container = &op->int_set->slots[i];
+        int64_t high = container->high * 65536;
+
+        if (!container->cardinality)
+            continue;
+        if (!container->bits)
+        {
+            for (j = 0; j < container->cardinality; j++)
+                bloom_add (op->bloom,
+                           mix64 ((uint64_t)(high + container->values[j])));
+            continue;
+        }
+        for (j = 0; j < 65536; j++)
+            if ((container->bits[j >> 6] >> (j & 63)) & 1)
+                bloom_add (op->bloom, mix64 ((uint64_t)(high + (int64_t)j)));
+    }
+    return 1;
+}
+
+/***************************************************************************
+  Set the number of keys from which IN rules get a Bloom filter in front
+  of their exact set, 0 for none.  Applies to filters compiled from then
+  on.
+***************************************************************************/
+void org_filter_bloom_threshold (size_t min_keys)
+{
+    bloom_min_keys = min_keys;
+}
+
+/***************************************************************************
+  Compare two table names, ignoring case.
+***************************************************************************/
+static int names_equal (const char *a, const char *b, size_t length)
+{
+    size_t i;
+
+    for (i = 0; i < length; i++)
+        if (toupper ((unsigned char)a[i]) != toupper ((unsigned char)b[i]))
+            return 0;
+    return b[length] == '\0';
+}
+
+/***************************************************************************
+  Is a token, ending at a separator, the given keyword, ignoring case?
+***************************************************************************/
+static int is_keyword (const char *token, const char *keyword)
+{
+    size_t i;
+
+    for (i = 0; keyword[i]; i++)
+        if (toupper ((unsigned char)token[i]) != keyword[i])
+            return 0;
+    return token[i] == '\0' || strchr (ORG_FILTER_SEPARATORS, token[i]);
+}
+
+/***************************************************************************
+  Return the program for a table, creating it if needed.
+***************************************************************************/
+static org_rule_program *table_program (org_filter_def *filter,
+                                        const char *table_name)
+{
+    org_rule_program *program;
+    size_t length = strlen (table_name);
+    size_t i;
+
+    if (!strcmp (table_name, "*") && filter->default_program)
+        return filter->default_program;
+    for (program = filter->programs; program; program = program->next)
+        if (names_equal (table_name, program->table_name, length))
+            return program;
+
+    program = (org_rule_program *)calloc (1, sizeof(org_rule_program));
+    if (!program)
+        return NULL;
+    program->table_name = (char *)malloc (length + 1);
+    if (!program->table_name)
+    {
+        free (program);
+        return NULL;
+    }
+    for (i = 0; i <= length; i++)
+        program->table_name[i] = (char)toupper ((unsigned char)table_name[i]);
+    program->table_hash = name_hash (table_name, length);
+
+    if (!strcmp (table_name, "*"))
+        filter->default_program = program;
+    else
+    {
+        program->next = filter->programs;
+        filter->programs = program;
+        filter->num_programs++;
+    }
+    return program;
+}
+
+/***************************************************************************
+  Return the index of a column in a program, adding it if needed.
+  Returns -1 if the program already tests ORG_RULE_MAX_COLUMNS columns or
+  on allocation failure.
+***************************************************************************/
+static short program_column (org_rule_program *program, const char *column)
+{
+    short i;
+
+    for (i = 0; i < program->num_columns; i++)
+        if (!strcmp (program->columns[i], column))
+            return i;
+
+    if (program->num_columns == ORG_RULE_MAX_COLUMNS)
+        return -1;
+    program->columns[i] = (char *)malloc (strlen (column) + 1);
+    if (!program->columns[i])
+        return -1;
+    strcpy (program->columns[i], column);
+    program->num_columns++;
+    return i;
+}
+
+/***************************************************************************
+  Append a rule to a program.
+***************************************************************************/
+static org_rule_op *add_op (org_filter_def *filter, org_rule_program *program)
+{
+    org_rule_op *ops;
+
+    ops = (org_rule_op *)realloc (program->ops,
+                                  (program->num_ops + 1) * sizeof(org_rule_op));
+    if (!ops)
+        return NULL;
+    program->ops = ops;
+    memset (&ops[program->num_ops], 0, sizeof(org_rule_op));
+    filter->num_rules++;
+    return &ops[program->num_ops++];
+}
+
+/***************************************************************************
+  Filter ORGANIZATION_ID on a set of Org Ids in the default program.
+  Takes over the set.
+***************************************************************************/
+static int add_org_id_rule (org_filter_def *filter, org_filter_set *set)
+{
+    org_rule_program *program;
+    org_rule_op *op;
+
+    filter->org_id_list = 1;
+
+    if (!set->num_keys)
+    {
+        /* Empty list, nothing is filtered */
+        org_filter_set_free (set);
+        return 1;
+    }
+
+    program = table_program (filter, "*");
+    if (!program || !(op = add_op (filter, program)))
+    {
+        org_filter_set_free (set);
+        strcpy (filter_error, "out of memory");
+        return 0;
+    }
+    op->op = ORG_RULE_IN;
+    op->set = set;
+    op->column = program_column (program, ORG_ID_COLUMN);
+    filter->num_keys = set->num_keys;
+    if ((!set->mapping && !pack_keys (op)) || !add_bloom (op))
+    {
+        strcpy (filter_error, "out of memory");
+        return 0;
+    }
+    return 1;
+}
+
+/***************************************************************************
+  Compile a plain Org Id list into the default program.
+***************************************************************************/
+static int compile_org_ids (org_filter_def *filter, const char *text)
+{
+    org_filter_set *set;
+
+    set = org_filter_set_create ();
+    if (!set || !org_filter_set_add_list (set, text))
+    {
+        org_filter_set_free (set);
+        strcpy (filter_error, "out of memory");
+        return 0;
+    }
+    return add_org_id_rule (filter, set);
+}
+
+/***************************************************************************
+  Split a line into null terminated tokens, dropping a trailing comment.
+  The token array grows to hold every token of the line, so an inline IN
+  list has no length limit.  Returns the number of tokens, -1 on
+  allocation failure.
+***************************************************************************/
+static int split_line (char *line, char ***tokens, size_t *max_tokens)
+{
+    size_t num_tokens = 0;
+    size_t new_max;
+    char **new_tokens;
+    char *p = line;
+
+    for (;;)
+    {
+        p += strspn (p, ORG_FILTER_SEPARATORS);
+        if (!*p || *p == '#')
+            break;
+        if (num_tokens == *max_tokens)
+        {
+            new_max = *max_tokens ? *max_tokens * 2 : 64;
+            new_tokens = (char **)realloc (*tokens, new_max * sizeof(char *));
+            if (!new_tokens)
+                return -1;
+            *tokens = new_tokens;
+            *max_tokens = new_max;
+        }
+        (*tokens)[num_tokens++] = p;
+        p += strcspn (p, ORG_FILTER_SEPARATORS);
+        if (*p)
+            *p++ = '\0';
+    }
+    return (int)num_tokens;
+}
+
+/***************************************************************************
+  Compile one rule: TABLE <table> <column> [NOT] <predicate> <args>.
+***************************************************************************/
+static int compile_rule (org_filter_def *filter, char **tokens, int num_tokens)
+{
+    org_rule_program *program;
+    org_rule_op *op;
+    char **args;
+    int num_args;
+    int negate = 0;
+    int i;
+
+    if (num_tokens < 4)
+    {
+        strcpy (filter_error, "expected TABLE <table> <column> [NOT] <predicate>");
+        return 0;
+    }
+    args = tokens + 3;
+    num_args = num_tokens - 3;
+    if (is_keyword (args[0], "NOT"))
+    {
+        negate = 1;
+        args++;
+        num_args--;
+        if (!num_args)
+        {
+            strcpy (filter_error, "expected a predicate after NOT");
+            return 0;
+        }
+    }
+
+    program = table_program (filter, tokens[1]);
+    if (!program || !(op = add_op (filter, program)))
+    {
+        strcpy (filter_error, "out of memory");
+        return 0;
+    }
+    op->negate = (short)negate;
+    op->column = program_column (program, tokens[2]);
+    if (op->column < 0)
+    {
+        sprintf (filter_error, "more than %d columns tested for table %s",
+                 ORG_RULE_MAX_COLUMNS, tokens[1]);
+        return 0;
+    }
+
+    for (i = 0; args[0][i]; i++)
+        args[0][i] = (char)toupper ((unsigned char)args[0][i]);
+
+    if (!strcmp (args[0], "IN"))
+    {
+        op->op = ORG_RULE_IN;
+        op->set = org_filter_set_create ();
+        if (!op->set)
+        {
+            strcpy (filter_error, "out of memory");
+            return 0;
+        }
+        for (i = 1; i < num_args; i++)
+        {
+            if (args[i][0] == '@')
+            {
+                size_t length;
+                char *text;
+                org_filter_set *mapped;
+                int result = map_key_file (filter, args[i] + 1, &mapped);
+
+                if (result < 0)
+                    return 0;
+                if (result > 0)
+                {
+                    if (num_args != 2)
+                    {
+                        org_filter_set_free (mapped);
+                        strcpy (filter_error, "a precompiled key file must "
+                                "be the only key source of an IN rule");
+                        return 0;
+                    }
+                    org_filter_set_free (op->set);
+                    op->set = mapped;
+                    continue;
+                }
+
+                text = read_source (filter, args[i] + 1, &length);
+
+                if (!text)
+                {
+                    sprintf (filter_error, "cannot read key file %.200s",
+                             args[i] + 1);
+                    return 0;
+                }
+                if (!org_filter_set_add_list (op->set, text))
+                {
+                    free (text);
+                    strcpy (filter_error, "out of memory");
+                    return 0;
+                }
+                free (text);
+            }
+            else
+            if (!org_filter_set_add (op->set, args[i], strlen (args[i])))
+            {
+                strcpy (filter_error, "out of memory");
+                return 0;
+            }
+        }
+        filter->num_keys += op->set->num_keys;
+        if ((!op->set->mapping && !pack_keys (op)) || !add_bloom (op))
+        {
+            strcpy (filter_error, "out of memory");
+            return 0;
+        }
+    }
+    else
+    if (!strcmp (args[0], "RANGE"))
+    {
+        op->op = ORG_RULE_RANGE;
+        if (num_args != 3)
+        {
+            strcpy (filter_error, "expected RANGE <low|*> <high|*>");
+            return 0;
+        }
+        op->has_low = strcmp (args[1], "*") != 0;
+        op->has_high = strcmp (args[2], "*") != 0;
+        if ((op->has_low && !parse_int64 (args[1], strlen (args[1]), &op->low)) ||
+            (op->has_high && !parse_int64 (args[2], strlen (args[2]), &op->high)))
+        {
+            strcpy (filter_error, "RANGE bounds must be integers or *");
+            return 0;
+        }
+    }
+    else
+    if (!strcmp (args[0], "PREFIX"))
+    {
+        op->op = ORG_RULE_PREFIX;
+        if (num_args != 2)
+        {
+            strcpy (filter_error, "expected PREFIX <text>");
+            return 0;
+        }
+        op->prefix_length = strlen (args[1]);
+        op->prefix = (char *)malloc (op->prefix_length + 1);
+        if (!op->prefix)
+        {
+            strcpy (filter_error, "out of memory");
+            return 0;
+        }
+        strcpy (op->prefix, args[1]);
+    }
+    else
+    {
+        sprintf (filter_error, "unknown predicate %.100s", args[0]);
+        return 0;
+    }
+    return 1;
+}
+
+/***************************************************************************
+  Compile a rule file, one rule per line.
+***************************************************************************/
+static int compile_rules (org_filter_def *filter, char *text)
+{
+    char **tokens = NULL;
+    size_t max_tokens = 0;
+    char *line;
+    char *next;
+    int line_no = 0;
+    int num_tokens;
+    char error[MAX_ERROR_LEN];
+
+    for (line = text; line; line = next)
+    {
+        line_no++;
+        next = strchr (line, '\n');
+        if (next)
+            *next++ = '\0';
+
+        num_tokens = split_line (line, &tokens, &max_tokens);
+        if (!num_tokens)
+            continue;
+
+        if (num_tokens < 0)
+            strcpy (filter_error, "out of memory");
+        else
+        if (!is_keyword (tokens[0], "TABLE"))
+            strcpy (filter_error,
+                    "expected TABLE, rules cannot be mixed with plain Org Ids");
+        else
+        if (compile_rule (filter, tokens, num_tokens))
+            continue;
+
+        strcpy (error, filter_error);
+        sprintf (filter_error, "line %d: %.250s", line_no, error);
+        free (tokens);
+        return 0;
+    }
+    free (tokens);
+    return 1;
+}
+
+/***************************************************************************
+  Does any line of a filter file start with TABLE?  Such a file is a rule
+  file, and compile_rules() rejects any other line in it.
+***************************************************************************/
+static int is_rule_file (const char *text)
+{
+    const char *p;
+
+    for (p = text; *p; p += strcspn (p, "\n"))
+    {
+        p += strspn (p, ORG_FILTER_SEPARATORS);
+        if (is_keyword (p, "TABLE"))
+            return 1;
+    }
+    return 0;
+}
+
+/***************************************************************************
+  Release a compiled filter.
+***************************************************************************/
+static void free_program (org_rule_program *program)
+{
+    short i;
+
+    for (i = 0; i < program->num_ops; i++)
+    {
+        org_filter_set_free (program->ops[i].set);
+        org_int_set_free (program->ops[i].int_set);
+        bloom_free (program->ops[i].bloom);
+        free (program->ops[i].prefix);
+    }
+    for (i = 0; i < program->num_columns; i++)
+        free (program->columns[i]);
+    free (program->ops);
+    free (program->table_name);
+    free (program);
+}
+
+void org_filter_free (org_filter_def *filter)
+{
+    org_rule_program *program;
+    org_filter_source *source;
+
+    if (!filter)
+        return;
+
+    while (filter->programs)
+    {
+        program = filter->programs;
+        filter->programs = program->next;
+        free_program (program);
+    }
+    if (filter->default_program)
+        free_program (filter->default_program);
+
+    while (filter->sources)
+    {
+        source = filter->sources;
+        filter->sources = source->next;
+        free (source->path);
+        free (source);
+    }
+    free (filter);
+}
+
+/***************************************************************************
+  Compile a filter file.  A missing file yields a filter without rules and
+  with file_found cleared.  Returns NULL on a syntax error, see
+  org_filter_error().
+***************************************************************************/
+org_filter_def *org_filter_compile (const char *path)
+{
+    org_filter_def *filter;
+    org_filter_set *set;
+    char *text;
+    size_t length;
+    int ok;
+
+    filter_error[0] = '\0';
+    filter = (org_filter_def *)calloc (1, sizeof(org_filter_def));
+    if (!filter)
+    {
+        strcpy (filter_error, "out of memory");
+        return NULL;
+    }
+
+    filter->generation = ++filter_generation;
+
+    /* A precompiled Org Id list is mapped, not read */
+    ok = map_key_file (filter, path, &set);
+    if (ok)
+    {
+        filter->file_found = 1;
+        if (ok > 0 && !add_org_id_rule (filter, set))
+            ok = -1;
+        if (ok < 0)
+        {
+            org_filter_free (filter);
+            return NULL;
+        }
+        return filter;
+    }
+
+    text = read_source (filter, path, &length);
+    if (!text)
+        return filter;
+    filter->file_found = 1;
+
+    if (is_rule_file (text))
+        ok = compile_rules (filter, text);
+    else
+        ok = compile_org_ids (filter, text);
+
+    free (text);
+    if (!ok)
+    {
+        org_filter_free (filter);
+        return NULL;
+    }
+    return filter;
+}
+
+/***************************************************************************
+  Return the reason the last compile failed.
+***************************************************************************/
+const char *org_filter_error (void)
+{
+    return filter_error;
+}
+
+/***************************************************************************
+  Return the program filtering a table, or NULL if the table is not
+  filtered.
+***************************************************************************/
+const org_rule_program *org_filter_program (const org_filter_def *filter,
+                                            const char *table_name,
+                                            size_t length)
+{
+    const org_rule_program *program;
+    unsigned int hash;
+
+    if (filter->num_programs)
+    {
+        hash = name_hash (table_name, length);
+        for (program = filter->programs; program; program = program->next)
+            if (program->table_hash == hash &&
+                names_equal (table_name, program->table_name, length))
+                return program;
+    }
+    return filter->default_program;
+}
+
+/***************************************************************************
+  Evaluate one rule against a column value.
+***************************************************************************/
+int org_rule_test (const org_rule_op *op, const org_value_def *value)
+{
+    int match = 0;
+    int64_t number;
+    uint64_t hash;
+
+    if (!value->null_value)
+    {
+        switch (op->op)
+        {
+            case ORG_RULE_IN:
+                if (op->bloom)
+                {
+                    hash = perfect_hash (value->data, value->length);
+                    if (!bloom_pass (op->bloom, hash))
+                        break;
+                    match = op->set->displacements ?
+                            perfect_contains (op->set, hash, value->data,
+                                              value->length) :
+                            org_filter_set_contains (op->set, value->data,
+                                                     value->length);
+                    op->bloom->false_positives += !match;
+                    break;
+                }
+                match = org_filter_set_contains (op->set, value->data,
+                                                 value->length);
+                break;
+
+            case ORG_RULE_IN_INT:
+                if (!org_value_to_int64 (value, &number))
+                    break;
+                if (op->bloom)
+                {
+                    if (!bloom_pass (op->bloom, mix64 ((uint64_t)number)))
+                        break;
+                    match = org_int_set_contains (op->int_set, number);
+                    op->bloom->false_positives += !match;
+                    break;
+                }
+                match = org_int_set_contains (op->int_set, number);
+                break;
+
+            case ORG_RULE_RANGE:
+                match = (IS_BINARY_INT (value->data_type) ?
+                         org_value_to_int64 (value, &number) :
+                         parse_int64 (value->data, value->length, &number)) &&
+                        (!op->has_low || number >= op->low) &&
+                        (!op->has_high || number <= op->high);
+                break;
+
+            case ORG_RULE_PREFIX:
+                match = value->length >= op->prefix_length &&
+                        !memcmp (value->data, op->prefix, op->prefix_length);
+                break;
+        }
+    }
+    return op->negate ? !match : match;
+}
+
+/***************************************************************************
+  Return the filter registered for a file path, or NULL if the file has
+  not been loaded yet.
+***************************************************************************/
+org_filter_def *org_filter_find (const char *path)
+{
+    org_filter_entry *entry;
+
+    if (last_entry && !strcmp (last_entry->path, path))
+        return READ_SET (last_entry->filter);
+
+    for (entry = filter_entries; entry; entry = entry->next)
+    {
+        if (!strcmp (entry->path, path))
+        {
+            last_entry = entry;
+            return READ_SET (entry->filter);
+        }
+    }
+    return NULL;
+}
+
+/***************************************************************************
+  Compile a filter file and register the filter under its path.
+***************************************************************************/
+org_filter_def *org_filter_load (const char *path)
+{
+    org_filter_entry *entry;
+
+    entry = (org_filter_entry *)calloc (1, sizeof(org_filter_entry));
+    if (!entry)
+        return NULL;
+
+    entry->path = (char *)malloc (strlen (path) + 1);
+    entry->filter = org_filter_compile (path);
+    if (!entry->path || !entry->filter)
+    {
+        free (entry->path);
+        org_filter_free (entry->filter);
+        free (entry);
+        return NULL;
+    }
+    strcpy (entry->path, path);
+
+    entry->next = filter_entries;
+    filter_entries = entry;
+    last_entry = entry;
+    return entry->filter;
+}
+
+/***************************************************************************
+  Has any file a filter was compiled from changed?
+***************************************************************************/
+static int sources_changed (const org_filter_def *filter)
+{
+    const org_filter_source *source;
+    org_filter_stamp stamp;
+
+    for (source = filter->sources; source; source = source->next)
+    {
+        stamp_file (source->path, &stamp);
+        if (stamp.found != source->stamp.found ||
+            stamp.mtime != source->stamp.mtime ||
+            stamp.size != source->stamp.size ||
+            stamp.dev != source->stamp.dev ||
+            stamp.ino != source->stamp.ino)
+            return 1;
+    }
+    return 0;
+}
+
+/***************************************************************************
+  Recompile every filter whose file, or a key file it includes, changed
+  modification time, size or inode since it was compiled.  Only one
+  stat() per file is made unless a file changed.  The new filter is built
+  off to the side and swapped in, so a file that does not compile leaves
+  the current filter in place.  The report function, if given, is called
+  for each recompiled file, with a NULL filter if compiling failed.
+  Returns the number of filters reloaded.
+***************************************************************************/
+int org_filter_reload_changed (void (*report)(const char *path,
+                                              const org_filter_def *filter))
+{
+    org_filter_entry *entry;
+    org_filter_def *filter;
+    int reloaded = 0;
+
+    for (entry = filter_entries; entry; entry = entry->next)
+    {
+        /* Grace period of one reload pass is over */
+        org_filter_free (entry->retired);
+        entry->retired = NULL;
+
+        if (!sources_changed (entry->filter))
+            continue;
+
+        filter = org_filter_compile (entry->path);
+        if (!filter)
+        {
+            org_filter_source *source;
+
+            /* Report once, then wait for the next edit */
+            if (report)
+                report (entry->path, NULL);
+            for (source = entry->filter->sources; source; source = source->next)
+                stamp_file (source->path, &source->stamp);
+            continue;
+        }
+
+        entry->retired = entry->filter;
+        PUBLISH_SET (entry->filter, filter);
+        reloaded++;
+
+        if (report)
+            report (entry->path, filter);
+    }
+    return reloaded;
+}
+
+/***************************************************************************
+  Call the report function for every IN rule of the registered filters
+  that has a Bloom filter, with the table and column of the rule.
+***************************************************************************/
+static void report_program_bloom (const char *path,
+                                  const org_rule_program *program,
+                                  org_bloom_report_fn report)
+{
+    short i;
+
+    for (i = 0; i < program->num_ops; i++)
+        if (program->ops[i].bloom)
+            report (path, program->table_name,
+                    program->columns[program->ops[i].column],
+                    program->ops[i].bloom);
+}
+
+void org_filter_report_bloom (org_bloom_report_fn report)
+{
+    const org_filter_entry *entry;
+    const org_rule_program *program;
+
+    for (entry = filter_entries; entry; entry = entry->next)
+    {
+        for (program = entry->filter->programs; program; program = program->next)
+            report_program_bloom (entry->path, program, report);
+        if (entry->filter->default_program)
+            report_program_bloom (entry->path, entry->filter->default_program,
+                                  report);
+    }
+}
+
+/***************************************************************************
+  Release every registered filter.
+***************************************************************************/
+void org_filter_unload_all (void)
+{
+    org_filter_entry *entry;
+
+    while (filter_entries)
+    {
+        entry = filter_entries;
+        filter_entries = entry->next;
+        org_filter_free (entry->filter);
+        org_filter_free (entry->retired);
+        free (entry->path);
+        free (entry);
+    }
+    last_entry = NULL;
+
+    org_table_columns_invalidate (NULL, 0);
+    free (table_buckets);
+    table_buckets = NULL;
+    num_table_buckets = 0;
+}
+
+/***************************************************************************
+  Double the number of table column cache buckets.
+***************************************************************************/
+static int grow_table_buckets (void)
+{
+    org_table_columns **buckets;
+    org_table_columns *columns;
+    size_t new_num_buckets;
+    size_t i;
+
+    new_num_buckets = num_table_buckets ? num_table_buckets * 2
+                                        : ORG_TABLE_MIN_BUCKETS;
+    buckets = (org_table_columns **)calloc (new_num_buckets,
+                                            sizeof(org_table_columns *));
+    if (!buckets)
+        return 0;
+
+    for (i = 0; i < num_table_buckets; i++)
+    {
+        while (table_buckets[i])
+        {
+            columns = table_buckets[i];
+            table_buckets[i] = columns->next;
+            columns->next = buckets[columns->table_hash & (new_num_buckets - 1)];
+            buckets[columns->table_hash & (new_num_buckets - 1)] = columns;
+        }
+    }
+
+    free (table_buckets);
+    table_buckets = buckets;
+    num_table_buckets = new_num_buckets;
+    return 1;
+}
+
+/***************************************************************************
+  Return the cached column indexes of a table, adding an unresolved entry
+  (generation 0) the first time the table is seen.  Returns NULL on
+  allocation failure.
+***************************************************************************/
+org_table_columns *org_table_columns_find (const char *table_name,
+                                           size_t length)
+{
+    org_table_columns *columns;
+    unsigned int hash = name_hash (table_name, length);
+    size_t i;
+
+    if (num_table_buckets)
+        for (columns = table_buckets[hash & (num_table_buckets - 1)];
+             columns; columns = columns->next)
+            if (columns->table_hash == hash &&
+                names_equal (table_name, columns->table_name, length))
+                return columns;
+
+    if (num_tables >= num_table_buckets && !grow_table_buckets ())
+        return NULL;
+
+    columns = (org_table_columns *)calloc (1, sizeof(org_table_columns));
+    if (!columns)
+        return NULL;
+    columns->table_name = (char *)malloc (length + 1);
+    if (!columns->table_name)
+    {
+        free (columns);
+        return NULL;
+    }
+    for (i = 0; i < length; i++)
+        columns->table_name[i] = (char)toupper ((unsigned char)table_name[i]);
+    columns->table_name[length] = '\0';
+    columns->table_hash = hash;
+
+    columns->next = table_buckets[hash & (num_table_buckets - 1)];
+    table_buckets[hash & (num_table_buckets - 1)] = columns;
+    num_tables++;
+    return columns;
+}
+
+/***************************************************************************
+  Does a name given by an event or DDL record name a cached table?
+  Either may be the more qualified, so one must be the other or end with
+  "." and the other.
+***************************************************************************/
+static int names_table (const org_table_columns *columns, const char *name,
+                        size_t length)
+{
+    size_t cached_length = strlen (columns->table_name);
+    const char *longer = columns->table_name;
+    const char *shorter = name;
+    size_t longer_length = cached_length;
+    size_t shorter_length = length;
+    size_t i;
+
+    if (length > cached_length)
+    {
+        longer = name;
+        shorter = columns->table_name;
+        longer_length = length;
+        shorter_length = cached_length;
+    }
+    if (!shorter_length ||
+        (shorter_length < longer_length &&
+         longer[longer_length - shorter_length - 1] != '.'))
+        return 0;
+
+    longer += longer_length - shorter_length;
+    for (i = 0; i < shorter_length; i++)
+        if (toupper ((unsigned char)longer[i]) !=
+            toupper ((unsigned char)shorter[i]))
+            return 0;
+    return 1;
+}
+
+/***************************************************************************
+  Drop the cached column indexes of a table, or of every table if the
+  name is NULL.  A name of no cached table, such as that of an index,
+  drops nothing.
+***************************************************************************/
+void org_table_columns_invalidate (const char *table_name, size_t length)
+{
+    org_table_columns **link;
+    org_table_columns *columns;
+    size_t i;
+
+    for (i = 0; i < num_table_buckets; i++)
+    {
+        link = &table_buckets[i];
+        while (*link)
+        {
+            columns = *link;
+            if (!table_name || names_table (columns, table_name, length))
+            {
+                *link = columns->next;
+                free (columns->table_name);
+                free (columns);
+                num_tables--;
+            }
+            else
+                link = &columns->next;
+        }
+    }
+}
@@ -0,0 +1,292 @@
+/**************************************************************************
+  Program description:
+
+  Partition filters for the CUSEREXIT partition filter.
+
+  A filter file (the EXITPARAM of a TABLE/MAP clause) is compiled once into
+  per-table rule programs and registered under the file path, so that the
+  records of a table are filtered without any string parsing.  Edits to a
+  filter file are picked up by org_filter_reload_changed(), called from
+  EXIT_CALL_CHECKPOINT, which swaps in a freshly compiled filter.
+
+  A filter file is either a plain list of Org Ids separated by commas or
+  white space, which filters every table on ORGANIZATION_ID, or a list of
+  rules, one per line:
+
+      # TABLE <owner.table | *>  <column>  [NOT] <predicate>
+      TABLE TESTSRC.ORDERS   ORG_ID     IN 101, 102, 103
+      TABLE TESTSRC.ORDERS   REGION     NOT IN APAC
+      TABLE TESTSRC.TENANTS  TENANT_ID  RANGE 1000 1999
+      TABLE TESTSRC.SITES    REGION     PREFIX EU-
+      TABLE *                ORG_ID     IN @/oracle/goldengate/dirue/orgids.init
+
+  Predicates are IN <keys>, RANGE <low|*> <high|*> (inclusive integers) and
+  PREFIX <text>.  IN @<file> reads the keys from a plain Org Id list.  An
+  IN list made only of integers is held in a compressed bitmap and the
+  column value is parsed straight to an integer, which scales to millions
+  of clustered Org Ids in a few MB.  Any other IN list is compiled into a
+  perfect hash, so a lookup probes a single slot.  IN lists of at least
+  org_filter_bloom_threshold() keys also get a blocked Bloom filter, so
+  that most keys not in the list are rejected with one cache line read.
+  All rules of a table must hold for a record to be kept; tables without
+  rules use the TABLE * rules, if any.  NULL or missing columns never
+  match.  Keywords are not case sensitive.  A file with any TABLE line is
+  a rule file, and any other line in it is an error.
+
+  A large Org Id list can be precompiled offline with orgfilter_compile
+  into a binary key file holding the frozen perfect hash.  Such a file,
+  named by the EXITPARAM or by IN @<file> as the only key source of a
+  rule, is mapped read-only and used as is, so a restart does no parsing
+  and the extracts of a host share one copy through the page cache.
+
+  The exit resolves the index of each column a table's rules test once,
+  caching it per table name with org_table_columns_find(), and drops the
+  cached indexes when the host reports a table metadata event.
+
+***************************************************************************/
+
+#ifndef ORGFILTER_H__
+#define ORGFILTER_H__
+
+#include <stddef.h>
+#include <time.h>
+#include <sys/types.h>
+
+#ifdef WIN32
+  #ifndef int64_t
+    #define  int16_t    short
+    #define  int32_t    long
+    #define  int64_t    __int64
+    #define  uint16_t   unsigned short
+    #define  uint32_t   unsigned long
+    #define  uint64_t   unsigned __int64
+  #endif
+#else
+  #include <stdint.h>
+#endif
+
+/* Minimum number of slots in a filter set, must be a power of two */
+#define ORG_FILTER_MIN_SLOTS 16
+
+/* Maximum number of distinct columns the rules of one table can test */
+#define ORG_RULE_MAX_COLUMNS 16
+
+/* Rule predicates */
+#define ORG_RULE_IN      1
+#define ORG_RULE_RANGE   2
+#define ORG_RULE_PREFIX  3
+#define ORG_RULE_IN_INT  4      /* IN with integer keys only */
+
+/* Integer set container holding more keys than this is a bitmap */
+#define ORG_INT_ARRAY_MAX 4096
+
+/* Bloom filter: 64 bit words per 64 byte block, one bit set in each, and
+   bits per key (about 0.1% false positives) */
+#define ORG_BLOOM_BLOCK_WORDS  8
+#define ORG_BLOOM_BITS_PER_KEY 16
+
+/* Precompiled key file identification; bump the version whenever the
+   layout or the perfect hash functions change */
+#define ORG_BINARY_MAGIC      "ORGIDBIN"
+#define ORG_BINARY_VERSION    1
+#define ORG_BINARY_BYTE_ORDER 0x01020304
+#define ORG_BINARY_ALIGN(n)   (((n) + 7) & ~(uint64_t)7)
+
+typedef struct
+{
+    unsigned int hash;         /* Full hash of the key, 0 if slot is free */
+    unsigned int key_length;   /* Key length in bytes */
+    size_t key_offset;         /* Offset of the key in the set key heap */
+} org_filter_slot_def;
+
+/* Open addressing set of text keys.  Once frozen, the slots are laid out
+   by a perfect hash and hold a fingerprint of the key instead of its
+   hash, and num_slots is no longer a power of two. */
+typedef struct
+{
+    org_filter_slot_def *slots; /* Hash slots */
+    size_t num_slots;           /* Number of slots, a power of two unless frozen */
+    size_t num_keys;            /* Number of distinct keys */
+    char *key_heap;             /* Key bytes, not null terminated */
+    size_t key_heap_length;     /* Used key heap bytes */
+    size_t key_heap_max;        /* Allocated key heap bytes */
+    uint32_t *displacements;    /* Perfect hash bucket displacements, NULL
+                                   until frozen */
+    size_t num_buckets;         /* Number of displacement buckets */
+    void *mapping;              /* Precompiled key file holding the arrays,
+                                   NULL if they were allocated */
+    size_t mapping_length;      /* Length of the mapping */
+} org_filter_set;
+
+/* Header of a precompiled key file, written by org_filter_set_write() in
+   the byte order and layout of the host.  The displacements, slots and
+   key heap of a frozen set follow at the given offsets. */
+typedef struct
+{
+    char magic[8];              /* ORG_BINARY_MAGIC */
+    uint32_t version;           /* ORG_BINARY_VERSION */
+    uint32_t byte_order;        /* ORG_BINARY_BYTE_ORDER as written */
+    uint64_t slot_size;         /* sizeof(org_filter_slot_def) */
+    uint64_t num_keys;
+    uint64_t num_slots;
+    uint64_t num_buckets;
+    uint64_t displacements_offset; /* uint32_t[num_buckets] */
+    uint64_t slots_offset;      /* org_filter_slot_def[num_slots] */
+    uint64_t key_heap_offset;
+    uint64_t key_heap_length;
+    uint64_t file_length;
+} org_binary_header;
+
+/* Keys sharing the same upper 48 bits, as a sorted array of the low 16
+   bits while small and as a 8 KB bitmap once dense */
+typedef struct
+{
+    int64_t high;               /* Key >> 16 */
+    unsigned int cardinality;   /* Number of keys, 0 if slot is free */
+    unsigned int capacity;      /* Array capacity, 0 for a bitmap */
+    uint16_t *values;           /* Sorted low bits while an array */
+    uint64_t *bits;             /* 65536 bit bitmap once dense */
+} org_int_container;
+
+typedef struct
+{
+    org_int_container *slots;   /* Containers hashed on the upper bits */
+    size_t num_slots;           /* Number of slots, always a power of two */
+    size_t num_containers;      /* Number of containers in use */
+    size_t num_keys;            /* Number of distinct keys */
+} org_int_set;
+
+/* Blocked Bloom filter in front of the keys of an IN rule, with its hit
+   counters since the filter was compiled */
+typedef struct
+{
+    uint64_t *blocks;           /* ORG_BLOOM_BLOCK_WORDS words per block,
+                                   cache line aligned */
+    size_t num_blocks;
+    void *memory;               /* Allocation holding the blocks */
+    uint64_t probes;            /* Lookups */
+    uint64_t rejects;           /* Lookups the Bloom filter rejected */
+    uint64_t false_positives;   /* Passed lookups missing from the keys */
+} org_bloom_filter;
+
+typedef struct
+{
+    short op;                   /* ORG_RULE_xxx */
+    short negate;               /* NOT given? */
+    short column;               /* Index into the program columns */
+    org_filter_set *set;        /* IN keys */
+    org_int_set *int_set;       /* IN keys, all integers */
+    org_bloom_filter *bloom;    /* Prefilter of the IN keys, if any */
+    short has_low;              /* RANGE bounds, a missing bound is open */
+    short has_high;
+    int64_t low;
+    int64_t high;
+    char *prefix;               /* PREFIX text */
+    size_t prefix_length;
+} org_rule_op;
+
+typedef struct org_rule_program
+{
+    char *table_name;           /* Upper case table name, "*" for any table */
+    unsigned int table_hash;    /* Hash of table_name */
+    char *columns[ORG_RULE_MAX_COLUMNS]; /* Distinct columns tested */
+    short num_columns;
+    org_rule_op *ops;           /* Rules, all must hold */
+    short num_ops;
+    struct org_rule_program *next;
+} org_rule_program;
+
+typedef struct
+{
+    time_t mtime;               /* Modification time */
+    off_t size;                 /* File size */
+    dev_t dev;                  /* Device and inode, catch renames */
+    ino_t ino;
+    short found;                /* Did stat() succeed? */
+} org_filter_stamp;
+
+typedef struct org_filter_source
+{
+    char *path;                 /* File the filter was compiled from */
+    org_filter_stamp stamp;     /* File state before it was read */
+    struct org_filter_source *next;
+} org_filter_source;
+
+typedef struct
+{
+    org_rule_program *programs; /* Programs of named tables */
+    org_rule_program *default_program; /* TABLE * or plain Org Id list */
+    short num_programs;         /* Number of named table programs */
+    size_t num_rules;           /* Number of rules over all programs */
+    size_t num_keys;            /* Number of IN keys over all rules */
+    org_filter_source *sources; /* Filter file and files it includes */
+    short file_found;           /* Could the filter file be opened? */
+    short org_id_list;          /* Plain Org Id list? */
+    unsigned long generation;   /* Distinct for every compiled filter */
+} org_filter_def;
+
+/* Column indexes of a table, resolved from the column names of its rule
+   program through the host metadata, cached per table name */
+typedef struct org_table_columns
+{
+    char *table_name;           /* Upper case table name */
+    unsigned int table_hash;    /* Hash of table_name */
+    unsigned long generation;   /* Filter generation resolved for, 0 if not */
+    short source_or_target;     /* Metadata the indexes were resolved from */
+    short column_index[ORG_RULE_MAX_COLUMNS]; /* -1 if not in the table */
+    short data_type[ORG_RULE_MAX_COLUMNS];    /* GG data type */
+    struct org_table_columns *next;
+} org_table_columns;
+
+/* Column value handed to a rule */
+typedef struct
+{
+    const char *data;           /* Value bytes, not null terminated */
+    size_t length;              /* Value length */
+    short null_value;           /* NULL, or column not in the record */
+    short data_type;            /* GG data type if known, 0 for text */
+} org_value_def;
+
+unsigned int org_filter_hash (const char *key, size_t length);
+
+org_filter_set *org_filter_set_create (void);
+void org_filter_set_free (org_filter_set *set);
+int org_filter_set_add (org_filter_set *set, const char *key, size_t length);
+int org_filter_set_contains (const org_filter_set *set,
+                             const char *key, size_t length);
+int org_filter_set_freeze (org_filter_set *set);
+int org_filter_set_add_list (org_filter_set *set, const char *text);
+int org_filter_set_write (const org_filter_set *set, const char *path);
+
+org_int_set *org_int_set_create (void);
+void org_int_set_free (org_int_set *set);
+int org_int_set_add (org_int_set *set, int64_t key);
+int org_int_set_contains (const org_int_set *set, int64_t key);
+int org_value_to_int64 (const org_value_def *value, int64_t *number);
+
+org_filter_def *org_filter_compile (const char *path);
+void org_filter_free (org_filter_def *filter);
+const char *org_filter_error (void);
+
+const org_rule_program *org_filter_program (const org_filter_def *filter,
+                                            const char *table_name,
+                                            size_t length);
+int org_rule_test (const org_rule_op *op, const org_value_def *value);
+
+org_filter_def *org_filter_find (const char *path);
+org_filter_def *org_filter_load (const char *path);
+int org_filter_reload_changed (void (*report)(const char *path,
+                                              const org_filter_def *filter));
+void org_filter_unload_all (void);
+
+typedef void (*org_bloom_report_fn)(const char *path, const char *table_name,
+                                    const char *column,
+                                    const org_bloom_filter *bloom);
+void org_filter_bloom_threshold (size_t min_keys);
+void org_filter_report_bloom (org_bloom_report_fn report);
+
+org_table_columns *org_table_columns_find (const char *table_name,
+                                           size_t length);
+void org_table_columns_invalidate (const char *table_name, size_t length);
+
+#endif /* ORGFILTER_H__ */
@@ -0,0 +1,165 @@
+/**************************************************************************
+  Program description:
+
+  Lookup benchmark for the partition filter sets of orgfilter.c.  Compares,
+  for 100, 10k and 1M Org Ids:
+
+    scan     the former linear strcmp scan over a fixed width key array
+    hash     the open addressing filter set
+    perfect  the same set frozen into a perfect hash
+
+  Half of the probes are Org Ids in the list, half are not.  Build with
+  make -f Makefile_userexits.LINUX bench and run ./orgfilter_bench.
+
+***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "orgfilter.h"
+
+/* Width of a key in the linear scan array, as in the original exit */
+#define SCAN_KEY_LEN 25
+
+/* Probes per measurement */
+#define NUM_PROBES 1000000
+
+/* Upper bound of strcmp calls for one linear scan measurement */
+#define MAX_SCAN_COMPARES 200000000.0
+
+/***************************************************************************
+  Monotonic time in nanoseconds.
+***************************************************************************/
+static double now_ns (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/***************************************************************************
+  Small xorshift generator, so every run probes the same keys.
+***************************************************************************/
+static unsigned long long next_random (unsigned long long *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/***************************************************************************
+  Org Id number i of the list; probe misses use numbers past the list.
+***************************************************************************/
+static size_t org_id (char *buf, unsigned long long i)
+{
+    return (size_t)sprintf (buf, "ORG-%llu", 100000 + i * 7);
+}
+
+static void run (size_t num_keys)
+{
+    char (*scan_keys)[SCAN_KEY_LEN];
+    char (*probes)[SCAN_KEY_LEN];
+    size_t *probe_lengths;
+    org_filter_set *hash_set;
+    org_filter_set *perfect_set;
+    unsigned long long state = 88172645463325252ULL;
+    size_t num_scan_probes;
+    size_t hits[3] = { 0, 0, 0 };
+    double start, build_ms, elapsed[3];
+    size_t i, j;
+
+    scan_keys = malloc (num_keys * SCAN_KEY_LEN);
+    probes = malloc ((size_t)NUM_PROBES * SCAN_KEY_LEN);
+    probe_lengths = malloc (NUM_PROBES * sizeof(size_t));
+    hash_set = org_filter_set_create ();
+    perfect_set = org_filter_set_create ();
+    if (!scan_keys || !probes || !probe_lengths || !hash_set || !perfect_set)
+    {
+        fprintf (stderr, "out of memory\n");
+        exit (1);
+    }
+
+    for (i = 0; i < num_keys; i++)
+    {
+        size_t length = org_id (scan_keys[i], i);
+
+        if (!org_filter_set_add (hash_set, scan_keys[i], length) ||
+            !org_filter_set_add (perfect_set, scan_keys[i], length))
+        {
+            fprintf (stderr, "out of memory\n");
+            exit (1);
+        }
+    }
+
+    start = now_ns ();
+    if (!org_filter_set_freeze (perfect_set))
+        fprintf (stderr, "no perfect hash found for %lu keys\n",
+                 (unsigned long)num_keys);
+    build_ms = (now_ns () - start) / 1e6;
+
+    for (i = 0; i < NUM_PROBES; i++)
+    {
+        unsigned long long n = next_random (&state) % num_keys;
+
+        probe_lengths[i] = org_id (probes[i], i & 1 ? n : n + num_keys);
+    }
+
+    /* The scan only gets as many probes as keep it within a few seconds */
+    num_scan_probes = NUM_PROBES;
+    if ((double)num_scan_probes * num_keys > MAX_SCAN_COMPARES)
+        num_scan_probes = (size_t)(MAX_SCAN_COMPARES / num_keys);
+
+    start = now_ns ();
+    for (i = 0; i < num_scan_probes; i++)
+        for (j = 0; j < num_keys; j++)
+            if (!strcmp (scan_keys[j], probes[i]))
+            {
+                hits[0]++;
+                break;
+            }
+    elapsed[0] = now_ns () - start;
+
+    start = now_ns ();
+    for (i = 0; i < NUM_PROBES; i++)
+        hits[1] += org_filter_set_contains (hash_set, probes[i],
+                                            probe_lengths[i]);
+    elapsed[1] = now_ns () - start;
+
+    start = now_ns ();
+    for (i = 0; i < NUM_PROBES; i++)
+        hits[2] += org_filter_set_contains (perfect_set, probes[i],
+                                            probe_lengths[i]);
+    elapsed[2] = now_ns () - start;
+
+    printf ("%8lu keys  scan %10.1f ns  hash %6.1f ns  perfect %6.1f ns"
+            "  (slots %lu/%lu, perfect build %.1f ms)\n",
+            (unsigned long)num_keys,
+            elapsed[0] / num_scan_probes, elapsed[1] / NUM_PROBES,
+            elapsed[2] / NUM_PROBES,
+            (unsigned long)hash_set->num_slots,
+            (unsigned long)perfect_set->num_slots, build_ms);
+
+    if (hits[1] != hits[2] || hits[1] != NUM_PROBES / 2 ||
+        hits[0] != num_scan_probes / 2)
+        fprintf (stderr, "lookup results differ: scan %lu hash %lu perfect %lu\n",
+                 (unsigned long)hits[0], (unsigned long)hits[1],
+                 (unsigned long)hits[2]);
+
+    org_filter_set_free (hash_set);
+    org_filter_set_free (perfect_set);
+    free (scan_keys);
+    free (probes);
+    free (probe_lengths);
+}
+
+int main (void)
+{
+    run (100);
+    run (10000);
+    run (1000000);
+    return 0;
+}
@@ -0,0 +1,77 @@
+#!/bin/sh
+#-------------------------------------------------------------------#
+#   Partition filter check                                          #
+#                                                                   #
+#   Usage:                                                          #
+#       make -f Makefile_userexits.LINUX check                      #
+#                                                                   #
+#   Description:                                                    #
+#       Replays orgfilter_check/stream.txt through the CUSEREXIT    #
+#       exit under exithost, with orgfilter_check/rules.txt as the  #
+#       EXITPARAM, and compares the exit's EXIT_OK_VAL and          #
+#       EXIT_IGNORE_VAL counts with orgfilter_check/expected.txt.   #
+#       The rules cover IN on text, integer and mapped precompiled  #
+#       keys, NOT, RANGE with open bounds, PREFIX, @<file> key      #
+#       lists, an inline IN list of 5000 keys and TABLE *.  The     #
+#       stream is replayed without and with a Bloom prefilter on    #
+#       every IN list, which must not change the result.  A file    #
+#       mixing rules with plain Org Ids must fail to load.  Exits   #
+#       with status 1 on a mismatch.                                #
+#-------------------------------------------------------------------#
+
+CHECK=`pwd`/orgfilter_check
+HOST=`pwd`/exithost
+EXIT=`pwd`/modified_exitdemo.so
+TMPDIR=${TMPDIR:-/tmp}
+WORKDIR=$TMPDIR/orgfilter_check.$$
+STATUS=0
+
+trap 'rm -rf $WORKDIR' 0
+mkdir -p $WORKDIR
+cp $CHECK/rules.txt $CHECK/stream.txt $CHECK/orgids.init $WORKDIR
+
+# 5000 Org Ids in one 65536 wide block, held as a bitmap
+awk 'BEGIN { for (i = 0; i < 5000; i++) print 200000 + i }' \
+    > $WORKDIR/bitmap.init
+
+# An inline IN list of 5000 keys on one line
+awk 'BEGIN { printf "TABLE TESTSRC.WIDE ORG_ID IN"
+             for (i = 0; i < 5000; i++) printf " %d", 300000 + i
+             print "" }' >> $WORKDIR/rules.txt
+
+if ! ./orgfilter_compile $CHECK/codes.init $WORKDIR/codes.bin > /dev/null
+then
+    echo "orgfilter_check: cannot compile codes.init" 1>&2
+    exit 1
+fi
+
+for bloom in 0 1
+do
+    (cd $WORKDIR && CUSEREXIT_BLOOM=$bloom \
+        $HOST -r stream.txt -p rules.txt $EXIT) 2>&1 |
+        awk '$1 == "EXIT_OK_VAL" || $1 == "EXIT_IGNORE_VAL" { print $1, $2 }' \
+        > $WORKDIR/results.txt
+    if cmp -s $CHECK/expected.txt $WORKDIR/results.txt
+    then
+        echo "orgfilter_check: Bloom $bloom passed"
+    else
+        echo "orgfilter_check: Bloom $bloom failed, expected:" 1>&2
+        cat $CHECK/expected.txt 1>&2
+        echo "got:" 1>&2
+        cat $WORKDIR/results.txt 1>&2
+        STATUS=1
+    fi
+done
+
+# Rules and plain Org Ids in one file
+printf '101\nTABLE * ORG_ID IN 102\n' > $WORKDIR/mixed.txt
+if (cd $WORKDIR && $HOST -r stream.txt -p mixed.txt $EXIT) 2>&1 |
+    grep 'rules cannot be mixed' > /dev/null
+then
+    echo "orgfilter_check: mixed file passed"
+else
+    echo "orgfilter_check: mixed file failed, it was not rejected" 1>&2
+    STATUS=1
+fi
+
+exit $STATUS
@@ -0,0 +1,103 @@
+/**************************************************************************
+  Program description:
+
+  Offline compiler for partition filter Org Id lists.
+
+      orgfilter_compile <orgids.init> <orgids.bin>
+
+  Reads a plain Org Id list (keys separated by commas or white space),
+  builds its perfect hash and writes it as a precompiled key file that
+  CUSEREXIT maps read-only instead of parsing the list (see orgfilter.h).
+  The output is replaced atomically, so running extracts pick the new file
+  up at their next checkpoint.
+
+***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "orgfilter.h"
+
+/***************************************************************************
+  Read a whole file into a null terminated buffer.
+***************************************************************************/
+static char *read_file (const char *path)
+{
+    FILE *fp;
+    char *buf = NULL;
+    size_t max = 0;
+    size_t len = 0;
+    size_t n;
+
+    fp = fopen (path, "rb");
+    if (!fp)
+        return NULL;
+
+    do
+    {
+        if (len + 1 >= max)
+        {
+            char *new_buf;
+
+            max = max ? max * 2 : 65536;
+            new_buf = (char *)realloc (buf, max);
+            if (!new_buf)
+            {
+                free (buf);
+                fclose (fp);
+                return NULL;
+            }
+            buf = new_buf;
+        }
+        n = fread (buf + len, 1, max - len - 1, fp);
+        len += n;
+    } while (n > 0);
+
+    fclose (fp);
+    buf[len] = '\0';
+    return buf;
+}
+
+int main (int argc, char **argv)
+{
+    org_filter_set *set;
+    char *text;
+
+    if (argc != 3)
+    {
+        fprintf (stderr, "Usage: %s <orgids.init> <orgids.bin>\n", argv[0]);
+        return 2;
+    }
+
+    text = read_file (argv[1]);
+    if (!text)
+    {
+        fprintf (stderr, "Cannot read %s\n", argv[1]);
+        return 1;
+    }
+
+    set = org_filter_set_create ();
+    if (!set || !org_filter_set_add_list (set, text))
+    {
+        fprintf (stderr, "Out of memory reading %s\n", argv[1]);
+        return 1;
+    }
+    free (text);
+
+    if (!org_filter_set_freeze (set))
+    {
+        fprintf (stderr, "Cannot build the perfect hash of %s\n", argv[1]);
+        return 1;
+    }
+    if (!org_filter_set_write (set, argv[2]))
+    {
+        fprintf (stderr, "%s\n", org_filter_error ());
+        return 1;
+    }
+
+    printf ("Compiled %lu Org Ids from %s into %s\n",
+            (unsigned long)set->num_keys, argv[1], argv[2]);
+    org_filter_set_free (set);
+    return 0;
+}
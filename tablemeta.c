@@ -0,0 +1,310 @@
+/**************************************************************************
+  Program description:
+
+  Process-wide table metadata cache for the user exits.  See tablemeta.h.
+
+***************************************************************************/
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tablemeta.h"
+
+static table_meta **buckets = NULL;
+static size_t num_buckets = 0;
+static size_t num_entries = 0;
+
+/***************************************************************************
+  Case insensitive FNV-1a hash of a table name.
+***************************************************************************/
+static unsigned int name_hash (const char *name, size_t length)
+{
+    unsigned int hash = 2166136261u;
+    size_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char)toupper ((unsigned char)name[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int names_equal (const table_meta *meta, const char *name,
+                        size_t length)
+{
+    size_t i;
+
+    if (meta->name_length != length)
+        return 0;
+    for (i = 0; i < length; i++)
+        if (toupper ((unsigned char)meta->table_name[i]) !=
+            toupper ((unsigned char)name[i]))
+            return 0;
+    return 1;
+}
+
+static void free_meta (table_meta *meta)
+{
+    short i;
+
+    if (meta->columns)
+        for (i = 0; i < meta->num_columns; i++)
+            free (meta->columns[i].name);
+    free (meta->columns);
+    free (meta->key_columns);
+    free (meta->catalog_name);
+    free (meta->schema_name);
+    free (meta->object_name);
+    free (meta->table_name);
+    free (meta);
+}
+
+/***************************************************************************
+  Double the bucket array, rehashing the entries.  Returns 0 on
+  allocation failure.
+***************************************************************************/
+static int grow_buckets (void)
+{
+    size_t new_num = num_buckets ? num_buckets * 2 : 64;
+    table_meta **new_buckets;
+    table_meta *meta;
+    table_meta *next;
+    size_t i;
+
+    new_buckets = (table_meta **)calloc (new_num, sizeof(table_meta *));
+    if (!new_buckets)
+        return 0;
+
+    for (i = 0; i < num_buckets; i++)
+        for (meta = buckets[i]; meta; meta = next)
+        {
+            next = meta->next;
+            meta->next = new_buckets[meta->hash & (new_num - 1)];
+            new_buckets[meta->hash & (new_num - 1)] = meta;
+        }
+
+    free (buckets);
+    buckets = new_buckets;
+    num_buckets = new_num;
+    return 1;
+}
+
+/***************************************************************************
+  Cached metadata of a table, NULL if it has not been seen since it was
+  last invalidated.
+***************************************************************************/
+table_meta *table_meta_find (const char *table_name, size_t length,
+                             short source_or_target)
+{
+    table_meta *meta;
+    unsigned int hash;
+
+    if (!num_entries)
+        return NULL;
+
+    hash = name_hash (table_name, length);
+    for (meta = buckets[hash & (num_buckets - 1)]; meta; meta = meta->next)
+        if (meta->hash == hash && meta->source_or_target == source_or_target &&
+            names_equal (meta, table_name, length))
+            return meta;
+    return NULL;
+}
+
+/***************************************************************************
+  Add an empty entry for a table, replacing any entry it had, with room
+  for its columns and key column indexes.  The caller fills it in, and
+  removes it again if the host fails to deliver the metadata.  Returns
+  NULL on allocation failure.
+***************************************************************************/
+table_meta *table_meta_add (const char *table_name, size_t length,
+                            short source_or_target, short num_columns,
+                            short num_key_columns)
+{
+    table_meta *meta;
+
+    meta = table_meta_find (table_name, length, source_or_target);
+    if (meta)
+        table_meta_remove (meta);
+
+    if (num_entries >= num_buckets && !grow_buckets ())
+        return NULL;
+
+    meta = (table_meta *)calloc (1, sizeof(table_meta));
+    if (!meta)
+        return NULL;
+    meta->table_name = table_meta_copy (table_name, length);
+    meta->columns = (table_meta_column *)
+        calloc (num_columns > 0 ? num_columns : 1, sizeof(table_meta_column));
+    meta->key_columns = (short *)
+        calloc (num_key_columns > 0 ? num_key_columns : 1, sizeof(short));
+    if (!meta->table_name || !meta->columns || !meta->key_columns)
+    {
+        free_meta (meta);
+        return NULL;
+    }
+
+    meta->name_length = length;
+    meta->hash = name_hash (table_name, length);
+    meta->source_or_target = source_or_target;
+    meta->num_columns = num_columns;
+    meta->num_key_columns = num_key_columns;
+
+    meta->next = buckets[meta->hash & (num_buckets - 1)];
+    buckets[meta->hash & (num_buckets - 1)] = meta;
+    num_entries++;
+    return meta;
+}
+
+/***************************************************************************
+  Null terminated copy of a name returned by the host, for an entry.
+***************************************************************************/
+char *table_meta_copy (const char *value, size_t length)
+{
+    char *copy = (char *)malloc (length + 1);
+
+    if (copy)
+    {
+        memcpy (copy, value, length);
+        copy[length] = '\0';
+    }
+    return copy;
+}
+
+/***************************************************************************
+  Index of a column by name, compared without regard to case, -1 if the
+  table has no such column.
+***************************************************************************/
+short table_meta_column_index (const table_meta *meta,
+                               const char *column_name)
+{
+    const char *a;
+    const char *b;
+    short i;
+
+    for (i = 0; i < meta->num_columns; i++)
+    {
+        a = meta->columns[i].name;
+        b = column_name;
+        if (!a)
+            continue;
+        while (*a && toupper ((unsigned char)*a) == toupper ((unsigned char)*b))
+        {
+            a++;
+            b++;
+        }
+        if (!*a && !*b)
+            return i;
+    }
+    return -1;
+}
+
+/***************************************************************************
+  Drop one entry.
+***************************************************************************/
+void table_meta_remove (table_meta *meta)
+{
+    table_meta **link;
+
+    for (link = &buckets[meta->hash & (num_buckets - 1)]; *link;
+         link = &(*link)->next)
+        if (*link == meta)
+        {
+            *link = meta->next;
+            free_meta (meta);
+            num_entries--;
+            return;
+        }
+}
+
+/***************************************************************************
+  Does a name given by an event or DDL record name the table of an
+  entry?  Either may be the more qualified, OBJECT, SCHEMA.OBJECT or
+  CATALOG.SCHEMA.OBJECT, so one must be the other or end with "." and
+  the other.
+***************************************************************************/
+static int names_table (const table_meta *meta, const char *name,
+                        size_t length)
+{
+    const char *longer = meta->table_name;
+    const char *shorter = name;
+    size_t longer_length = meta->name_length;
+    size_t shorter_length = length;
+    size_t i;
+
+    if (length > meta->name_length)
+    {
+        longer = name;
+        shorter = meta->table_name;
+        longer_length = length;
+        shorter_length = meta->name_length;
+    }
+    if (!shorter_length ||
+        (shorter_length < longer_length &&
+         longer[longer_length - shorter_length - 1] != '.'))
+        return 0;
+
+    longer += longer_length - shorter_length;
+    for (i = 0; i < shorter_length; i++)
+        if (toupper ((unsigned char)longer[i]) !=
+            toupper ((unsigned char)shorter[i]))
+            return 0;
+    return 1;
+}
+
+/***************************************************************************
+  Drop the source and target entries of a table, or every entry if the
+  name is NULL.  A name that is not cached, such as that of an index or
+  of a table created since, drops nothing.
+***************************************************************************/
+void table_meta_invalidate (const char *table_name, size_t length)
+{
+    table_meta **link;
+    table_meta *meta;
+    size_t i;
+
+    if (!table_name)
+    {
+        table_meta_free_all ();
+        return;
+    }
+
+    for (i = 0; i < num_buckets && num_entries; i++)
+    {
+        link = &buckets[i];
+        while (*link)
+        {
+            meta = *link;
+            if (names_table (meta, table_name, length))
+            {
+                *link = meta->next;
+                free_meta (meta);
+                num_entries--;
+            }
+            else
+                link = &meta->next;
+        }
+    }
+}
+
+/***************************************************************************
+  Drop every entry, called at EXIT_CALL_STOP.
+***************************************************************************/
+void table_meta_free_all (void)
+{
+    table_meta *meta;
+    table_meta *next;
+    size_t i;
+
+    for (i = 0; i < num_buckets; i++)
+    {
+        for (meta = buckets[i]; meta; meta = next)
+        {
+            next = meta->next;
+            free_meta (meta);
+        }
+        buckets[i] = NULL;
+    }
+    num_entries = 0;
+}
@@ -0,0 +1,75 @@
+/**************************************************************************
+  Program description:
+
+  Process-wide table metadata cache for the user exits.
+
+  The first record of a table fills an entry with everything the exit
+  reads through the metadata callbacks: the name parts, the column names,
+  types and lengths and the key columns.  Later records of the table are
+  answered from the entry, so a steady-state record makes no metadata
+  callbacks at all.
+
+  Entries are keyed by the fully qualified table name as returned by
+  GET_TABLE_NAME, compared without regard to case, and by source or
+  target.  An entry is dropped when the host delivers a table metadata
+  event or a DDL record touches the table.  Events and DDL may qualify a
+  name more or less than GET_TABLE_NAME does, so such a name drops the
+  entries whose name it qualifies or is qualified by; a name of no cached
+  table, such as that of an index, drops nothing.
+
+  Like exitarena.c this does not include usrdecs.h; the exit copies the
+  callback structures into the entry.
+
+***************************************************************************/
+
+#ifndef TABLEMETA_H__
+#define TABLEMETA_H__
+
+#include <stddef.h>
+
+typedef struct
+{
+    char *name;                 /* Column name */
+    short native_data_type;     /* Native data type */
+    short gg_data_type;         /* GG data type */
+    short gg_sub_data_type;     /* GG data sub type */
+    short is_nullable;          /* Nullable column */
+    short is_part_of_key;       /* Part of the key */
+    short key_column_index;     /* Position in the key */
+    long length;                /* Column length */
+    long precision;             /* ODBC precision */
+    short scale;                /* Numeric scale */
+    short is_hidden_column;     /* Hidden or invisible column */
+} table_meta_column;
+
+typedef struct table_meta
+{
+    char *table_name;           /* Fully qualified table name */
+    size_t name_length;         /* Length of table_name */
+    unsigned int hash;          /* Hash of table_name */
+    short source_or_target;     /* Source or target metadata */
+    char *catalog_name;         /* Name parts, "" if the host has none */
+    char *schema_name;
+    char *object_name;
+    short num_columns;          /* Columns in the table */
+    short num_user_columns;     /* Columns less hidden ones */
+    short num_key_columns;      /* Columns in the key */
+    short using_pseudo_key;     /* Key made up by the host */
+    short *key_columns;         /* Indexes of the key columns */
+    table_meta_column *columns; /* num_columns columns, by index */
+    struct table_meta *next;
+} table_meta;
+
+table_meta *table_meta_find (const char *table_name, size_t length,
+                             short source_or_target);
+table_meta *table_meta_add (const char *table_name, size_t length,
+                            short source_or_target, short num_columns,
+                            short num_key_columns);
+char *table_meta_copy (const char *value, size_t length);
+short table_meta_column_index (const table_meta *meta,
+                               const char *column_name);
+void table_meta_remove (table_meta *meta);
+void table_meta_invalidate (const char *table_name, size_t length);
+void table_meta_free_all (void);
+
+#endif /* TABLEMETA_H__ */